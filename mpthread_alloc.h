@@ -2,8 +2,10 @@
 #define __MSGI_STL_PTHREAD_ALLOC_H
 
 #include <pthread.h>
+#include <algorithm>
 #include <atomic>
 #include <cstddef>
+#include <cstdint>
 #include <cstring>
 #include <memory>
 #include <mutex>
@@ -15,7 +17,16 @@
 namespace mstl {
 // Constants
 constexpr size_t DEFAULT_ALIGNMENT = 8;
-constexpr size_t MAX_BYTES = 128;
+// Blocks up to MAX_BYTES use the size classes shared with DefaultAllocTemplate
+// (see kSizeClassTable in mstl_alloc.h); larger ones go to operator new.
+constexpr size_t MAX_BYTES = kMaxBytes;
+
+// Small blocks are carved from spans of SPAN_SIZE bytes, aligned to SPAN_SIZE.
+// Every span is owned by exactly one thread state, recorded in its header, so
+// the owner of any block can be found by masking the block address.
+// A span holds at least 7 blocks of the largest size class.
+constexpr size_t SPAN_SIZE = 256 * 1024;
+constexpr size_t SPAN_HEADER_SIZE = 64;
 
 // Forward declarations
 template <size_t _Max_size>
@@ -26,67 +37,96 @@ struct alignas(DEFAULT_ALIGNMENT) MemoryBlock {
     MemoryBlock* next;
 };
 
-namespace detail {
-inline size_t align_up(size_t n) {
-    return (n + DEFAULT_ALIGNMENT - 1) & ~(DEFAULT_ALIGNMENT - 1);
-}
-inline size_t size_to_index(size_t size) {
-    return (size - 1) / DEFAULT_ALIGNMENT;
-}
-}  // namespace detail
-
 // Per-thread state for memory management
 template <size_t _Max_size = MAX_BYTES>
 class PthreadAllocPerThreadState {
 public:
-    // Number of free lists
-    static constexpr size_t NUM_FREE_LISTS = _Max_size / DEFAULT_ALIGNMENT;
+    static_assert(_Max_size <= kMaxBytes && (_Max_size & (_Max_size - 1)) == 0 &&
+                      _Max_size >= kLinearMaxBytes,
+                  "_Max_size must be a power of two in [128, kMaxBytes]");
+
+    // Number of free lists, one per size class up to _Max_size
+    static constexpr size_t NUM_FREE_LISTS = sizeClassCount(_Max_size);
+
+    // Header stored at the start of every span
+    struct alignas(SPAN_HEADER_SIZE) SpanHeader {
+        PthreadAllocPerThreadState<_Max_size>* owner;
+        SpanHeader* next_span;  // Next span owned by the same state
+        size_t free_bytes;      // Scratch counter used by release_unused_spans()
+        bool mapped;            // Obtained from mmap (true) or aligned operator new (false)
+        bool releasing;         // Scratch flag used by release_unused_spans()
+    };
+    static_assert(sizeof(SpanHeader) == SPAN_HEADER_SIZE, "span header must fill one cache line");
 
-    // Array of free lists, one per size class
+    // Array of free lists, one per size class. Only the owning thread touches them.
     std::atomic<MemoryBlock*> free_lists[NUM_FREE_LISTS]{};
 
+    // Blocks of this state freed by other threads. Any thread may push (lock-free),
+    // only the owner pops, and it takes the whole list at once.
+    std::atomic<MemoryBlock*> remote_free_lists[NUM_FREE_LISTS]{};
+
+    // Slow-start refill batch sizes and statistics, one entry per size class
+    RefillController<NUM_FREE_LISTS> refill_controller;
+
+    // Unused tail of the span this state is currently carving
+    char* span_free = nullptr;
+    char* span_end = nullptr;
+
+    // All spans owned by this state
+    SpanHeader* spans = nullptr;
+
     // Link for list of available per-thread structures
     PthreadAllocPerThreadState<_Max_size>* next = nullptr;
 
     // Constructor
     PthreadAllocPerThreadState() = default;
 
+    // Find the state owning a block handed out by some state's allocate()
+    static PthreadAllocPerThreadState* owner_of(void* p) {
+        auto addr = reinterpret_cast<std::uintptr_t>(p) & ~(std::uintptr_t(SPAN_SIZE) - 1);
+        return reinterpret_cast<SpanHeader*>(addr)->owner;
+    }
+
     // Allocate memory of size n
     void* allocate(size_t n) {
-        const size_t index = detail::size_to_index(n);
+        const size_t index = sizeClassIndex(n);
 
-        // Try to get a block from the free list
+        // Try to get a block from the local free list
         MemoryBlock* block = free_lists[index].load(std::memory_order_relaxed);
+        if (!block) {
+            // Take back everything other threads have freed for this size in one go
+            block = remote_free_lists[index].exchange(nullptr, std::memory_order_acquire);
+        }
 
-        while (block) {
-            MemoryBlock* next_block = block->next;
-
-            // Try to update the free list atomically
-            if (free_lists[index].compare_exchange_weak(
-                    block, next_block, std::memory_order_acquire, std::memory_order_relaxed)) {
-                return block;
-            }
-
-            // If CAS failed, block has new value from compare_exchange, try again
+        if (block) {
+            free_lists[index].store(block->next, std::memory_order_relaxed);
+            return block;
         }
 
-        // If free list is empty, refill it
+        // If both lists are empty, refill from our span
         return refill(n);
     }
 
-    // Deallocate memory of size n
+    // Deallocate a block owned by this state, called from the owning thread
     void deallocate(void* p, size_t n) {
         if (!p)
             return;
 
-        const size_t index = detail::size_to_index(n);
+        const size_t index = sizeClassIndex(n);
+        MemoryBlock* block = static_cast<MemoryBlock*>(p);
+        block->next = free_lists[index].load(std::memory_order_relaxed);
+        free_lists[index].store(block, std::memory_order_relaxed);
+    }
+
+    // Deallocate a block owned by this state, called from any other thread
+    void remote_deallocate(void* p, size_t n) {
+        const size_t index = sizeClassIndex(n);
         MemoryBlock* block = static_cast<MemoryBlock*>(p);
 
-        // Add block to free list with atomic operations
-        MemoryBlock* old_head = free_lists[index].load(std::memory_order_relaxed);
+        MemoryBlock* old_head = remote_free_lists[index].load(std::memory_order_relaxed);
         do {
             block->next = old_head;
-        } while (!free_lists[index].compare_exchange_weak(
+        } while (!remote_free_lists[index].compare_exchange_weak(
             old_head, block, std::memory_order_release, std::memory_order_relaxed));
     }
 
@@ -94,6 +134,11 @@ private:
     // Refill free list for size n
     void* refill(size_t n);
 
+    // Give spans without any live block back to the OS, at most max_bytes worth.
+    // Must be called by the owning thread, or for a parked state under chunk_mutex.
+    // Returns the number of bytes released.
+    size_t release_unused_spans(size_t max_bytes);
+
     friend class PthreadAllocatorTemplate<_Max_size>;
 };
 
@@ -113,6 +158,11 @@ private:
     static char* start_free;
     static char* end_free;
     static size_t heap_size;
+    static size_t span_count;  // Spans currently handed out to thread states
+
+    // Allocation counters, only recorded when MSTL_ALLOC_STATS is defined
+    static AllocCounters<ThreadState::NUM_FREE_LISTS> alloc_stats;
+    friend ThreadState;
 
     // Thread state management
     static ThreadState* free_thread_states;
@@ -173,11 +223,13 @@ public:
     static void* allocate(size_t n) {
         // If n is too large, use standard allocator
         if (n > _Max_size) {
+            alloc_stats.recordLargeAlloc(n);
             return ::operator new(n, std::nothrow);
         }
 
         // Round up to alignment multiple
-        n = detail::align_up(n);
+        n = sizeClassRoundUp(n);
+        alloc_stats.recordAlloc(sizeClassIndex(n), n);
 
         // Delegate to thread-local state
         ThreadState* state = get_thread_state();
@@ -191,166 +243,252 @@ public:
 
         // If n is too large, use standard deallocator
         if (n > _Max_size) {
+            alloc_stats.recordLargeFree(n);
             ::operator delete(p);
             return;
         }
 
         // Round up to alignment multiple
-        n = detail::align_up(n);
-
-        // Delegate to thread-local state
-        get_thread_state()->deallocate(p, n);
+        n = sizeClassRoundUp(n);
+        alloc_stats.recordFree(sizeClassIndex(n), n);
+
+        // Blocks go back to the state that carved them: locally when we are the
+        // owner, through the owner's remote-free list otherwise
+        ThreadState* owner = ThreadState::owner_of(p);
+        if (owner == static_cast<ThreadState*>(pthread_getspecific(thread_key))) {
+            owner->deallocate(p, n);
+        } else {
+            owner->remote_deallocate(p, n);
+        }
     }
 
-    // Allocate chunk of memory from global pool
-    static char* chunk_allocate(size_t size, size_t& adjustment) {
-        std::lock_guard<std::mutex> lock(chunk_mutex);
-
-        char* result = nullptr;
-
-        // Try to fulfill from current memory pool
-        size_t total_bytes = size + adjustment;
+    // Refill statistics of the calling thread for blocks of n bytes
+    static RefillStats refill_stats(size_t n) {
+        return get_thread_state()->refill_controller.statsOf(
+            sizeClassIndex(sizeClassRoundUp(n)));
+    }
 
-        if (static_cast<size_t>(end_free - start_free) >= total_bytes) {
-            result = start_free;
-            start_free += total_bytes;
-            return result;
+    // Statistics snapshot. Pool bytes and span count are always valid; the
+    // per-size-class counters need MSTL_ALLOC_STATS.
+    static AllocStatsSnapshot stats_snapshot() {
+        AllocStatsSnapshot s;
+        s.name = "pthread_alloc";
+        alloc_stats.fill(s, sizeClassSize);
+        {
+            std::lock_guard<std::mutex> lock(chunk_mutex);
+            s.poolBytes = heap_size;
+            s.chunks = span_count;
         }
+        s.updateFragmentation();
+        return s;
+    }
 
-        // If current pool is not enough but can provide at least one object
-        if (static_cast<size_t>(end_free - start_free) >= size) {
-            // Use what's left for this request
-            result = start_free;
-            start_free += size;
-            adjustment = 0;
-            return result;
-        }
+    // Give spans without any live block back to the OS, at most max_bytes worth.
+    // Covers the calling thread's state and the states parked by exited threads;
+    // blocks cached by other running threads keep their spans alive.
+    // Returns the number of bytes released.
+    static size_t release_unused(size_t max_bytes) {
+        size_t released = get_thread_state()->release_unused_spans(max_bytes);
 
-        // Need to allocate a new chunk
-        // Try to add any remaining fragment to appropriate free list
-        if (end_free - start_free > 0) {
-            // Determine which free list to add this memory to
-            size_t leftover_size = end_free - start_free;
-            size_t index = detail::size_to_index(leftover_size);
-
-            if (index < ThreadState::NUM_FREE_LISTS) {
-                // Get thread state
-                ThreadState* state = get_thread_state();
-
-                // Add fragment to free list
-                MemoryBlock* block = reinterpret_cast<MemoryBlock*>(start_free);
-                block->next = state->free_lists[index].load(std::memory_order_relaxed);
-                state->free_lists[index].store(block, std::memory_order_release);
-            }
+        std::lock_guard<std::mutex> lock(chunk_mutex);
+        for (ThreadState* state = free_thread_states; state && released < max_bytes;
+             state = state->next) {
+            released += state->release_unused_spans(max_bytes - released);
         }
+        heap_size -= released;
+        span_count -= released / SPAN_SIZE;
+        return released;
+    }
 
-        // Calculate how much to allocate
-        size_t bytes_to_get = 2 * total_bytes + detail::align_up(heap_size >> 4);
-
-        // Try to allocate a new pool
-        start_free = static_cast<char*>(::operator new(bytes_to_get, std::nothrow));
-
-        if (!start_free) {
-            // Out of memory, try to find a free list that has blocks
-            // and use one of those
-            for (size_t i = size / DEFAULT_ALIGNMENT; i < ThreadState::NUM_FREE_LISTS; ++i) {
-                ThreadState* state = get_thread_state();
-                MemoryBlock* block =
-                    state->free_lists[i].exchange(nullptr, std::memory_order_acquire);
-
-                if (block) {
-                    // Found a free block, split it if necessary
-                    start_free = reinterpret_cast<char*>(block);
-                    end_free = start_free + (i + 1) * DEFAULT_ALIGNMENT;
-                    return chunk_allocate(size, adjustment);  // Retry with the found memory
-                }
-            }
+    // Give every span without a live block back to the OS
+    static size_t trim() {
+        return release_unused(static_cast<size_t>(-1));
+    }
 
-            // Last resort - try allocating exactly what's needed, use malloc
-            start_free = static_cast<char*>(malloc_alloc::allocate(total_bytes));
+    // Allocate one span for owner from the global pool.
+    // The pool maps SPAN_SIZE-aligned regions and hands them out one span at a
+    // time, so chunk_mutex is only taken once per span rather than once per refill.
+    static char* chunk_allocate(ThreadState* owner) {
+        std::lock_guard<std::mutex> lock(chunk_mutex);
 
-            if (!start_free) {
-                throw std::bad_alloc();  // Genuinely out of memory
+        char* span = nullptr;
+        bool mapped = true;
+
+        if (start_free == end_free) {
+            // Grow the pool proportionally to what has been handed out so far
+            size_t bytes_to_get = SPAN_SIZE + ((heap_size >> 4) & ~(SPAN_SIZE - 1));
+            start_free = static_cast<char*>(detail::osMapAligned(bytes_to_get, SPAN_SIZE));
+
+            if (start_free) {
+                heap_size += bytes_to_get;
+                end_free = start_free + bytes_to_get;
+            } else {
+                // No mmap: fall back to one span at a time so each can be freed on its own
+                end_free = nullptr;
+                span = static_cast<char*>(
+                    ::operator new(SPAN_SIZE, std::align_val_t(SPAN_SIZE), std::nothrow));
+                if (!span) {
+                    throw std::bad_alloc();  // Genuinely out of memory
+                }
+                heap_size += SPAN_SIZE;
+                mapped = false;
             }
+        }
 
-            // Set end_free for the minimal allocation
-            end_free = start_free + total_bytes;
-
-            // Return directly instead of recursive call
-            result = start_free;
-            start_free += total_bytes;
-            return result;
+        if (!span) {
+            span = start_free;
+            start_free += SPAN_SIZE;
         }
 
-        // Successfully allocated a new chunk
-        heap_size += bytes_to_get;
-        end_free = start_free + bytes_to_get;
+        ++span_count;
+        auto* header = reinterpret_cast<typename ThreadState::SpanHeader*>(span);
+        header->owner = owner;
+        header->next_span = owner->spans;
+        header->mapped = mapped;
+        owner->spans = header;
+        return span;
+    }
 
-        // Return from this allocation instead of recursive call
-        result = start_free;
-        start_free += total_bytes;
-        return result;
+    // Return a span obtained from chunk_allocate to the OS
+    static void chunk_release(typename ThreadState::SpanHeader* span) {
+        if (span->mapped) {
+            detail::osUnmapPages(span, SPAN_SIZE);
+        } else {
+            ::operator delete(span, std::align_val_t(SPAN_SIZE));
+        }
     }
 };
 
 // Implement the refill method for thread state
 template <size_t _Max_size>
 void* PthreadAllocPerThreadState<_Max_size>::refill(size_t n) {
-    // How many objects to allocate at once
-    constexpr size_t NOBJS = 20;
-
-    // Try to allocate memory for NOBJS objects of size n
-    size_t total_bytes = n * NOBJS;
-    size_t adjustment = 0;  // Will be used if alignment adjustment is needed
-
-    char* chunk = PthreadAllocatorTemplate<_Max_size>::chunk_allocate(total_bytes, adjustment);
+    // How many objects to allocate at once, adapted to how hot this size class is
+    const size_t index = sizeClassIndex(n);
+    const size_t batch = refill_controller.next(index, n);
+
+    size_t bytes_left = span_end - span_free;
+    size_t nobjs = batch;
+
+    if (bytes_left < n) {
+        // Cut what is left of the current span into the largest size classes
+        // that fit and put the pieces on their free lists
+        while (bytes_left >= DEFAULT_ALIGNMENT) {
+            const size_t piece =
+                sizeClassSize(std::min(sizeClassFloorIndex(bytes_left), NUM_FREE_LISTS - 1));
+            deallocate(span_free, piece);
+            span_free += piece;
+            bytes_left -= piece;
+        }
 
-    if (!chunk) {
-        return nullptr;  // Out of memory
+        // Start carving a fresh span
+        char* span = PthreadAllocatorTemplate<_Max_size>::chunk_allocate(this);
+        span_free = span + SPAN_HEADER_SIZE;
+        span_end = span + SPAN_SIZE;
+    } else if (bytes_left < n * batch) {
+        // Not enough for a full batch, hand out as many objects as still fit
+        nobjs = bytes_left / n;
     }
 
-    // Adjust for alignment if necessary
-    char* aligned_chunk = chunk;
-    if (adjustment > 0) {
-        aligned_chunk = chunk + adjustment;
-    }
+    char* chunk = span_free;
+    span_free += n * nobjs;
+    refill_controller.record(index, nobjs);
+    PthreadAllocatorTemplate<_Max_size>::alloc_stats.recordRefill(index);
 
     // Always return the first object to satisfy current request
-    void* result = aligned_chunk;
+    void* result = chunk;
 
     // If there's only one object, just return it
-    if (NOBJS == 1) {
+    if (nobjs == 1) {
         return result;
     }
 
-    // Add remaining objects to the free list
-    size_t index = detail::size_to_index(n);
-    MemoryBlock* current_block = nullptr;
-    MemoryBlock* next_block = nullptr;
+    // Chain the remaining objects, starting at the second one
+    for (size_t i = 1; i < nobjs - 1; ++i) {
+        reinterpret_cast<MemoryBlock*>(chunk + n * i)->next =
+            reinterpret_cast<MemoryBlock*>(chunk + n * (i + 1));
+    }
 
-    // Start at second object (first is returned to caller)
-    for (size_t i = 1; i < NOBJS; ++i) {
-        current_block = reinterpret_cast<MemoryBlock*>(aligned_chunk + n * i);
+    // Splice the chain in front of the local free list
+    MemoryBlock* last_block = reinterpret_cast<MemoryBlock*>(chunk + n * (nobjs - 1));
+    last_block->next = free_lists[index].load(std::memory_order_relaxed);
+    free_lists[index].store(reinterpret_cast<MemoryBlock*>(chunk + n), std::memory_order_relaxed);
 
-        if (i < NOBJS - 1) {
-            next_block = reinterpret_cast<MemoryBlock*>(aligned_chunk + n * (i + 1));
-            current_block->next = next_block;
-        } else {
-            current_block->next = nullptr;  // Last block in chain
+    return result;
+}
+
+template <size_t _Max_size>
+size_t PthreadAllocPerThreadState<_Max_size>::release_unused_spans(size_t max_bytes) {
+    auto span_of = [](void* p) {
+        auto addr = reinterpret_cast<std::uintptr_t>(p) & ~(std::uintptr_t(SPAN_SIZE) - 1);
+        return reinterpret_cast<SpanHeader*>(addr);
+    };
+
+    // Pull in blocks freed by other threads so they count as free
+    for (size_t i = 0; i < NUM_FREE_LISTS; ++i) {
+        MemoryBlock* block = remote_free_lists[i].exchange(nullptr, std::memory_order_acquire);
+        while (block) {
+            MemoryBlock* next_block = block->next;
+            deallocate(block, sizeClassSize(i));
+            block = next_block;
         }
     }
 
-    // Update free list, handling possible race conditions
-    MemoryBlock* first_block = reinterpret_cast<MemoryBlock*>(aligned_chunk + n);
-    MemoryBlock* old_head = free_lists[index].load(std::memory_order_relaxed);
+    // Count free bytes per span: blocks on the free lists plus the uncarved tail
+    for (SpanHeader* span = spans; span; span = span->next_span) {
+        span->free_bytes = 0;
+        span->releasing = false;
+    }
+    for (size_t i = 0; i < NUM_FREE_LISTS; ++i) {
+        MemoryBlock* block = free_lists[i].load(std::memory_order_relaxed);
+        for (; block; block = block->next) {
+            span_of(block)->free_bytes += sizeClassSize(i);
+        }
+    }
+    if (span_free != span_end) {
+        span_of(span_free)->free_bytes += span_end - span_free;
+    }
 
-    do {
-        // Point last block to current free list head
-        current_block->next = old_head;
-    } while (!free_lists[index].compare_exchange_weak(
-        old_head, first_block, std::memory_order_release, std::memory_order_relaxed));
+    size_t released = 0;
+    for (SpanHeader* span = spans; span; span = span->next_span) {
+        if (span->free_bytes == SPAN_SIZE - SPAN_HEADER_SIZE && released + SPAN_SIZE <= max_bytes) {
+            span->releasing = true;
+            released += SPAN_SIZE;
+        }
+    }
+    if (released == 0) {
+        return 0;
+    }
 
-    return result;
+    // Drop blocks that live in the spans about to go away
+    for (size_t i = 0; i < NUM_FREE_LISTS; ++i) {
+        MemoryBlock* kept = nullptr;
+        MemoryBlock* block = free_lists[i].load(std::memory_order_relaxed);
+        while (block) {
+            MemoryBlock* next_block = block->next;
+            if (!span_of(block)->releasing) {
+                block->next = kept;
+                kept = block;
+            }
+            block = next_block;
+        }
+        free_lists[i].store(kept, std::memory_order_relaxed);
+    }
+    if (span_free != span_end && span_of(span_free)->releasing) {
+        span_free = span_end = nullptr;
+    }
+
+    // Unlink and release the spans
+    SpanHeader** link = &spans;
+    while (*link) {
+        SpanHeader* span = *link;
+        if (span->releasing) {
+            *link = span->next_span;
+            PthreadAllocatorTemplate<_Max_size>::chunk_release(span);
+        } else {
+            link = &span->next_span;
+        }
+    }
+    return released;
 }
 
 // Initialize static members
@@ -366,6 +504,13 @@ char* PthreadAllocatorTemplate<_Max_size>::end_free = nullptr;
 template <size_t _Max_size>
 size_t PthreadAllocatorTemplate<_Max_size>::heap_size = 0;
 
+template <size_t _Max_size>
+size_t PthreadAllocatorTemplate<_Max_size>::span_count = 0;
+
+template <size_t _Max_size>
+AllocCounters<PthreadAllocPerThreadState<_Max_size>::NUM_FREE_LISTS>
+    PthreadAllocatorTemplate<_Max_size>::alloc_stats;
+
 template <size_t _Max_size>
 typename PthreadAllocatorTemplate<_Max_size>::ThreadState*
     PthreadAllocatorTemplate<_Max_size>::free_thread_states = nullptr;
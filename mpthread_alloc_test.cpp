@@ -1,10 +1,14 @@
 #include "mpthread_alloc.h"
 #include <cassert>
 #include <chrono>
+#include <condition_variable>
 #include <cstdlib>
+#include <cstring>
 #include <iomanip>
 #include <iostream>
 #include <memory>
+#include <mutex>
+#include <set>
 #include <thread>
 #include <vector>
 #include "mstl_vector.h"
@@ -72,6 +76,19 @@ void test_basic_allocation() {
 
     mstl::PthreadAllocatorTemplate<>::deallocate(p, 64);
 
+    // 同一大小类连续 refill 时批量应逐步增大 (慢启动)
+    std::vector<void*> blocks;
+    for (int i = 0; i < 10000; ++i) {
+        blocks.push_back(mstl::PthreadAllocatorTemplate<>::allocate(24));
+    }
+    mstl::RefillStats stats = mstl::PthreadAllocatorTemplate<>::refill_stats(24);
+    std::cout << "24 字节区块: refill " << stats.refills << " 次, 共 " << stats.objects
+              << " 个区块, 当前批量 " << stats.batch << std::endl;
+    assert(stats.refills < 10000 / 20);
+    for (void* b : blocks) {
+        mstl::PthreadAllocatorTemplate<>::deallocate(b, 24);
+    }
+
     std::cout << "Basic allocation test passed!" << std::endl;
 }
 
@@ -165,6 +182,87 @@ void test_multi_thread() {
     std::cout << "Multi-threaded test passed!" << std::endl;
 }
 
+// 生产者分配、消费者释放：释放的区块应回到生产者自己的线程状态并被复用，
+// 而不是在消费者一侧越积越多、让生产者不断切割新内存
+void test_producer_consumer() {
+    std::cout << "Testing cross-thread deallocation..." << std::endl;
+
+    const int ROUNDS = 200;
+    const int BATCH = 64;
+
+    std::mutex mutex;
+    std::condition_variable cv;
+    std::vector<void*> handoff;
+    bool done = false;
+
+    std::thread consumer([&]() {
+        std::unique_lock<std::mutex> lock(mutex);
+        while (!done || !handoff.empty()) {
+            cv.wait(lock, [&]() { return done || !handoff.empty(); });
+            for (void* p : handoff) {
+                mstl::PthreadAllocatorTemplate<>::deallocate(p, 64);
+            }
+            handoff.clear();
+            cv.notify_all();
+        }
+    });
+
+    std::set<void*> distinct;
+    std::thread producer([&]() {
+        for (int r = 0; r < ROUNDS; ++r) {
+            std::vector<void*> batch;
+            for (int i = 0; i < BATCH; ++i) {
+                void* p = mstl::PthreadAllocatorTemplate<>::allocate(64);
+                distinct.insert(p);
+                batch.push_back(p);
+            }
+            std::unique_lock<std::mutex> lock(mutex);
+            handoff = std::move(batch);
+            cv.notify_all();
+            cv.wait(lock, [&]() { return handoff.empty(); });
+        }
+        std::lock_guard<std::mutex> lock(mutex);
+        done = true;
+        cv.notify_all();
+    });
+
+    producer.join();
+    consumer.join();
+
+    std::cout << "生产者分配 " << ROUNDS * BATCH << " 次，使用了 " << distinct.size()
+              << " 个不同地址" << std::endl;
+    assert(distinct.size() < static_cast<size_t>(ROUNDS * BATCH) / 4);
+
+    std::cout << "Cross-thread deallocation test passed!" << std::endl;
+}
+
+void test_trim() {
+    std::cout << "Testing trim..." << std::endl;
+
+    // Run in a fresh thread so the spans belong to a state nobody else uses
+    size_t released = 0;
+    std::thread([&released]() {
+        std::vector<void*> ptrs;
+        for (int i = 0; i < 100000; ++i) {
+            ptrs.push_back(mstl::PthreadAllocatorTemplate<>::allocate(96));
+        }
+        for (void* p : ptrs) {
+            mstl::PthreadAllocatorTemplate<>::deallocate(p, 96);
+        }
+        released = mstl::PthreadAllocatorTemplate<>::trim();
+
+        // The state must still be usable afterwards
+        void* p = mstl::PthreadAllocatorTemplate<>::allocate(96);
+        std::memset(p, 0, 96);
+        mstl::PthreadAllocatorTemplate<>::deallocate(p, 96);
+    }).join();
+
+    std::cout << "trim 归还 " << released << " 字节" << std::endl;
+    assert(released >= 100000 * 96 / 2);
+
+    std::cout << "Trim test passed!" << std::endl;
+}
+
 void benchmark() {
     const int num_threads = 4;
     const int allocs_per_thread = 1000000;
@@ -231,6 +329,8 @@ int main() {
     test_stl_container();
     test_smart_pointer();
     test_multi_thread();
+    test_producer_consumer();
+    test_trim();
 
     std::cout << "All tests passed successfully!" << std::endl;
 
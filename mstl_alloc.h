@@ -1,16 +1,106 @@
 #ifndef __MSGI_STL_INTERNAL_ALLOC_H
 #define __MSGI_STL_INTERNAL_ALLOC_H
 
+#include <algorithm>
 #include <array>
+#include <bit>
+#include <cstdint>
 #include <cstdlib>
 #include <cstring>
 #include <mutex>
 #include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "mstl_alloc_stats.h"
 #include "mstl_concepts.h"
 #include "mstl_construct.h"
 
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/mman.h>
+#include <unistd.h>
+#define MSTL_HAS_MMAP 1
+#else
+#define MSTL_HAS_MMAP 0
+#endif
+
+#if defined(__GLIBC__)
+#include <malloc.h>
+#endif
+
 namespace mstl {
 
+// 直接向操作系统申请/归还整页内存，供内存池切割 chunk 使用
+// 不支持 mmap 的平台上 osMapPages 返回 nullptr，调用方退回 malloc
+namespace detail {
+inline size_t osPageSize() {
+#if MSTL_HAS_MMAP
+    static const size_t pageSize = static_cast<size_t>(::sysconf(_SC_PAGESIZE));
+    return pageSize;
+#else
+    return 4096;
+#endif
+}
+
+inline size_t roundUpToPage(size_t bytes) {
+    return (bytes + osPageSize() - 1) & ~(osPageSize() - 1);
+}
+
+// bytes 必须是页大小的整数倍
+inline void* osMapPages(size_t bytes) {
+#if MSTL_HAS_MMAP
+    void* p = ::mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    return p == MAP_FAILED ? nullptr : p;
+#else
+    (void)bytes;
+    return nullptr;
+#endif
+}
+
+// 申请 bytes 字节且起始地址按 alignment (页大小的整数倍) 对齐的内存
+inline void* osMapAligned(size_t bytes, size_t alignment) {
+#if MSTL_HAS_MMAP
+    char* raw = static_cast<char*>(osMapPages(bytes + alignment));
+    if (raw == nullptr)
+        return nullptr;
+    char* aligned = reinterpret_cast<char*>(
+        (reinterpret_cast<uintptr_t>(raw) + alignment - 1) & ~(uintptr_t(alignment) - 1));
+    if (aligned != raw)
+        ::munmap(raw, aligned - raw);
+    if (size_t tail = (raw + bytes + alignment) - (aligned + bytes))
+        ::munmap(aligned + bytes, tail);
+    return aligned;
+#else
+    (void)bytes;
+    (void)alignment;
+    return nullptr;
+#endif
+}
+
+inline void osUnmapPages(void* p, size_t bytes) {
+#if MSTL_HAS_MMAP
+    ::munmap(p, bytes);
+#else
+    (void)p;
+    (void)bytes;
+#endif
+}
+
+// 透明大页 (THP) 的大小
+constexpr size_t kHugePageSize = 2 * 1024 * 1024;
+
+// 建议内核用透明大页映射 [p, p + bytes)，内核不支持或未开启 THP 时返回 false，内存仍可正常使用
+inline bool osAdviseHugePages(void* p, size_t bytes) {
+#if MSTL_HAS_MMAP && defined(MADV_HUGEPAGE)
+    return ::madvise(p, bytes, MADV_HUGEPAGE) == 0;
+#else
+    (void)p;
+    (void)bytes;
+    return false;
+#endif
+}
+}  // namespace detail
+
 // NOLINTBEGIN(cppcoreguidelines-owning-memory)
 // 这个文件包含 STL 的最底层内存分配实现
 // 为了性能考虑，我们直接使用 malloc/free
@@ -36,6 +126,7 @@ private:
     static MallocFunction kOomMalloc;
     static ReallocFunction kOomRealloc;
     static MallocHandler kMallocAllocOomHandler;
+    static AllocCounters<1> kStats;
 
     static void* defaultOomMalloc(size_t n) {
         while (true) {
@@ -65,32 +156,59 @@ public:
             void* result = std::malloc(n);
             if (result == nullptr)
                 throw std::bad_alloc();
+            kStats.recordLargeAlloc(n);
             return result;
         } catch (std::bad_alloc&) {
             void* rescue = kOomMalloc(n);
             if (rescue == nullptr) {
                 throw;
             }
+            kStats.recordLargeAlloc(n);
             return rescue;
         }
     }
 
     static void deallocate(void* p, [[maybe_unused]] size_t n) {
+        kStats.recordLargeFree(n);
         std::free(p);
     }
 
+    // p 是 allocate(n) 或 reallocate(..., n) 得到的块，返回它实际可用的字节数 (不小于 n)，
+    // 调用者之后按这个大小使用和释放它
+    static size_t usableSize([[maybe_unused]] void* p, size_t n) {
+#if defined(__GLIBC__)
+        size_t usable = malloc_usable_size(p);
+        if (usable > n) {
+            kStats.recordLargeFree(n);
+            kStats.recordLargeAlloc(usable);
+            return usable;
+        }
+#endif
+        return n;
+    }
+
     static void* reallocate(void* p, [[maybe_unused]] size_t oldSize, size_t newSize) {
+        void* result;
         try {
-            void* result = std::realloc(p, newSize);
+            result = std::realloc(p, newSize);
             if (result == nullptr)
                 throw std::bad_alloc();
-            return result;
         } catch (std::bad_alloc&) {
-            void* rescue = kOomRealloc(p, newSize);
-            if (rescue == nullptr)
+            result = kOomRealloc(p, newSize);
+            if (result == nullptr)
                 throw;
-            return rescue;
         }
+        kStats.recordLargeFree(oldSize);
+        kStats.recordLargeAlloc(newSize);
+        return result;
+    }
+
+    // 统计快照；一级分配器没有内存池，所有分配都计入 large
+    static AllocStatsSnapshot statsSnapshot() {
+        AllocStatsSnapshot s;
+        s.name = "malloc_alloc";
+        kStats.fill(s, [](size_t) { return size_t(0); });
+        return s;
     }
 
     static MallocHandler setMallocHandler(MallocHandler f) noexcept {
@@ -116,9 +234,148 @@ template <int inst>
 typename MallocAllocTemplate<inst>::ReallocFunction MallocAllocTemplate<inst>::kOomRealloc =
     &MallocAllocTemplate<inst>::defaultOomRealloc;
 
+template <int inst>
+AllocCounters<1> MallocAllocTemplate<inst>::kStats;
+
+// 内存池负责的最大区块，超过的直接交给一级分配器；可以在包含头文件前定义 MSTL_ALLOC_MAX_BYTES 修改
+#ifndef MSTL_ALLOC_MAX_BYTES
+#define MSTL_ALLOC_MAX_BYTES 32768
+#endif
+
+// 大小类：不超过 kLinearMaxBytes 时按 kAlignment 线性分档 (8, 16, ..., 128)，
+// 之后每翻一倍分 kClassesPerDoubling 档 (144, 160, ..., 256, 288, ...)，相邻大小类相差 12.5%，
+// 避免中等大小的对象 (红黑树节点、deque 缓冲区等) 按 8 字节分档带来过多的 free list
 constexpr size_t kAlignment = 8;
-constexpr size_t kMaxBytes = 128;
-constexpr size_t kNumFreeLists = kMaxBytes / kAlignment;
+constexpr size_t kLinearMaxBytes = 128;
+constexpr size_t kClassesPerDoubling = 8;
+constexpr size_t kMaxBytes = MSTL_ALLOC_MAX_BYTES;
+
+static_assert(std::has_single_bit(kMaxBytes) && kMaxBytes >= kLinearMaxBytes,
+              "MSTL_ALLOC_MAX_BYTES must be a power of two no smaller than 128");
+
+// 不超过 maxBytes 的大小类个数
+constexpr size_t sizeClassCount(size_t maxBytes) {
+    return kLinearMaxBytes / kAlignment +
+           (std::bit_width(maxBytes) - std::bit_width(kLinearMaxBytes)) * kClassesPerDoubling;
+}
+
+constexpr size_t kNumFreeLists = sizeClassCount(kMaxBytes);
+
+// 不小于 bytes 的最小大小类的下标，bytes 必须在 [1, kMaxBytes] 之内
+constexpr size_t sizeClassIndex(size_t bytes) {
+    if (bytes <= kLinearMaxBytes)
+        return (bytes + kAlignment - 1) / kAlignment - 1;
+    // 2^shift < bytes <= 2^(shift + 1)，这一段的档距为 2^shift / kClassesPerDoubling
+    const size_t shift = std::bit_width(bytes - 1) - 1;
+    const size_t stepShift = shift - std::bit_width(kClassesPerDoubling - 1);
+    const size_t step = ((bytes - (size_t(1) << shift)) + (size_t(1) << stepShift) - 1) >> stepShift;
+    return kLinearMaxBytes / kAlignment +
+           (shift - std::bit_width(kLinearMaxBytes - 1)) * kClassesPerDoubling + step - 1;
+}
+
+namespace detail {
+constexpr std::array<size_t, kNumFreeLists> makeSizeClassTable() {
+    std::array<size_t, kNumFreeLists> table{};
+    size_t i = 0;
+    for (size_t bytes = kAlignment; bytes <= kLinearMaxBytes; bytes += kAlignment)
+        table[i++] = bytes;
+    for (size_t base = kLinearMaxBytes; base < kMaxBytes; base *= 2) {
+        for (size_t k = 1; k <= kClassesPerDoubling; ++k)
+            table[i++] = base + k * (base / kClassesPerDoubling);
+    }
+    return table;
+}
+}  // namespace detail
+
+// 各大小类的区块大小，编译期生成
+inline constexpr std::array<size_t, kNumFreeLists> kSizeClassTable = detail::makeSizeClassTable();
+
+// 第 index 个大小类的区块大小
+constexpr size_t sizeClassSize(size_t index) {
+    return kSizeClassTable[index];
+}
+
+// bytes 所在大小类的区块大小
+constexpr size_t sizeClassRoundUp(size_t bytes) {
+    return sizeClassSize(sizeClassIndex(bytes));
+}
+
+// 不超过 bytes 的最大大小类的下标，用于把剩余的零头挂到 free list 上，bytes 不小于 kAlignment
+constexpr size_t sizeClassFloorIndex(size_t bytes) {
+    if (bytes >= kMaxBytes)
+        return kNumFreeLists - 1;
+    size_t index = sizeClassIndex(bytes);
+    return sizeClassSize(index) > bytes ? index - 1 : index;
+}
+
+static_assert(kSizeClassTable.back() == kMaxBytes);
+static_assert(sizeClassIndex(128) == 15 && sizeClassIndex(129) == 16 && sizeClassSize(16) == 144);
+static_assert(sizeClassRoundUp(256) == 256 && sizeClassRoundUp(257) == 288);
+static_assert(sizeClassRoundUp(kMaxBytes) == kMaxBytes && sizeClassFloorIndex(150) == 16);
+
+// 多线程版本中每个线程缓存(magazine)与全局内存池之间一次搬运的区块数，
+// 大区块按 kThreadCacheBytes 限制字节数，但至少搬运 2 个
+// 线程缓存中某个大小的区块超过 2 倍批量时，归还一批给全局池
+constexpr size_t kThreadCacheBatch = 32;
+constexpr size_t kThreadCacheBytes = 64 * 1024;
+
+constexpr size_t threadCacheBatch(size_t index) {
+    return std::clamp(kThreadCacheBytes / sizeClassSize(index), size_t(2), kThreadCacheBatch);
+}
+
+// refill 批量的上下限：批量不少于 kMinRefillObjs 个区块，
+// 不多于 kMaxRefillObjs 个区块且总字节数不超过 kMaxRefillBytes
+constexpr size_t kMinRefillObjs = 4;
+constexpr size_t kMaxRefillObjs = 128;
+constexpr size_t kMaxRefillBytes = 8192;
+// 某个大小类两次 refill 之间，其它大小类 refill 超过这么多次即视为空闲
+constexpr size_t kRefillIdleTicks = 64;
+
+// 单个大小类的 refill 统计
+struct RefillStats {
+    size_t refills = 0;  // refill 次数
+    size_t objects = 0;  // 累计切割出的区块数
+    size_t batch = 0;    // 当前 refill 批量
+};
+
+// tcmalloc 风格的慢启动：大小类第一次 refill 只取 kMinRefillObjs 个区块，
+// 之后每次 refill 批量翻倍直到上限；空闲一段时间后再 refill 时批量减半
+template <size_t NumClasses>
+class RefillController {
+public:
+    // 返回大小类 index (区块大小为 bytes) 本次 refill 应切割的区块数
+    size_t next(size_t index, size_t bytes) {
+        ++tick;
+        RefillStats& s = stats[index];
+        size_t limit = std::clamp(kMaxRefillBytes / bytes, size_t(1), kMaxRefillObjs);
+        size_t floor = std::min(kMinRefillObjs, limit);
+
+        if (s.batch == 0)
+            s.batch = floor;
+        else if (tick - lastTick[index] > kRefillIdleTicks)
+            s.batch = std::max(floor, s.batch / 2);
+        else
+            s.batch = std::min(limit, s.batch * 2);
+
+        lastTick[index] = tick;
+        ++s.refills;
+        return s.batch;
+    }
+
+    // 记录实际切割出的区块数 (内存池不足时可能少于 next() 的返回值)
+    void record(size_t index, size_t nobjs) {
+        stats[index].objects += nobjs;
+    }
+
+    const RefillStats& statsOf(size_t index) const {
+        return stats[index];
+    }
+
+private:
+    RefillStats stats[NumClasses] = {};
+    size_t lastTick[NumClasses] = {};
+    size_t tick = 0;
+};
 
 // 定义分配器类型
 using malloc_alloc = MallocAllocTemplate<0>;
@@ -128,6 +385,11 @@ using alloc = malloc_alloc;
 template <bool threads, int inst>
 class DefaultAllocTemplate {
 public:
+    using Pointer = void*;
+    using ConstPointer = const void*;
+    using SizeType = size_t;
+    using DifferenceType = ptrdiff_t;
+
     template <typename T>
     struct rebind {
         using other = DefaultAllocTemplate<threads, inst>;
@@ -148,11 +410,113 @@ private:
     static typename DefaultAllocTemplate<threads, inst>::Obj* volatile freeList[kNumFreeLists];
 
     static size_t freeListIndex(size_t bytes) {
-        return (((bytes) + kAlignment - 1) / kAlignment - 1);
+        return sizeClassIndex(bytes);
     }
 
     static std::mutex kMutex;
 
+    // 每个线程私有的 free list 缓存，只在 threads == true 时使用
+    // 线程内的分配/释放不加锁，只有批量补充/归还时才访问全局 freeList 并持有 kMutex
+    struct ThreadCache {
+        Obj* lists[kNumFreeLists] = {};
+        size_t counts[kNumFreeLists] = {};
+
+        void* allocate(size_t index, size_t bytes) {
+            Obj* result = lists[index];
+            if (result == nullptr) {
+                fetchFromPool(index, bytes);
+                result = lists[index];
+            }
+            lists[index] = result->freeListLink;
+            --counts[index];
+            return result;
+        }
+
+        void deallocate(size_t index, void* p) {
+            Obj* q = static_cast<Obj*>(p);
+            q->freeListLink = lists[index];
+            lists[index] = q;
+            const size_t batch = threadCacheBatch(index);
+            if (++counts[index] > 2 * batch)
+                releaseToPool(index, batch);
+        }
+
+        // 从全局 freeList 批量取一批区块，不足时由 refill 从内存池切割
+        void fetchFromPool(size_t index, size_t bytes) {
+            const size_t batch = threadCacheBatch(index);
+            std::lock_guard<std::mutex> lock(kMutex);
+            for (size_t i = 0; i < batch; ++i) {
+                Obj* obj = freeList[index];
+                if (obj != nullptr)
+                    freeList[index] = obj->freeListLink;
+                else
+                    obj = static_cast<Obj*>(refill(bytes));
+                obj->freeListLink = lists[index];
+                lists[index] = obj;
+            }
+            counts[index] += batch;
+        }
+
+        // 把本线程缓存中的 n 个区块整串挂回全局 freeList
+        void releaseToPool(size_t index, size_t n) {
+            if (n == 0)
+                return;
+            Obj* first = lists[index];
+            Obj* last = first;
+            for (size_t i = 1; i < n; ++i)
+                last = last->freeListLink;
+            lists[index] = last->freeListLink;
+            counts[index] -= n;
+
+            std::lock_guard<std::mutex> lock(kMutex);
+            last->freeListLink = freeList[index];
+            freeList[index] = first;
+        }
+
+        // 把本线程缓存的全部区块归还全局 freeList
+        void flush() {
+            for (size_t i = 0; i < kNumFreeLists; ++i)
+                releaseToPool(i, counts[i]);
+        }
+
+        // 线程退出时把全部缓存归还全局池，之后本线程的分配请求直接走加锁路径
+        ~ThreadCache() {
+            flush();
+            kThreadCacheRetired = true;
+        }
+    };
+
+    static thread_local bool kThreadCacheRetired;
+
+    static ThreadCache* threadCache() {
+        if (kThreadCacheRetired)
+            return nullptr;
+        thread_local ThreadCache cache;
+        return &cache;
+    }
+
+    static void* allocateFromFreeList(size_t n) {
+        Obj* volatile* myFreeList = freeList + freeListIndex(n);
+        Obj* result = *myFreeList;
+        if (result == nullptr)
+            return refill(sizeClassRoundUp(n));
+        *myFreeList = result->freeListLink;
+        return result;
+    }
+
+    static void deallocateToFreeList(void* p, size_t n) {
+        Obj* q = static_cast<Obj*>(p);
+        Obj* volatile* myFreeList = freeList + freeListIndex(n);
+        q->freeListLink = *myFreeList;
+        *myFreeList = q;
+    }
+
+    // 各大小类的 refill 批量与统计，与 freeList 受同一把锁保护
+    static RefillController<kNumFreeLists> kRefill;
+
+    // 分配/释放计数，只在定义了 MSTL_ALLOC_STATS 时记录
+    static AllocCounters<kNumFreeLists> kStats;
+
     // 返回一个大小为n的对象， 并可能加入大小为n的其他区块到free list
     static void* refill(size_t n);
 
@@ -165,45 +529,146 @@ private:
     static char* endFree;    // 内存池结束位置。 只在chunk_alloc()中变化
     static size_t heapSize;
 
+    // 每个 chunk 开头的管理信息，所有 chunk 串成链表以便 trim 时找出完全空闲的 chunk
+    struct ChunkHeader {
+        ChunkHeader* next;
+        size_t bytes;  // 整个 chunk 的字节数，包括 ChunkHeader
+        bool mapped;   // true: mmap 得到，用 munmap 归还；false: malloc 得到，用 free 归还
+    };
+    static constexpr size_t kChunkHeaderSize =
+        (sizeof(ChunkHeader) + alignof(std::max_align_t) - 1) & ~(alignof(std::max_align_t) - 1);
+
+    static ChunkHeader* chunkList;
+
+    // 大页模式：chunk 从按 kHugePageSize 对齐的区域中切割，[hugeFree, hugeEnd) 是当前区域的剩余部分
+    static bool kHugePages;
+    static char* hugeFree;
+    static char* hugeEnd;
+    static void* carveHugeRegion(size_t pages);
+
+    // 配置一个可容纳至少 bytes 字节的 chunk，bytes 返回实际可用字节数
+    // 优先按页向操作系统申请，失败时退回 malloc；useMallocAlloc 为 true 时使用一级分配器
+    // (可能调用 OOM handler 或抛出 bad_alloc)，否则失败时返回 nullptr
+    static char* allocateChunk(size_t& bytes, bool useMallocAlloc);
+    static void releaseChunk(ChunkHeader* chunk);
+    static size_t releaseUnusedLocked(size_t maxBytes);
+
+    static void fillPoolStats(AllocStatsSnapshot& s) {
+        s.poolBytes = heapSize;
+        for (ChunkHeader* c = chunkList; c != nullptr; c = c->next)
+            ++s.chunks;
+        if constexpr (kAllocStatsEnabled) {
+            for (SizeClassStats& c : s.sizeClasses)
+                c.refills = kRefill.statsOf(freeListIndex(c.size)).refills;
+        }
+    }
+
 public:
     static void* allocate(size_t n) {
-        Obj* volatile* myFreeList;
-        Obj* result;
-        if (n > kMaxBytes)
+        if (n > kMaxBytes) {
+            kStats.recordLargeAlloc(n);
             return malloc_alloc::allocate(n);
+        }
+
+        kStats.recordAlloc(freeListIndex(n), sizeClassRoundUp(n));
+        if constexpr (threads) {
+            if (ThreadCache* cache = threadCache())
+                return cache->allocate(freeListIndex(n), sizeClassRoundUp(n));
+
+            std::lock_guard<std::mutex> lock(kMutex);
+            return allocateFromFreeList(n);
+        } else {
+            return allocateFromFreeList(n);
+        }
+    }
 
-        myFreeList = freeList + freeListIndex(n);
+    static void deallocate(void* p, size_t n) {
+        if (n > kMaxBytes) {
+            kStats.recordLargeFree(n);
+            malloc_alloc::deallocate(p, n);
+            return;
+        }
 
+        kStats.recordFree(freeListIndex(n), sizeClassRoundUp(n));
         if constexpr (threads) {
+            if (ThreadCache* cache = threadCache()) {
+                cache->deallocate(freeListIndex(n), p);
+                return;
+            }
+
             std::lock_guard<std::mutex> lock(kMutex);
+            deallocateToFreeList(p, n);
+        } else {
+            deallocateToFreeList(p, n);
         }
+    }
 
-        result = *myFreeList;
-        if (result == nullptr) {
-            void* r = refill(roundUp(n));
-            return r;
+    // 把完全空闲的 chunk 归还给操作系统，最多归还 maxBytes 字节，返回实际归还的字节数
+    // 调用线程的缓存会先归还全局池，其他线程缓存中的区块不算空闲；长期运行的服务可以定时调用
+    static size_t releaseUnused(size_t maxBytes) {
+        if constexpr (threads) {
+            if (ThreadCache* cache = threadCache())
+                cache->flush();
+            std::lock_guard<std::mutex> lock(kMutex);
+            return releaseUnusedLocked(maxBytes);
+        } else {
+            return releaseUnusedLocked(maxBytes);
         }
-        *myFreeList = result->freeListLink;
+    }
 
-        return result;
+    // 归还所有完全空闲的 chunk
+    static size_t trim() {
+        return releaseUnused(static_cast<size_t>(-1));
     }
 
-    static void deallocate(void* p, size_t n) {
-        Obj* q = static_cast<Obj*>(p);
-        Obj* volatile* myFreeList;
+    // 开启/关闭大页模式，返回原来的设置；只影响之后申请的 chunk
+    // 开启后 chunk 从 2 MiB 对齐、带 MADV_HUGEPAGE 建议的区域中切割，减少大型节点容器的 TLB 缺失；
+    // 没有 mmap 或申请失败时退回普通页，未开启 THP 时区域仍按普通页使用
+    // 也可以在包含头文件前定义 MSTL_ALLOC_HUGE_PAGES 让所有实例默认开启
+    static bool setHugePageArena(bool enable) {
+        if constexpr (threads) {
+            std::lock_guard<std::mutex> lock(kMutex);
+            return std::exchange(kHugePages, enable);
+        } else {
+            return std::exchange(kHugePages, enable);
+        }
+    }
 
-        if (n > kMaxBytes) {
-            malloc_alloc::deallocate(p, n);
-            return;
+    // 返回大小为 bytes 的区块所在大小类的 refill 统计
+    static RefillStats refillStats(size_t bytes) {
+        if constexpr (threads) {
+            std::lock_guard<std::mutex> lock(kMutex);
+            return kRefill.statsOf(freeListIndex(bytes));
+        } else {
+            return kRefill.statsOf(freeListIndex(bytes));
         }
+    }
 
+    // 统计快照：heapSize 与 chunk 数总是有效，分配/释放计数需要定义 MSTL_ALLOC_STATS
+    static AllocStatsSnapshot statsSnapshot() {
+        AllocStatsSnapshot s;
+        s.name = threads ? "thread_safe_alloc" : "default_alloc";
+        kStats.fill(s, sizeClassSize);
         if constexpr (threads) {
             std::lock_guard<std::mutex> lock(kMutex);
+            fillPoolStats(s);
+        } else {
+            fillPoolStats(s);
         }
+        s.updateFragmentation();
+        return s;
+    }
 
-        myFreeList = reinterpret_cast<Obj* volatile*>(&freeList[freeListIndex(n)]);
-        q->freeListLink = *myFreeList;
-        *myFreeList = q;
+    // 小块实际占用整个尺寸类别，大块交给 malloc 查询
+    static size_t usableSize(void* p, size_t n) {
+        if (n <= kMaxBytes)
+            return sizeClassRoundUp(n);
+        size_t usable = malloc_alloc::usableSize(p, n);
+        if (usable > n) {
+            kStats.recordLargeFree(n);
+            kStats.recordLargeAlloc(usable);
+        }
+        return usable;
     }
 
     static void* reallocate(void* p, size_t oldSize, size_t newSize) {
@@ -211,10 +676,13 @@ public:
         size_t copySize;
 
         if (oldSize > kMaxBytes && newSize > kMaxBytes) {
+            kStats.recordLargeFree(oldSize);
+            kStats.recordLargeAlloc(newSize);
             return malloc_alloc::reallocate(p, oldSize, newSize);
         }
 
-        if (roundUp(oldSize) == roundUp(newSize))
+        if (oldSize <= kMaxBytes && newSize <= kMaxBytes &&
+            sizeClassRoundUp(oldSize) == sizeClassRoundUp(newSize))
             return p;
 
         result = allocate(newSize);
@@ -229,11 +697,50 @@ public:
 template <bool threads, int inst>
 ::std::mutex DefaultAllocTemplate<threads, inst>::kMutex;
 
+template <bool threads, int inst>
+thread_local bool DefaultAllocTemplate<threads, inst>::kThreadCacheRetired = false;
+
+template <bool threads, int inst>
+RefillController<kNumFreeLists> DefaultAllocTemplate<threads, inst>::kRefill;
+
+template <bool threads, int inst>
+AllocCounters<kNumFreeLists> DefaultAllocTemplate<threads, inst>::kStats;
+
 // 定义分配器类型
 using default_alloc = DefaultAllocTemplate<false, 0>;     // 单线程版本
 using thread_safe_alloc = DefaultAllocTemplate<true, 0>;  // 多线程版本
 
-// 简单的分配器封装
+namespace detail {
+// 读取分配器声明的 PropagateOnContainer* / IsAlwaysEqual，没有声明时使用默认值：
+// 不传播；空类 (只有静态接口) 的分配器总是相等
+template <typename A, typename = void>
+struct PropagateOnCopyAssignment : std::false_type {};
+template <typename A>
+struct PropagateOnCopyAssignment<A, std::void_t<typename A::PropagateOnContainerCopyAssignment>>
+    : std::bool_constant<A::PropagateOnContainerCopyAssignment::value> {};
+
+template <typename A, typename = void>
+struct PropagateOnMoveAssignment : std::false_type {};
+template <typename A>
+struct PropagateOnMoveAssignment<A, std::void_t<typename A::PropagateOnContainerMoveAssignment>>
+    : std::bool_constant<A::PropagateOnContainerMoveAssignment::value> {};
+
+template <typename A, typename = void>
+struct PropagateOnSwap : std::false_type {};
+template <typename A>
+struct PropagateOnSwap<A, std::void_t<typename A::PropagateOnContainerSwap>>
+    : std::bool_constant<A::PropagateOnContainerSwap::value> {};
+
+template <typename A, typename = void>
+struct IsAlwaysEqual : std::is_empty<A> {};
+template <typename A>
+struct IsAlwaysEqual<A, std::void_t<typename A::IsAlwaysEqual>>
+    : std::bool_constant<A::IsAlwaysEqual::value> {};
+}  // namespace detail
+
+// 简单的分配器封装：把按字节分配的 Alloc 变成按 Tp 个数分配
+// 保存一个 Alloc 实例，Alloc 是空类 (DefaultAllocTemplate 等静态分配器) 时不占空间；
+// Alloc 有状态时 (例如 ArenaRef) 每个容器可以使用自己的内存来源
 template <typename Tp, typename Alloc>
 class SimpleAlloc {
 public:
@@ -245,22 +752,74 @@ public:
     using SizeType = size_t;
     using DifferenceType = ptrdiff_t;
 
+    using PropagateOnContainerCopyAssignment =
+        std::bool_constant<detail::PropagateOnCopyAssignment<Alloc>::value>;
+    using PropagateOnContainerMoveAssignment =
+        std::bool_constant<detail::PropagateOnMoveAssignment<Alloc>::value>;
+    using PropagateOnContainerSwap = std::bool_constant<detail::PropagateOnSwap<Alloc>::value>;
+    using IsAlwaysEqual = std::bool_constant<detail::IsAlwaysEqual<Alloc>::value>;
+
     template <typename U>
     struct RebindAlloc {
         using Other = SimpleAlloc<U, Alloc>;
     };
 
-    static Tp* allocate(size_t n = 1) {
-        Alloc a;
-        return 0 == n ? 0 : reinterpret_cast<Tp*>(a.allocate(n * sizeof(Tp)));
+    SimpleAlloc() = default;
+    explicit SimpleAlloc(const Alloc& a) : alloc(a) {}
+    template <typename U>
+    SimpleAlloc(const SimpleAlloc<U, Alloc>& other) : alloc(other.rawAllocator()) {}
+
+    Tp* allocate(size_t n = 1) {
+        return 0 == n ? 0 : reinterpret_cast<Tp*>(alloc.allocate(n * sizeof(Tp)));
     }
 
-    static void deallocate(Tp* p, size_t n = 1) {
-        if (p != 0) {
-            Alloc a;
-            a.deallocate(reinterpret_cast<typename Alloc::Pointer>(p), n * sizeof(Tp));
+    void deallocate(Tp* p, size_t n = 1) {
+        if (p != 0)
+            alloc.deallocate(reinterpret_cast<typename Alloc::Pointer>(p), n * sizeof(Tp));
+    }
+
+    // 只用于可平凡重定位的 Tp：把 p 处的 oldN 个元素按字节搬到 newN 个元素的空间，
+    // 底层分配器有 reallocate 时交给它 (malloc 可能原地扩展，不需要新旧两块同时存在)，
+    // 否则分配新块、memcpy、释放旧块
+    Tp* reallocate(Tp* p, size_t oldN, size_t newN) {
+        if (p == 0)
+            return allocate(newN);
+        if constexpr (requires(void* q, size_t n) { alloc.reallocate(q, n, n); }) {
+            return reinterpret_cast<Tp*>(alloc.reallocate(p, oldN * sizeof(Tp), newN * sizeof(Tp)));
+        } else {
+            Tp* result = allocate(newN);
+            std::memcpy(static_cast<void*>(result), static_cast<const void*>(p),
+                        (oldN < newN ? oldN : newN) * sizeof(Tp));
+            deallocate(p, oldN);
+            return result;
         }
     }
+
+    // allocate(n) 或 reallocate(p, ..., n) 得到的块 p 实际能容纳的元素个数 (不小于 n)，
+    // 底层分配器不提供 usableSize 时就是 n
+    size_t usableSize(Tp* p, size_t n) const {
+        if constexpr (requires(void* q, size_t m) { alloc.usableSize(q, m); })
+            return alloc.usableSize(p, n * sizeof(Tp)) / sizeof(Tp);
+        else
+            return n;
+    }
+
+    // 被封装的按字节分配的分配器
+    const Alloc& rawAllocator() const {
+        return alloc;
+    }
+
+    // 相等的两个分配器可以互相释放对方分配的内存
+    template <typename U>
+    bool operator==(const SimpleAlloc<U, Alloc>& other) const {
+        if constexpr (IsAlwaysEqual::value)
+            return true;
+        else
+            return alloc == other.rawAllocator();
+    }
+
+private:
+    [[no_unique_address]] Alloc alloc;
 };
 
 template <bool threads, int inst>
@@ -272,17 +831,36 @@ char* DefaultAllocTemplate<threads, inst>::endFree = nullptr;
 template <bool threads, int inst>
 size_t DefaultAllocTemplate<threads, inst>::heapSize = 0;
 
+template <bool threads, int inst>
+typename DefaultAllocTemplate<threads, inst>::ChunkHeader*
+    DefaultAllocTemplate<threads, inst>::chunkList = nullptr;
+
+#ifdef MSTL_ALLOC_HUGE_PAGES
+template <bool threads, int inst>
+bool DefaultAllocTemplate<threads, inst>::kHugePages = true;
+#else
+template <bool threads, int inst>
+bool DefaultAllocTemplate<threads, inst>::kHugePages = false;
+#endif
+
+template <bool threads, int inst>
+char* DefaultAllocTemplate<threads, inst>::hugeFree = nullptr;
+
+template <bool threads, int inst>
+char* DefaultAllocTemplate<threads, inst>::hugeEnd = nullptr;
+
 template <bool threads, int inst>
 typename DefaultAllocTemplate<threads, inst>::Obj* volatile DefaultAllocTemplate<
     threads, inst>::freeList[kNumFreeLists] = {0};  // 定义
 
 template <bool threads, int inst>
 void* DefaultAllocTemplate<threads, inst>::refill(size_t n) {
-    int nobjs = 20;
+    int nobjs = static_cast<int>(kRefill.next(freeListIndex(n), n));
     char* chunk = chunkAlloc(n, nobjs);
     if (chunk == nullptr) {
         return nullptr;
     }
+    kRefill.record(freeListIndex(n), nobjs);
 
     Obj* volatile* myFreeList;
     Obj* result;
@@ -329,30 +907,34 @@ char* DefaultAllocTemplate<threads, inst>::chunkAlloc(size_t size, int& nobjs) {
     } else {
         size_t bytesToGet = 2 * totalBytes + roundUp(heapSize >> 4);
 
-        if (bytesLeft > 0) {
-            Obj* volatile* myFreeList = std::begin(freeList) + freeListIndex(bytesLeft);
+        // 把内存池剩余的零头按能放下的最大大小类切开，挂到对应的 free list 上
+        while (bytesLeft >= kAlignment) {
+            size_t index = sizeClassFloorIndex(bytesLeft);
+            Obj* volatile* myFreeList = std::begin(freeList) + index;
             Obj* head = reinterpret_cast<Obj*>(startFree);
             head->freeListLink = *myFreeList;
             *myFreeList = head;
+            startFree += sizeClassSize(index);
+            bytesLeft -= sizeClassSize(index);
         }
 
-        startFree = static_cast<char*>(std::malloc(bytesToGet));
+        startFree = allocateChunk(bytesToGet, false);
         if (startFree == nullptr) {
             size_t i;
             Obj *volatile *myFreeList, *p;
 
-            for (i = size; i <= kMaxBytes; i += kAlignment) {
-                myFreeList = std::begin(freeList) + freeListIndex(i);
+            for (i = freeListIndex(size); i < kNumFreeLists; ++i) {
+                myFreeList = std::begin(freeList) + i;
                 p = *myFreeList;
                 if (nullptr != p) {
                     *myFreeList = p->freeListLink;
                     startFree = reinterpret_cast<char*>(p);
-                    endFree = startFree + i;
+                    endFree = startFree + sizeClassSize(i);
                     return chunkAlloc(size, nobjs);
                 }
             }
             endFree = nullptr;
-            startFree = static_cast<char*>(malloc_alloc::allocate(bytesToGet));
+            startFree = allocateChunk(bytesToGet, true);
         }
         heapSize += bytesToGet;
         endFree = startFree + bytesToGet;
@@ -361,6 +943,157 @@ char* DefaultAllocTemplate<threads, inst>::chunkAlloc(size_t size, int& nobjs) {
     return nullptr;
 }
 
+template <bool threads, int inst>
+char* DefaultAllocTemplate<threads, inst>::allocateChunk(size_t& bytes, bool useMallocAlloc) {
+    size_t total = bytes + kChunkHeaderSize;
+    void* p = nullptr;
+    bool mapped = false;
+
+    if (useMallocAlloc) {
+        p = malloc_alloc::allocate(total);
+    } else {
+        size_t pages = detail::roundUpToPage(total);
+        if (kHugePages)
+            p = carveHugeRegion(pages);
+        if (p == nullptr)
+            p = detail::osMapPages(pages);
+        if (p != nullptr) {
+            total = pages;
+            mapped = true;
+        } else {
+            p = std::malloc(total);
+        }
+    }
+    if (p == nullptr)
+        return nullptr;
+
+    ChunkHeader* chunk = static_cast<ChunkHeader*>(p);
+    chunk->bytes = total;
+    chunk->mapped = mapped;
+    chunk->next = chunkList;
+    chunkList = chunk;
+
+    bytes = total - kChunkHeaderSize;
+    return static_cast<char*>(p) + kChunkHeaderSize;
+}
+
+template <bool threads, int inst>
+void* DefaultAllocTemplate<threads, inst>::carveHugeRegion(size_t pages) {
+    if (static_cast<size_t>(hugeEnd - hugeFree) < pages) {
+        size_t regionBytes = (pages + detail::kHugePageSize - 1) & ~(detail::kHugePageSize - 1);
+        char* region = static_cast<char*>(detail::osMapAligned(regionBytes, detail::kHugePageSize));
+        if (region == nullptr)
+            return nullptr;
+        detail::osAdviseHugePages(region, regionBytes);
+
+        // 旧区域放不下这个 chunk 的剩余部分直接归还系统
+        if (hugeFree != hugeEnd)
+            detail::osUnmapPages(hugeFree, hugeEnd - hugeFree);
+        hugeFree = region;
+        hugeEnd = region + regionBytes;
+    }
+
+    void* p = hugeFree;
+    hugeFree += pages;
+    return p;
+}
+
+template <bool threads, int inst>
+void DefaultAllocTemplate<threads, inst>::releaseChunk(ChunkHeader* chunk) {
+    if (chunk->mapped)
+        detail::osUnmapPages(chunk, chunk->bytes);
+    else
+        std::free(chunk);
+}
+
+template <bool threads, int inst>
+size_t DefaultAllocTemplate<threads, inst>::releaseUnusedLocked(size_t maxBytes) {
+    struct ChunkInfo {
+        char* begin;
+        char* end;
+        ChunkHeader* header;
+        size_t freeBytes;
+        bool release;
+    };
+
+    // 按地址排序的 chunk 表，用于把空闲区块归到所属 chunk
+    std::vector<ChunkInfo> chunks;
+    for (ChunkHeader* c = chunkList; c != nullptr; c = c->next) {
+        char* begin = reinterpret_cast<char*>(c) + kChunkHeaderSize;
+        chunks.push_back({begin, reinterpret_cast<char*>(c) + c->bytes, c, 0, false});
+    }
+    std::sort(chunks.begin(), chunks.end(),
+              [](const ChunkInfo& a, const ChunkInfo& b) { return a.begin < b.begin; });
+
+    auto findChunk = [&chunks](const void* p) -> ChunkInfo* {
+        const char* addr = static_cast<const char*>(p);
+        auto it = std::upper_bound(chunks.begin(), chunks.end(), addr,
+                                   [](const char* a, const ChunkInfo& c) { return a < c.begin; });
+        if (it == chunks.begin() || addr >= (it - 1)->end)
+            return nullptr;
+        return &*(it - 1);
+    };
+
+    // 统计每个 chunk 中空闲的字节数: free list 上的区块 + 内存池中尚未切割的部分
+    for (size_t i = 0; i < kNumFreeLists; ++i) {
+        for (Obj* obj = freeList[i]; obj != nullptr; obj = obj->freeListLink) {
+            if (ChunkInfo* c = findChunk(obj))
+                c->freeBytes += sizeClassSize(i);
+        }
+    }
+    if (startFree != endFree) {
+        if (ChunkInfo* c = findChunk(startFree))
+            c->freeBytes += endFree - startFree;
+    }
+
+    size_t released = 0;
+    for (ChunkInfo& c : chunks) {
+        size_t bytes = c.end - c.begin;
+        if (c.freeBytes == bytes && released + c.header->bytes <= maxBytes) {
+            c.release = true;
+            released += c.header->bytes;
+        }
+    }
+    if (released == 0)
+        return 0;
+
+    // 从 free list 中摘掉位于待归还 chunk 中的区块
+    for (size_t i = 0; i < kNumFreeLists; ++i) {
+        Obj* kept = nullptr;
+        Obj* obj = freeList[i];
+        while (obj != nullptr) {
+            Obj* next = obj->freeListLink;
+            ChunkInfo* c = findChunk(obj);
+            if (c == nullptr || !c->release) {
+                obj->freeListLink = kept;
+                kept = obj;
+            }
+            obj = next;
+        }
+        freeList[i] = kept;
+    }
+    if (startFree != endFree) {
+        ChunkInfo* c = findChunk(startFree);
+        if (c != nullptr && c->release)
+            startFree = endFree = nullptr;
+    }
+
+    // 从 chunk 链表中摘除并归还
+    ChunkHeader** link = &chunkList;
+    while (*link != nullptr) {
+        ChunkHeader* c = *link;
+        ChunkInfo* info = findChunk(reinterpret_cast<char*>(c) + kChunkHeaderSize);
+        if (info != nullptr && info->release) {
+            *link = c->next;
+            heapSize -= c->bytes - kChunkHeaderSize;
+            releaseChunk(c);
+        } else {
+            link = &c->next;
+        }
+    }
+    return released;
+}
+
 }  // namespace mstl
 
 #endif  // __MSGI_STL_INTERNAL_ALLOC_H
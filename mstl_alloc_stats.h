@@ -0,0 +1,157 @@
+#ifndef __MSGI_STL_INTERNAL_ALLOC_STATS_H
+#define __MSGI_STL_INTERNAL_ALLOC_STATS_H
+
+#include <atomic>
+#include <cstddef>
+#include <ostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+// 分配器统计：在包含任何分配器头文件之前定义 MSTL_ALLOC_STATS 即可开启
+// 未开启时计数器是空类，记录函数都是空的 inline 函数，分配/释放路径上不留下任何代码
+#ifdef MSTL_ALLOC_STATS
+#define MSTL_ALLOC_STATS_ENABLED 1
+#else
+#define MSTL_ALLOC_STATS_ENABLED 0
+#endif
+
+namespace mstl {
+
+inline constexpr bool kAllocStatsEnabled = MSTL_ALLOC_STATS_ENABLED;
+
+// 单个大小类的统计
+struct SizeClassStats {
+    size_t size = 0;     // 区块大小
+    size_t allocs = 0;   // 分配次数
+    size_t frees = 0;    // 释放次数
+    size_t refills = 0;  // refill 次数
+};
+
+// 某个分配器在某一时刻的统计快照
+// poolBytes 与 chunks 总是有效；其余计数只在 enabled 为 true 时有效
+struct AllocStatsSnapshot {
+    std::string name;
+    bool enabled = kAllocStatsEnabled;
+    std::vector<SizeClassStats> sizeClasses;  // 只列出有过分配、释放或 refill 的大小类
+    size_t largeAllocs = 0;     // 超出大小类、直接交给 malloc 的分配次数
+    size_t largeFrees = 0;      // 超出大小类的释放次数
+    size_t liveBytes = 0;       // 内存池中正在使用的字节数 (按大小类取整)
+    size_t largeLiveBytes = 0;  // 超出大小类、正在使用的字节数
+    size_t poolBytes = 0;       // 内存池向系统申请的总字节数 (heapSize / heap_size)
+    size_t chunks = 0;          // 内存池持有的 chunk / span / buffer 个数
+    double fragmentation = 0;   // 内存池中没有被使用的比例：1 - liveBytes / poolBytes
+
+    void updateFragmentation() {
+        if (enabled && poolBytes != 0 && liveBytes <= poolBytes)
+            fragmentation = 1.0 - static_cast<double>(liveBytes) / static_cast<double>(poolBytes);
+        else
+            fragmentation = 0;
+    }
+};
+
+// 分配器内部使用的计数器，NumClasses 个大小类
+// 所有计数使用 relaxed 原子操作，快照只保证每个计数各自准确
+template <size_t NumClasses, bool Enabled = kAllocStatsEnabled>
+class AllocCounters {
+public:
+    void recordAlloc(size_t index, size_t bytes) {
+        allocs[index].fetch_add(1, std::memory_order_relaxed);
+        liveBytes.fetch_add(bytes, std::memory_order_relaxed);
+    }
+
+    void recordFree(size_t index, size_t bytes) {
+        frees[index].fetch_add(1, std::memory_order_relaxed);
+        liveBytes.fetch_sub(bytes, std::memory_order_relaxed);
+    }
+
+    void recordLargeAlloc(size_t bytes) {
+        largeAllocs.fetch_add(1, std::memory_order_relaxed);
+        largeLiveBytes.fetch_add(bytes, std::memory_order_relaxed);
+    }
+
+    void recordLargeFree(size_t bytes) {
+        largeFrees.fetch_add(1, std::memory_order_relaxed);
+        largeLiveBytes.fetch_sub(bytes, std::memory_order_relaxed);
+    }
+
+    void recordRefill(size_t index) {
+        refills[index].fetch_add(1, std::memory_order_relaxed);
+    }
+
+    // 把计数写入快照，classSize(i) 返回第 i 个大小类的区块大小
+    template <typename ClassSize>
+    void fill(AllocStatsSnapshot& s, ClassSize classSize) const {
+        for (size_t i = 0; i < NumClasses; ++i) {
+            SizeClassStats c;
+            c.size = classSize(i);
+            c.allocs = allocs[i].load(std::memory_order_relaxed);
+            c.frees = frees[i].load(std::memory_order_relaxed);
+            c.refills = refills[i].load(std::memory_order_relaxed);
+            if (c.allocs != 0 || c.frees != 0 || c.refills != 0)
+                s.sizeClasses.push_back(c);
+        }
+        s.largeAllocs = largeAllocs.load(std::memory_order_relaxed);
+        s.largeFrees = largeFrees.load(std::memory_order_relaxed);
+        s.liveBytes = liveBytes.load(std::memory_order_relaxed);
+        s.largeLiveBytes = largeLiveBytes.load(std::memory_order_relaxed);
+    }
+
+private:
+    std::atomic<size_t> allocs[NumClasses] = {};
+    std::atomic<size_t> frees[NumClasses] = {};
+    std::atomic<size_t> refills[NumClasses] = {};
+    std::atomic<size_t> largeAllocs{0};
+    std::atomic<size_t> largeFrees{0};
+    std::atomic<size_t> liveBytes{0};
+    std::atomic<size_t> largeLiveBytes{0};
+};
+
+// 未开启统计：空类，所有记录函数在编译后消失
+template <size_t NumClasses>
+class AllocCounters<NumClasses, false> {
+public:
+    void recordAlloc(size_t, size_t) {}
+    void recordFree(size_t, size_t) {}
+    void recordLargeAlloc(size_t) {}
+    void recordLargeFree(size_t) {}
+    void recordRefill(size_t) {}
+    template <typename ClassSize>
+    void fill(AllocStatsSnapshot&, ClassSize) const {}
+};
+
+// 以 JSON 格式输出快照
+inline void dumpJson(std::ostream& os, const AllocStatsSnapshot& s) {
+    os << "{\"name\":\"" << s.name << "\",\"enabled\":" << (s.enabled ? "true" : "false")
+       << ",\"pool_bytes\":" << s.poolBytes << ",\"chunks\":" << s.chunks
+       << ",\"live_bytes\":" << s.liveBytes << ",\"large_live_bytes\":" << s.largeLiveBytes
+       << ",\"large_allocs\":" << s.largeAllocs << ",\"large_frees\":" << s.largeFrees
+       << ",\"fragmentation\":" << s.fragmentation << ",\"size_classes\":[";
+    for (size_t i = 0; i < s.sizeClasses.size(); ++i) {
+        const SizeClassStats& c = s.sizeClasses[i];
+        os << (i ? "," : "") << "{\"size\":" << c.size << ",\"allocs\":" << c.allocs
+           << ",\"frees\":" << c.frees << ",\"refills\":" << c.refills << "}";
+    }
+    os << "]}";
+}
+
+// 以 JSON 数组格式输出多个快照
+inline void dumpJson(std::ostream& os, const std::vector<AllocStatsSnapshot>& snapshots) {
+    os << "[";
+    for (size_t i = 0; i < snapshots.size(); ++i) {
+        if (i)
+            os << ",";
+        dumpJson(os, snapshots[i]);
+    }
+    os << "]";
+}
+
+inline std::string toJson(const AllocStatsSnapshot& s) {
+    std::ostringstream os;
+    dumpJson(os, s);
+    return os.str();
+}
+
+}  // namespace mstl
+
+#endif  // __MSGI_STL_INTERNAL_ALLOC_STATS_H
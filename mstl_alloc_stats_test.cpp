@@ -0,0 +1,167 @@
+#define MSTL_ALLOC_STATS
+#include "mstl_alloc_stats.h"
+#include <cassert>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <vector>
+#include "mpthread_alloc.h"
+#include "mstl_alloc.h"
+#include "mstl_allocator.h"
+
+// 未开启统计时计数器不占任何空间
+static_assert(std::is_empty_v<mstl::AllocCounters<16, false>>);
+static_assert(mstl::kAllocStatsEnabled);
+
+// 找到快照中区块大小为 size 的大小类，不存在时返回全 0
+mstl::SizeClassStats findClass(const mstl::AllocStatsSnapshot& s, size_t size) {
+    for (const auto& c : s.sizeClasses) {
+        if (c.size == size)
+            return c;
+    }
+    return {};
+}
+
+void testMallocAllocStats() {
+    std::cout << "=== 一级分配器统计测试 ===" << std::endl;
+    using Alloc = mstl::MallocAllocTemplate<1>;
+
+    void* p = Alloc::allocate(1000);
+    p = Alloc::reallocate(p, 1000, 3000);
+    void* q = Alloc::allocate(500);
+
+    mstl::AllocStatsSnapshot s = Alloc::statsSnapshot();
+    assert(s.enabled);
+    assert(s.largeAllocs == 3 && s.largeFrees == 1);
+    assert(s.largeLiveBytes == 3500);
+
+    Alloc::deallocate(p, 3000);
+    Alloc::deallocate(q, 500);
+    s = Alloc::statsSnapshot();
+    assert(s.largeLiveBytes == 0);
+    std::cout << mstl::toJson(s) << std::endl;
+}
+
+void testDefaultAllocStats() {
+    std::cout << "\n=== 二级分配器统计测试 ===" << std::endl;
+    using Pool = mstl::DefaultAllocTemplate<false, 4>;
+
+    std::vector<void*> ptrs;
+    for (int i = 0; i < 1000; ++i)
+        ptrs.push_back(Pool::allocate(20));  // 大小类 24
+    void* big = Pool::allocate(65536);
+
+    mstl::AllocStatsSnapshot s = Pool::statsSnapshot();
+    mstl::SizeClassStats c = findClass(s, 24);
+    assert(c.allocs == 1000 && c.frees == 0 && c.refills > 0);
+    assert(s.liveBytes == 1000 * 24);
+    assert(s.largeAllocs == 1 && s.largeLiveBytes == 65536);
+    assert(s.poolBytes >= s.liveBytes && s.chunks > 0);
+    assert(s.fragmentation >= 0 && s.fragmentation < 1);
+
+    for (void* p : ptrs)
+        Pool::deallocate(p, 20);
+    Pool::deallocate(big, 65536);
+    s = Pool::statsSnapshot();
+    assert(findClass(s, 24).frees == 1000);
+    assert(s.liveBytes == 0 && s.largeLiveBytes == 0);
+    assert(s.fragmentation == 1.0);
+    std::cout << mstl::toJson(s) << std::endl;
+}
+
+void testThreadSafeAllocStats() {
+    std::cout << "\n=== 多线程二级分配器统计测试 ===" << std::endl;
+    using Pool = mstl::DefaultAllocTemplate<true, 4>;
+
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; ++t) {
+        threads.emplace_back([]() {
+            for (int i = 0; i < 1000; ++i)
+                Pool::deallocate(Pool::allocate(64), 64);
+        });
+    }
+    for (auto& th : threads)
+        th.join();
+
+    mstl::AllocStatsSnapshot s = Pool::statsSnapshot();
+    mstl::SizeClassStats c = findClass(s, 64);
+    assert(c.allocs == 4000 && c.frees == 4000);
+    assert(s.liveBytes == 0);
+}
+
+void testPthreadAllocStats() {
+    std::cout << "\n=== pthread 分配器统计测试 ===" << std::endl;
+    using Alloc = mstl::PthreadAllocatorTemplate<>;
+
+    void* remote = nullptr;
+    std::thread([&remote]() { remote = Alloc::allocate(40); }).join();
+
+    std::vector<void*> ptrs;
+    for (int i = 0; i < 500; ++i)
+        ptrs.push_back(Alloc::allocate(40));
+
+    mstl::AllocStatsSnapshot s = Alloc::stats_snapshot();
+    mstl::SizeClassStats c = findClass(s, 40);
+    assert(c.allocs == 501 && c.refills > 0);
+    assert(s.liveBytes == 501 * 40);
+    assert(s.chunks >= 1 && s.poolBytes >= s.chunks * mstl::SPAN_SIZE);
+
+    for (void* p : ptrs)
+        Alloc::deallocate(p, 40);
+    Alloc::deallocate(remote, 40);
+    s = Alloc::stats_snapshot();
+    assert(findClass(s, 40).frees == 501 && s.liveBytes == 0);
+    std::cout << mstl::toJson(s) << std::endl;
+}
+
+void testMemoryPoolStats() {
+    std::cout << "\n=== MemoryPool 统计测试 ===" << std::endl;
+    mstl::PoolAllocator<double, 64> alloc;
+
+    std::vector<double*> ptrs;
+    for (int i = 0; i < 300; ++i)
+        ptrs.push_back(alloc.allocate(1));
+
+    mstl::AllocStatsSnapshot s = alloc.statsSnapshot();
+    assert(findClass(s, sizeof(double)).allocs == 300);
+    assert(s.liveBytes == 300 * sizeof(double));
+    assert(s.chunks > 0);
+
+    for (double* p : ptrs)
+        alloc.deallocate(p, 1);
+    s = alloc.statsSnapshot();
+    assert(s.liveBytes == 0);
+    std::cout << mstl::toJson(s) << std::endl;
+}
+
+// 多个分配器的快照一起输出为 JSON 数组
+void testDumpJson() {
+    std::cout << "\n=== JSON 输出测试 ===" << std::endl;
+    std::vector<mstl::AllocStatsSnapshot> snapshots = {
+        mstl::malloc_alloc::statsSnapshot(),
+        mstl::default_alloc::statsSnapshot(),
+        mstl::thread_safe_alloc::statsSnapshot(),
+        mstl::PthreadAllocatorTemplate<>::stats_snapshot(),
+    };
+
+    std::ostringstream os;
+    mstl::dumpJson(os, snapshots);
+    std::string json = os.str();
+    std::cout << json << std::endl;
+    assert(json.front() == '[' && json.back() == ']');
+    assert(json.find("\"name\":\"pthread_alloc\"") != std::string::npos);
+    assert(json.find("\"fragmentation\":") != std::string::npos);
+}
+
+int main() {
+    testMallocAllocStats();
+    testDefaultAllocStats();
+    testThreadSafeAllocStats();
+    testPthreadAllocStats();
+    testMemoryPoolStats();
+    testDumpJson();
+    std::cout << "\n所有统计测试通过" << std::endl;
+    return 0;
+}
@@ -1,8 +1,22 @@
 #include "mstl_alloc.h"
+#include <algorithm>
+#include <cassert>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <iomanip>
 #include <iostream>
+#include <mutex>
+#include <numeric>
+#include <random>
+#include <string>
+#include <thread>
 #include <vector>
 #include "mstl_allocator.h"
 #include "mstl_construct.h"
+#include "mstl_functional.h"
+#include "mstl_list.h"
+#include "mstl_tree.h"
 
 // 基本功能测试
 void testBasicAllocation() {
@@ -63,10 +77,306 @@ void testAllocatorClass() {
     std::cout << "释放成功" << std::endl;
 }
 
+// 测试多线程版本：各线程通过自己的缓存分配/释放，数据互不干扰
+void testThreadSafeAllocation() {
+    std::cout << "\n=== 多线程分配器测试 ===" << std::endl;
+
+    const int numThreads = 8;
+    const int numAllocations = 2000;
+    std::vector<std::thread> threads;
+    for (int t = 0; t < numThreads; ++t) {
+        threads.emplace_back([t]() {
+            std::vector<std::uint32_t*> ptrs;
+            for (int i = 0; i < numAllocations; ++i) {
+                size_t bytes = sizeof(std::uint32_t) * (1 + i % 32);
+                auto* p = static_cast<std::uint32_t*>(mstl::thread_safe_alloc::allocate(bytes));
+                *p = static_cast<std::uint32_t>(t * numAllocations + i);
+                ptrs.push_back(p);
+            }
+            for (int i = 0; i < numAllocations; ++i) {
+                assert(*ptrs[i] == static_cast<std::uint32_t>(t * numAllocations + i));
+                mstl::thread_safe_alloc::deallocate(ptrs[i], sizeof(std::uint32_t) * (1 + i % 32));
+            }
+        });
+    }
+    for (auto& th : threads) {
+        th.join();
+    }
+
+    // 另一个线程释放本线程分配的内存
+    void* p = mstl::thread_safe_alloc::allocate(48);
+    std::thread([p]() { mstl::thread_safe_alloc::deallocate(p, 48); }).join();
+    std::cout << "多线程分配器测试通过" << std::endl;
+}
+
+// 链表与红黑树节点的插入风暴，观察各大小类 refill 的次数与批量
+void testAdaptiveRefill() {
+    std::cout << "\n=== 自适应 refill 批量测试 ===" << std::endl;
+    using Pool = mstl::DefaultAllocTemplate<false, 2>;
+    mstl::SimpleAlloc<mstl::RbTreeNode<int>, Pool> treeNodeAlloc;
+
+    const int numNodes = 100000;
+    {
+        mstl::List<int, Pool> list;
+        for (int i = 0; i < numNodes; ++i)
+            list.push_back(i);
+    }
+
+    std::vector<mstl::RbTreeNode<int>*> nodes;
+    for (int i = 0; i < numNodes; ++i)
+        nodes.push_back(treeNodeAlloc.allocate());
+    for (auto* node : nodes)
+        treeNodeAlloc.deallocate(node);
+
+    std::cout << std::setw(10) << "区块大小" << std::setw(10) << "refill" << std::setw(12)
+              << "区块总数" << std::setw(10) << "批量" << std::endl;
+    for (size_t i = 0; i < mstl::kNumFreeLists; ++i) {
+        size_t bytes = mstl::sizeClassSize(i);
+        mstl::RefillStats stats = Pool::refillStats(bytes);
+        if (stats.refills == 0)
+            continue;
+        std::cout << std::setw(10) << bytes << std::setw(10) << stats.refills << std::setw(12)
+                  << stats.objects << std::setw(10) << stats.batch << std::endl;
+    }
+
+    // 固定 20 个一批需要 numNodes / 20 次 refill，慢启动后批量增大，次数应明显更少
+    mstl::RefillStats listStats = Pool::refillStats(sizeof(mstl::ListNode<int>));
+    mstl::RefillStats treeStats = Pool::refillStats(sizeof(mstl::RbTreeNode<int>));
+    assert(listStats.refills < numNodes / 20);
+    assert(treeStats.refills < numNodes / 20);
+    assert(listStats.batch > 20 && treeStats.batch > 20);
+    std::cout << "自适应 refill 批量测试通过" << std::endl;
+}
+
+// 大小类表：128 字节以内按 8 字节分档，之后相邻大小类相差不超过 12.5%
+void testSizeClasses() {
+    std::cout << "\n=== 大小类测试 ===" << std::endl;
+    std::cout << "大小类个数: " << mstl::kNumFreeLists << "，最大区块: " << mstl::kMaxBytes
+              << " 字节" << std::endl;
+
+    for (size_t i = 1; i < mstl::kNumFreeLists; ++i) {
+        size_t prev = mstl::sizeClassSize(i - 1);
+        size_t cur = mstl::sizeClassSize(i);
+        assert(cur > prev && cur % mstl::kAlignment == 0);
+        if (prev >= mstl::kLinearMaxBytes)
+            assert((cur - prev) * 8 <= prev);
+    }
+    for (size_t bytes = 1; bytes <= mstl::kMaxBytes; ++bytes) {
+        size_t index = mstl::sizeClassIndex(bytes);
+        assert(mstl::sizeClassSize(index) >= bytes);
+        assert(index == 0 || mstl::sizeClassSize(index - 1) < bytes);
+    }
+
+    // 字符串对的红黑树节点、deque 缓冲区等中等大小的对象也由内存池负责
+    using Pool = mstl::DefaultAllocTemplate<false, 5>;
+    const size_t sizes[] = {sizeof(mstl::RbTreeNode<std::pair<std::string, std::string>>), 512,
+                            1000, 4096, mstl::kMaxBytes};
+    for (size_t bytes : sizes) {
+        std::vector<void*> ptrs;
+        for (int i = 0; i < 100; ++i) {
+            ptrs.push_back(Pool::allocate(bytes));
+            std::memset(ptrs.back(), 0xab, bytes);
+        }
+        for (void* p : ptrs)
+            Pool::deallocate(p, bytes);
+        assert(Pool::refillStats(bytes).refills > 0);
+        std::cout << bytes << " 字节 -> 大小类 " << mstl::sizeClassRoundUp(bytes) << std::endl;
+    }
+    std::cout << "大小类测试通过" << std::endl;
+}
+
+// 中等大小对象反复分配/释放：内存池与 malloc 对比
+void benchmarkMidSizeAllocation() {
+    std::cout << "\n=== 中等大小对象分配测试 (256 个对象 x 2000 轮) ===" << std::endl;
+    std::cout << std::setw(10) << "区块大小" << std::setw(16) << "malloc(秒)" << std::setw(16)
+              << "内存池(秒)" << std::endl;
+
+    auto run = [](auto allocate, auto deallocate, size_t bytes) {
+        void* ptrs[256];
+        auto start = std::chrono::high_resolution_clock::now();
+        for (int r = 0; r < 2000; ++r) {
+            for (size_t i = 0; i < 256; ++i)
+                ptrs[i] = allocate(bytes + i % 8);
+            for (size_t i = 0; i < 256; ++i)
+                deallocate(ptrs[i], bytes + i % 8);
+        }
+        auto end = std::chrono::high_resolution_clock::now();
+        return std::chrono::duration<double>(end - start).count();
+    };
+
+    for (size_t bytes : {192, 512, 2048}) {
+        double viaMalloc = run(mstl::malloc_alloc::allocate, mstl::malloc_alloc::deallocate, bytes);
+        double viaPool = run(mstl::default_alloc::allocate, mstl::default_alloc::deallocate, bytes);
+        std::cout << std::setw(10) << bytes << std::setw(16) << std::fixed << std::setprecision(6)
+                  << viaMalloc << std::setw(16) << viaPool << std::endl;
+    }
+}
+
+// 突发分配后全部释放，trim 应把完全空闲的 chunk 还给操作系统，之后仍可继续分配
+void testTrim() {
+    std::cout << "\n=== trim 测试 ===" << std::endl;
+    using Pool = mstl::DefaultAllocTemplate<false, 3>;
+
+    std::vector<void*> ptrs;
+    for (int i = 0; i < 200000; ++i)
+        ptrs.push_back(Pool::allocate(32));
+    for (void* p : ptrs)
+        Pool::deallocate(p, 32);
+    ptrs.clear();
+
+    size_t limited = Pool::releaseUnused(1);
+    size_t released = Pool::trim();
+    std::cout << "归还 " << released << " 字节" << std::endl;
+    assert(limited == 0);
+    assert(released >= 200000 * 32 / 2);
+    assert(Pool::trim() == 0);
+
+    for (int i = 0; i < 1000; ++i)
+        ptrs.push_back(Pool::allocate(32));
+    for (void* p : ptrs)
+        Pool::deallocate(p, 32);
+    std::cout << "trim 测试通过" << std::endl;
+}
+
+// 大页模式：chunk 从 2 MiB 对齐的区域中切割，trim 之后仍可继续分配
+void testHugePageArena() {
+    std::cout << "\n=== 大页模式测试 ===" << std::endl;
+    using Pool = mstl::DefaultAllocTemplate<false, 6>;
+
+    assert(!Pool::setHugePageArena(true));
+    void* first = Pool::allocate(64);
+    size_t offset = reinterpret_cast<uintptr_t>(first) % mstl::detail::kHugePageSize;
+    std::cout << "第一个区块相对 2 MiB 边界的偏移: " << offset << std::endl;
+    assert(offset < 4096);
+
+    std::vector<void*> ptrs;
+    for (int i = 0; i < 100000; ++i)
+        ptrs.push_back(Pool::allocate(64));
+    for (void* p : ptrs)
+        Pool::deallocate(p, 64);
+    Pool::deallocate(first, 64);
+    assert(Pool::trim() > 0);
+
+    ptrs.clear();
+    for (int i = 0; i < 1000; ++i)
+        ptrs.push_back(Pool::allocate(64));
+    for (void* p : ptrs)
+        Pool::deallocate(p, 64);
+    assert(Pool::setHugePageArena(false));
+    std::cout << "大页模式测试通过" << std::endl;
+}
+
+// 在节点由 Pool 分配、有 numNodes 个键的红黑树上做 numLookups 次随机查找，返回查找耗时（秒）
+// 按随机键序插入，树上相邻的节点在内存中相距很远
+template <typename Pool>
+double runTreeLookup(int numNodes, int numLookups) {
+    std::vector<int> keys(numNodes);
+    std::iota(keys.begin(), keys.end(), 0);
+    std::shuffle(keys.begin(), keys.end(), std::mt19937(42));
+
+    double seconds;
+    {
+        mstl::RbTree<int, int, mstl::Identity<int>, mstl::Less<int>, Pool> tree;
+        for (int key : keys)
+            tree.insert_unique(key);
+
+        std::mt19937 rng(7);
+        int found = 0;
+        auto start = std::chrono::high_resolution_clock::now();
+        for (int i = 0; i < numLookups; ++i)
+            found += tree.find(static_cast<int>(rng() % numNodes)) != tree.end();
+        auto end = std::chrono::high_resolution_clock::now();
+        assert(found == numLookups);
+        seconds = std::chrono::duration<double>(end - start).count();
+    }
+    Pool::trim();
+    return seconds;
+}
+
+void benchmarkHugePageTreeLookup() {
+    const int numNodes = 1 << 20;
+    const int numLookups = 1 << 20;
+    std::cout << "\n=== 大页模式红黑树节点查找测试 (" << numNodes << " 个节点, " << numLookups
+              << " 次查找) ===" << std::endl;
+
+    using SmallPagePool = mstl::DefaultAllocTemplate<false, 7>;
+    using HugePagePool = mstl::DefaultAllocTemplate<false, 8>;
+    HugePagePool::setHugePageArena(true);
+
+    double smallPages = runTreeLookup<SmallPagePool>(numNodes, numLookups);
+    double hugePages = runTreeLookup<HugePagePool>(numNodes, numLookups);
+    std::cout << std::setw(16) << "普通页(秒)" << std::setw(16) << "大页(秒)" << std::endl;
+    std::cout << std::setw(16) << std::fixed << std::setprecision(6) << smallPages << std::setw(16)
+              << hugePages << std::endl;
+}
+
+// 对照组：旧版 thread_safe_alloc 的行为，每次分配/释放都持有同一把全局锁
+struct GlobalLockAlloc {
+    using Pool = mstl::DefaultAllocTemplate<false, 1>;
+    static std::mutex mutex;
+
+    static void* allocate(size_t n) {
+        std::lock_guard<std::mutex> lock(mutex);
+        return Pool::allocate(n);
+    }
+
+    static void deallocate(void* p, size_t n) {
+        std::lock_guard<std::mutex> lock(mutex);
+        Pool::deallocate(p, n);
+    }
+};
+std::mutex GlobalLockAlloc::mutex;
+
+// 模拟节点型容器的负载：每个线程反复分配/释放一批小对象，返回耗时（秒）
+template <typename Alloc>
+double runScalingWorkload(int numThreads, int roundsPerThread) {
+    const int batch = 64;
+    auto start = std::chrono::high_resolution_clock::now();
+    std::vector<std::thread> threads;
+    for (int t = 0; t < numThreads; ++t) {
+        threads.emplace_back([roundsPerThread]() {
+            void* ptrs[batch];
+            for (int r = 0; r < roundsPerThread; ++r) {
+                for (int i = 0; i < batch; ++i)
+                    ptrs[i] = Alloc::allocate(16 + (i % 4) * 16);
+                for (int i = 0; i < batch; ++i)
+                    Alloc::deallocate(ptrs[i], 16 + (i % 4) * 16);
+            }
+        });
+    }
+    for (auto& th : threads) {
+        th.join();
+    }
+    auto end = std::chrono::high_resolution_clock::now();
+    return std::chrono::duration<double>(end - start).count();
+}
+
+void benchmarkThreadScaling() {
+    std::cout << "\n=== 多线程扩展性测试 (每线程 64 个对象 x 200 轮) ===" << std::endl;
+    std::cout << std::setw(8) << "线程数" << std::setw(16) << "全局锁(秒)" << std::setw(16)
+              << "线程缓存(秒)" << std::endl;
+
+    const int rounds = 200;
+    for (int numThreads = 1; numThreads <= 64; numThreads *= 2) {
+        double locked = runScalingWorkload<GlobalLockAlloc>(numThreads, rounds);
+        double cached = runScalingWorkload<mstl::thread_safe_alloc>(numThreads, rounds);
+        std::cout << std::setw(8) << numThreads << std::setw(16) << std::fixed
+                  << std::setprecision(6) << locked << std::setw(16) << cached << std::endl;
+    }
+}
+
 int main() {
     testBasicAllocation();
     testSequentialAllocation();
     testAllocatorClass();
+    testThreadSafeAllocation();
+    testAdaptiveRefill();
+    testSizeClasses();
+    testTrim();
+    testHugePageArena();
+    benchmarkThreadScaling();
+    benchmarkMidSizeAllocation();
+    benchmarkHugePageTreeLookup();
 
     std::cout << "\n所有测试完成" << std::endl;
     return 0;
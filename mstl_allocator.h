@@ -2,8 +2,11 @@
 #define __MSGI_STL_INTERNAL_ALLOCATOR_H
 
 #include <cstddef>
+#include <cstdint>
+#include <cstdlib>
 #include <new>
 #include <type_traits>
+#include <utility>
 #include "mstl_alloc.h"
 #include "mstl_construct.h"
 
@@ -24,9 +27,13 @@ struct AllocatorTraits {
         typename std::pointer_traits<ConstPointer>::template rebind<const void>>;
     using DifferenceType = typename Alloc::DifferenceType;
     using SizeType = typename Alloc::SizeType;
-    using PropagateOnContainerCopyAssignment = std::false_type;
-    using PropagateOnContainerMoveAssignment = std::false_type;
-    using PropagateOnContainerSwap = std::false_type;
+    // Alloc 自己声明了就使用它的，否则不传播；没有状态的分配器总是相等
+    using PropagateOnContainerCopyAssignment =
+        std::bool_constant<detail::PropagateOnCopyAssignment<Alloc>::value>;
+    using PropagateOnContainerMoveAssignment =
+        std::bool_constant<detail::PropagateOnMoveAssignment<Alloc>::value>;
+    using PropagateOnContainerSwap = std::bool_constant<detail::PropagateOnSwap<Alloc>::value>;
+    using IsAlwaysEqual = std::bool_constant<detail::IsAlwaysEqual<Alloc>::value>;
 
     template <typename T>
     using RebindAlloc = typename Alloc::template RebindAlloc<T>::Other;
@@ -62,6 +69,28 @@ struct AllocatorTraits {
     }
 };
 
+// 容器的拷贝赋值、移动赋值与 swap 按 AllocatorTraits 的 PropagateOnContainer* 决定是否带上分配器
+// 不传播时容器保留自己的分配器
+template <typename Alloc>
+void propagateOnCopyAssignment(Alloc& to, const Alloc& from) {
+    if constexpr (AllocatorTraits<Alloc>::PropagateOnContainerCopyAssignment::value)
+        to = from;
+}
+
+template <typename Alloc>
+void propagateOnMoveAssignment(Alloc& to, Alloc& from) {
+    if constexpr (AllocatorTraits<Alloc>::PropagateOnContainerMoveAssignment::value)
+        to = std::move(from);
+}
+
+template <typename Alloc>
+void propagateOnSwap(Alloc& a, Alloc& b) {
+    if constexpr (AllocatorTraits<Alloc>::PropagateOnContainerSwap::value) {
+        using std::swap;
+        swap(a, b);
+    }
+}
+
 // 标准分配器接口
 template <typename Tp, typename Alloc = alloc>  // 默认使用单线程版本
 class Allocator {
@@ -129,6 +158,7 @@ struct AllocatorTraits<Allocator<T>> {
     using PropagateOnContainerCopyAssignment = std::false_type;
     using PropagateOnContainerMoveAssignment = std::false_type;
     using PropagateOnContainerSwap = std::false_type;
+    using IsAlwaysEqual = std::true_type;
 
     template <typename U>
     using RebindAlloc = Allocator<U>;
@@ -239,6 +269,9 @@ class MemoryPool
     Buffer *firstBuffer = nullptr;
     HotZone hotZone;
     std::size_t bufferedBlocks = growSize;
+    std::size_t bufferCount = 0;
+    // 分配/释放计数，只在定义了 MSTL_ALLOC_STATS 时记录
+    [[no_unique_address]] AllocCounters<1> stats;
 
     public:
 
@@ -262,13 +295,16 @@ class MemoryPool
             if (bufferedBlocks >= growSize) {
                 firstBuffer = new Buffer(firstBuffer);
                 bufferedBlocks = 0;
+                ++bufferCount;
             }
 
+            stats.recordAlloc(0, sizeof(T));
             return firstBuffer->getBlock(bufferedBlocks++);
         }
 
         T *allocate()
         {
+            stats.recordAlloc(0, sizeof(T));
             if (hotZone.used < hotZone.capacity) {
                 return hotZone.start + hotZone.used++;
             }
@@ -282,6 +318,7 @@ class MemoryPool
             if (bufferedBlocks >= growSize) {
                 firstBuffer = new Buffer(firstBuffer);
                 bufferedBlocks = 0;
+                ++bufferCount;
             }
 
             return firstBuffer->getBlock(bufferedBlocks++);
@@ -289,6 +326,7 @@ class MemoryPool
 
         void deallocate(T *pointer)
         {
+            stats.recordFree(0, sizeof(T));
             if (pointer >= hotZone.start && 
                 pointer < hotZone.start + hotZone.capacity) {
                 if (pointer == hotZone.start + hotZone.used - 1) {
@@ -301,13 +339,26 @@ class MemoryPool
             block->next = firstFreeBlock;
             firstFreeBlock = block;
         }
+
+        // 统计快照：hot zone 与 buffer 计入内存池，chunk 数为 buffer 个数
+        AllocStatsSnapshot statsSnapshot() const
+        {
+            AllocStatsSnapshot s;
+            s.name = "MemoryPool";
+            stats.fill(s, [](std::size_t) { return sizeof(T); });
+            s.poolBytes = hotZoneSize + bufferCount * sizeof(Buffer);
+            s.chunks = bufferCount;
+            s.updateFragmentation();
+            return s;
+        }
 };
 
+// 基于 MemoryPool 的单对象分配器
 template <class T, std::size_t growSize = 1024>
-class Allocator : private MemoryPool<T, growSize>
+class PoolAllocator : private MemoryPool<T, growSize>
 {
 #if defined(_WIN32) && defined(ENABLE_OLD_WIN32_SUPPORT)
-    Allocator *copyAllocator = nullptr;
+    PoolAllocator *copyAllocator = nullptr;
     std::allocator<T> *rebindAllocator = nullptr;
 #endif
 
@@ -324,25 +375,25 @@ class Allocator : private MemoryPool<T, growSize>
         template <class U>
         struct rebind
         {
-            typedef Allocator<U, growSize> other;
+            typedef PoolAllocator<U, growSize> other;
         };
 
 #if defined(_WIN32) && defined(ENABLE_OLD_WIN32_SUPPORT)
-        Allocator() = default;
+        PoolAllocator() = default;
 
-        Allocator(Allocator &allocator) :
+        PoolAllocator(PoolAllocator &allocator) :
             copyAllocator(&allocator)
         {
         }
 
         template <class U>
-        Allocator(const Allocator<U, growSize> &other)
+        PoolAllocator(const PoolAllocator<U, growSize> &other)
         {
             if (!std::is_same<T, U>::value)
                 rebindAllocator = new std::allocator<T>();
         }
 
-        ~Allocator()
+        ~PoolAllocator()
         {
             delete rebindAllocator;
         }
@@ -364,7 +415,9 @@ class Allocator : private MemoryPool<T, growSize>
             return MemoryPool<T, growSize>::allocate();
         }
 
-        void deallocate(pointer p, size_type n)
+        using MemoryPool<T, growSize>::statsSnapshot;
+
+        void deallocate(pointer p, [[maybe_unused]] size_type n)
         {
 #if defined(_WIN32) && defined(ENABLE_OLD_WIN32_SUPPORT)
             if (copyAllocator) {
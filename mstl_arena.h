@@ -0,0 +1,247 @@
+#ifndef __MSGI_STL_INTERNAL_ARENA_H
+#define __MSGI_STL_INTERNAL_ARENA_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include "mstl_alloc.h"
+#include "mstl_concepts.h"
+
+namespace mstl {
+
+// Arena 默认的第一个内存块大小，之后每个新块翻倍，直到 kArenaMaxBlockSize
+constexpr size_t kArenaBlockSize = 64 * 1024;
+constexpr size_t kArenaMaxBlockSize = 4 * 1024 * 1024;
+
+// 单调 (bump pointer) 内存区：分配只是移动指针，释放什么都不做，
+// reset() 把指针拨回第一个内存块，O(1)，内存块保留给下一轮使用；析构或 release() 时才真正归还
+// 适合"每个请求建一批临时容器，请求结束整体丢弃"的场景；不是线程安全的
+class Arena {
+public:
+    explicit Arena(size_t initialBlockSize = kArenaBlockSize) : nextBlockSize(initialBlockSize) {}
+
+    Arena(const Arena&) = delete;
+    Arena& operator=(const Arena&) = delete;
+
+    ~Arena() {
+        release();
+    }
+
+    // 分配 n 字节，起始地址按 alignment (2 的幂) 对齐
+    void* allocate(size_t n, size_t alignment = alignof(std::max_align_t)) {
+        char* p = alignUp(ptr, alignment);
+        if (n > static_cast<size_t>(end - p))
+            return allocateSlow(n, alignment);
+        ptr = p + n;
+        used += n;
+        return p;
+    }
+
+    // 单个区块不单独释放，等 reset 时整体回收
+    void deallocate(void*, size_t) noexcept {}
+
+    // p 是最近一次分配且当前块放得下时原地伸缩，否则重新分配并复制
+    void* reallocate(void* p, size_t oldSize, size_t newSize) {
+        char* q = static_cast<char*>(p);
+        if (q + oldSize == ptr && newSize <= static_cast<size_t>(end - q)) {
+            ptr = q + newSize;
+            used = used - oldSize + newSize;
+            return p;
+        }
+        void* result = allocate(newSize);
+        std::memcpy(result, p, oldSize < newSize ? oldSize : newSize);
+        return result;
+    }
+
+    // 丢弃所有分配，保留内存块，O(1)
+    void reset() noexcept {
+        currentBlock = head;
+        ptr = head ? head->data() : nullptr;
+        end = head ? head->limit() : nullptr;
+        used = 0;
+    }
+
+    // 丢弃所有分配并把全部内存块归还系统
+    void release() noexcept {
+        while (head != nullptr) {
+            Block* next = head->next;
+            malloc_alloc::deallocate(head, head->size);
+            head = next;
+        }
+        currentBlock = nullptr;
+        ptr = end = nullptr;
+        used = reserved = 0;
+    }
+
+    // 自上次 reset 以来分配出去的字节数 (不含对齐填充)
+    size_t bytesUsed() const noexcept {
+        return used;
+    }
+
+    // 持有的内存块总字节数
+    size_t bytesReserved() const noexcept {
+        return reserved;
+    }
+
+    // 当前线程绑定的 Arena，由 ArenaScope 设置，供静态接口 ArenaAlloc 使用
+    static Arena*& current() noexcept {
+        thread_local Arena* arena = nullptr;
+        return arena;
+    }
+
+private:
+    struct alignas(std::max_align_t) Block {
+        Block* next;
+        size_t size;  // 整个块的字节数，包括 Block 本身
+
+        char* data() {
+            return reinterpret_cast<char*>(this + 1);
+        }
+        char* limit() {
+            return reinterpret_cast<char*>(this) + size;
+        }
+    };
+
+    static char* alignUp(char* p, size_t alignment) {
+        return reinterpret_cast<char*>((reinterpret_cast<uintptr_t>(p) + alignment - 1) &
+                                       ~(uintptr_t(alignment) - 1));
+    }
+
+    // 当前块放不下：先尝试 reset 之前留下的下一个块，不够大再申请新块，插在当前块之后
+    void* allocateSlow(size_t n, size_t alignment) {
+        size_t need = n + alignment;
+        Block* next = currentBlock ? currentBlock->next : head;
+        if (next == nullptr || static_cast<size_t>(next->limit() - next->data()) < need) {
+            size_t size = nextBlockSize;
+            while (size - sizeof(Block) < need)
+                size *= 2;
+            if (nextBlockSize < kArenaMaxBlockSize)
+                nextBlockSize *= 2;
+
+            Block* block = static_cast<Block*>(malloc_alloc::allocate(size));
+            block->size = size;
+            block->next = next;
+            if (currentBlock)
+                currentBlock->next = block;
+            else
+                head = block;
+            reserved += size;
+            next = block;
+        }
+
+        currentBlock = next;
+        ptr = next->data();
+        end = next->limit();
+        return allocate(n, alignment);
+    }
+
+    Block* head = nullptr;          // 第一个内存块，reset 后从这里重新开始
+    Block* currentBlock = nullptr;  // 正在切割的内存块
+    char* ptr = nullptr;            // 当前块中下一个可用字节
+    char* end = nullptr;            // 当前块的末尾
+    size_t used = 0;
+    size_t reserved = 0;
+    size_t nextBlockSize;
+};
+
+// 把 Arena 绑定到当前线程，作用域结束时恢复之前的绑定；可以嵌套
+class ArenaScope {
+public:
+    explicit ArenaScope(Arena& arena) : previous(std::exchange(Arena::current(), &arena)) {}
+
+    ArenaScope(const ArenaScope&) = delete;
+    ArenaScope& operator=(const ArenaScope&) = delete;
+
+    ~ArenaScope() {
+        Arena::current() = previous;
+    }
+
+private:
+    Arena* previous;
+};
+
+// 与 DefaultAllocTemplate 相同的静态接口，从当前线程绑定的 Arena 分配，
+// 可以作为 Vector/List/Deque/Slist 的 Alloc 参数，也可以作为 SimpleAlloc<T, Alloc> 或
+// Allocator<T, Alloc> 的 Alloc 参数。deallocate 什么都不做
+// 区块按 max_align_t 对齐；当前线程没有绑定 Arena 时 allocate 抛出 std::bad_alloc
+class ArenaAlloc {
+public:
+    using Pointer = void*;
+    using ConstPointer = const void*;
+    using SizeType = size_t;
+    using DifferenceType = ptrdiff_t;
+
+    template <typename T>
+    struct rebind {
+        using other = ArenaAlloc;
+    };
+
+    static void* allocate(size_t n) {
+        Arena* arena = Arena::current();
+        if (arena == nullptr)
+            throw std::bad_alloc();
+        return arena->allocate(n);
+    }
+
+    static void deallocate(void*, size_t) noexcept {}
+
+    static void* reallocate(void* p, size_t oldSize, size_t newSize) {
+        Arena* arena = Arena::current();
+        if (arena == nullptr)
+            throw std::bad_alloc();
+        return arena->reallocate(p, oldSize, newSize);
+    }
+};
+
+static_assert(SimpleAllocator<ArenaAlloc, int>, "ArenaAlloc must satisfy SimpleAllocator concept");
+
+// 有状态的 Arena 分配器：每个实例指向一个 Arena，不依赖线程绑定
+// 容器保存分配器实例，所以不同容器 (例如每个工作线程各自的容器) 可以使用各自的 Arena
+// 默认构造时使用当前线程绑定的 Arena；移动赋值与 swap 时随容器一起传播，拷贝赋值时不传播
+class ArenaRef {
+public:
+    using Pointer = void*;
+    using ConstPointer = const void*;
+    using SizeType = size_t;
+    using DifferenceType = ptrdiff_t;
+
+    using PropagateOnContainerCopyAssignment = std::false_type;
+    using PropagateOnContainerMoveAssignment = std::true_type;
+    using PropagateOnContainerSwap = std::true_type;
+    using IsAlwaysEqual = std::false_type;
+
+    ArenaRef() noexcept : arena(Arena::current()) {}
+    ArenaRef(Arena& a) noexcept : arena(&a) {}
+
+    void* allocate(size_t n) {
+        if (arena == nullptr)
+            throw std::bad_alloc();
+        return arena->allocate(n);
+    }
+
+    void deallocate(void*, size_t) noexcept {}
+
+    void* reallocate(void* p, size_t oldSize, size_t newSize) {
+        if (arena == nullptr)
+            throw std::bad_alloc();
+        return arena->reallocate(p, oldSize, newSize);
+    }
+
+    Arena* get() const noexcept {
+        return arena;
+    }
+
+    bool operator==(const ArenaRef& other) const noexcept {
+        return arena == other.arena;
+    }
+
+private:
+    Arena* arena;
+};
+
+}  // namespace mstl
+
+#endif  // __MSGI_STL_INTERNAL_ARENA_H
@@ -0,0 +1,287 @@
+#include "mstl_arena.h"
+#include <cassert>
+#include <chrono>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <thread>
+#include <type_traits>
+#include <vector>
+#include "mstl_allocator.h"
+#include "mstl_deque.h"
+#include "mstl_list.h"
+#include "mstl_map.h"
+#include "mstl_set.h"
+#include "mstl_slist.h"
+#include "mstl_vector.h"
+
+// Arena 本身：对齐、原地 realloc、reset 复用内存块
+void testArenaBasics() {
+    std::cout << "=== Arena 基本测试 ===" << std::endl;
+    mstl::Arena arena(1024);
+
+    void* a = arena.allocate(10);
+    void* b = arena.allocate(8, 64);
+    assert(reinterpret_cast<uintptr_t>(a) % alignof(std::max_align_t) == 0);
+    assert(reinterpret_cast<uintptr_t>(b) % 64 == 0);
+    assert(arena.bytesUsed() == 18);
+
+    // 最近一次分配原地扩展
+    void* c = arena.allocate(16);
+    assert(arena.reallocate(c, 16, 64) == c);
+
+    // 超过块大小的分配单独占一个块
+    void* big = arena.allocate(10000);
+    std::memset(big, 0, 10000);
+    size_t reserved = arena.bytesReserved();
+    assert(reserved >= 10000);
+
+    // reset 之后复用原来的内存块，不再向系统申请
+    arena.reset();
+    assert(arena.bytesUsed() == 0);
+    assert(arena.allocate(10) == a);
+    for (int i = 0; i < 100; ++i)
+        arena.allocate(100);
+    assert(arena.bytesReserved() == reserved);
+
+    arena.release();
+    assert(arena.bytesReserved() == 0);
+    std::cout << "Arena 基本测试通过" << std::endl;
+}
+
+// 各容器通过 ArenaAlloc 从当前线程绑定的 Arena 分配
+void testContainersOnArena() {
+    std::cout << "\n=== 容器使用 Arena 测试 ===" << std::endl;
+    mstl::Arena arena;
+    mstl::ArenaScope scope(arena);
+
+    {
+        mstl::Vector<int, mstl::ArenaAlloc> vec;
+        mstl::List<int, mstl::ArenaAlloc> list;
+        mstl::Deque<int, mstl::ArenaAlloc> deque;
+        mstl::Slist<int, mstl::ArenaAlloc> slist;
+        for (int i = 0; i < 10000; ++i) {
+            vec.push_back(i);
+            list.push_back(i);
+            deque.push_back(i);
+            slist.push_front(i);
+        }
+        assert(vec.size() == 10000 && vec[9999] == 9999);
+        assert(list.size() == 10000 && list.back() == 9999);
+        assert(deque.size() == 10000 && deque.back() == 9999);
+        assert(slist.front() == 9999);
+
+        // Allocator 接口同样可以使用 ArenaAlloc
+        mstl::Allocator<double, mstl::ArenaAlloc> alloc;
+        double* p = alloc.allocate(100);
+        p[99] = 1.0;
+        alloc.deallocate(p, 100);
+    }
+    std::cout << "请求结束时 Arena 已分配 " << arena.bytesUsed() << " 字节，持有 "
+              << arena.bytesReserved() << " 字节" << std::endl;
+    size_t reserved = arena.bytesReserved();
+
+    // 第二个请求：reset 之后重复同样的工作，不再申请新内存
+    arena.reset();
+    {
+        mstl::List<int, mstl::ArenaAlloc> list;
+        for (int i = 0; i < 10000; ++i)
+            list.push_back(i);
+    }
+    assert(arena.bytesReserved() == reserved);
+
+    // 嵌套作用域使用内层 Arena，退出后恢复外层
+    {
+        mstl::Arena inner;
+        mstl::ArenaScope innerScope(inner);
+        mstl::ArenaAlloc::allocate(32);
+        assert(inner.bytesUsed() == 32);
+    }
+    assert(mstl::Arena::current() == &arena);
+    std::cout << "容器使用 Arena 测试通过" << std::endl;
+}
+
+void testNoArenaBound() {
+    std::cout << "\n=== 未绑定 Arena 测试 ===" << std::endl;
+    bool thrown = false;
+    try {
+        mstl::ArenaAlloc::allocate(16);
+    } catch (const std::bad_alloc&) {
+        thrown = true;
+    }
+    assert(thrown);
+    std::cout << "未绑定 Arena 测试通过" << std::endl;
+}
+
+// 拷贝、移动赋值与 swap 时不传播的 ArenaRef
+struct PinnedArenaRef : mstl::ArenaRef {
+    using PropagateOnContainerMoveAssignment = std::false_type;
+    using PropagateOnContainerSwap = std::false_type;
+    using mstl::ArenaRef::ArenaRef;
+};
+
+// 容器保存分配器实例：每个容器使用自己的 Arena，分配器按 PropagateOnContainer* 传播
+void testStatefulAllocators() {
+    std::cout << "\n=== 有状态分配器测试 ===" << std::endl;
+
+    // 静态分配器不占空间
+    static_assert(sizeof(mstl::Vector<int>) == 3 * sizeof(int*));
+    static_assert(sizeof(mstl::List<int>) == sizeof(void*));
+    static_assert(sizeof(mstl::List<int, mstl::ArenaRef>) == 2 * sizeof(void*));
+
+    mstl::Arena a1, a2;
+    {
+        mstl::Vector<int, mstl::ArenaRef> v1{mstl::ArenaRef(a1)}, v2{mstl::ArenaRef(a2)};
+        for (int i = 0; i < 100; ++i) {
+            v1.push_back(i);
+            v2.push_back(-i);
+        }
+        assert(a1.bytesUsed() > 0 && a2.bytesUsed() > 0);
+        assert(v1.get_allocator().get() == &a1);
+
+        // ArenaRef 在 swap 时随内容一起交换
+        v1.swap(v2);
+        assert(v1[99] == -99 && v1.get_allocator().get() == &a2);
+        assert(v2[99] == 99 && v2.get_allocator().get() == &a1);
+    }
+    {
+        mstl::List<int, mstl::ArenaRef> l1{mstl::ArenaRef(a1)}, l2{mstl::ArenaRef(a2)};
+        l2.push_back(1);
+        l2.push_back(2);
+
+        // 拷贝构造使用对方的分配器，拷贝赋值保留自己的
+        mstl::List<int, mstl::ArenaRef> l3(l2);
+        assert(l3.get_allocator().get() == &a2);
+        size_t used = a1.bytesUsed();
+        l1 = l2;
+        assert(l1.size() == 2 && l1.get_allocator().get() == &a1);
+        assert(a1.bytesUsed() > used);
+
+        // 移动赋值接管对方的节点和分配器，被移动的 list 仍然可用
+        l1 = std::move(l2);
+        assert(l1.size() == 2 && l1.get_allocator().get() == &a2);
+        assert(l2.empty());
+        l2.push_back(3);
+        assert(l2.front() == 3);
+
+        mstl::List<int, mstl::ArenaRef> l4(std::move(l3));
+        assert(l4.size() == 2 && l3.empty());
+    }
+    {
+        mstl::Deque<int, mstl::ArenaRef> d1{mstl::ArenaRef(a1)}, d2{mstl::ArenaRef(a2)};
+        for (int i = 0; i < 1000; ++i)
+            d2.push_back(i);
+        d1 = std::move(d2);
+        assert(d1.size() == 1000 && d1.get_allocator().get() == &a2);
+
+        mstl::Slist<int, mstl::ArenaRef> s1{mstl::ArenaRef(a1)}, s2{mstl::ArenaRef(a2)};
+        s1.push_front(1);
+        s1.swap(s2);
+        assert(s2.front() == 1 && s2.get_allocator().get() == &a1);
+    }
+    {
+        // 分配器不相等且不随移动传播：元素逐个移动到自己的 Arena
+        mstl::List<int, PinnedArenaRef> l1{PinnedArenaRef(a1)}, l2{PinnedArenaRef(a2)};
+        mstl::Deque<int, PinnedArenaRef> d1{PinnedArenaRef(a1)}, d2{PinnedArenaRef(a2)};
+        for (int i = 0; i < 1000; ++i) {
+            l2.push_back(i);
+            d2.push_back(i);
+        }
+        size_t used = a1.bytesUsed();
+        l1 = std::move(l2);
+        d1 = std::move(d2);
+        assert(l1.size() == 1000 && l1.back() == 999 && l1.get_allocator().get() == &a1);
+        assert(d1.size() == 1000 && d1.back() == 999 && d1.get_allocator().get() == &a1);
+        assert(a1.bytesUsed() > used);
+    }
+    {
+        // 有序输入线性建树时同样可以指定分配器
+        std::vector<int> keys{1, 2, 2, 3, 5, 5, 8};
+        std::vector<mstl::Pair<int, int>> pairs{{1, 10}, {2, 20}, {3, 30}};
+        size_t used = a2.bytesUsed();
+        mstl::Map<int, int, mstl::Less<int>, mstl::ArenaRef> m(mstl::kSortedUnique, pairs.begin(), pairs.end(),
+                                                              mstl::Less<int>(), mstl::ArenaRef(a2));
+        mstl::Multimap<int, int, mstl::Less<int>, mstl::ArenaRef> mm(
+            mstl::kSortedEquivalent, pairs.begin(), pairs.end(), mstl::Less<int>(), mstl::ArenaRef(a2));
+        mstl::Multiset<int, mstl::Less<int>, mstl::ArenaRef> ms(mstl::kSortedEquivalent, keys.begin(), keys.end(),
+                                                               mstl::Less<int>(), mstl::ArenaRef(a2));
+        assert(m.size() == 3 && m.at(3) == 30 && m.get_allocator().get() == &a2);
+        assert(mm.size() == 3 && mm.get_allocator().get() == &a2);
+        assert(ms.size() == 7 && ms.count(5) == 2 && ms.get_allocator().get() == &a2);
+        assert(a2.bytesUsed() > used);
+    }
+
+    // 每个工作线程使用自己的 Arena，不需要 ArenaScope 这样的全局 (线程局部) 状态
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; ++t) {
+        threads.emplace_back([]() {
+            mstl::Arena arena;
+            mstl::List<int, mstl::ArenaRef> list{mstl::ArenaRef(arena)};
+            for (int i = 0; i < 1000; ++i)
+                list.push_back(i);
+            assert(list.size() == 1000 && arena.bytesUsed() >= 1000 * sizeof(int));
+        });
+    }
+    for (auto& th : threads)
+        th.join();
+    std::cout << "有状态分配器测试通过" << std::endl;
+}
+
+// 模拟一个请求：建一批临时容器然后整体丢弃
+template <typename Alloc>
+void simulateRequest(int n) {
+    mstl::Vector<int, Alloc> vec;
+    mstl::List<int, Alloc> list;
+    mstl::Deque<int, Alloc> deque;
+    for (int i = 0; i < n; ++i) {
+        vec.push_back(i);
+        list.push_back(i);
+        deque.push_back(i);
+    }
+}
+
+void benchmarkPerRequest() {
+    const int requests = 200;
+    const int n = 5000;
+    std::cout << "\n=== 每请求临时容器测试 (" << requests << " 个请求, 每个 " << n
+              << " 个元素) ===" << std::endl;
+
+    auto time = [](auto&& fn) {
+        auto start = std::chrono::high_resolution_clock::now();
+        fn();
+        auto end = std::chrono::high_resolution_clock::now();
+        return std::chrono::duration<double>(end - start).count();
+    };
+
+    double viaMalloc = time([&]() {
+        for (int r = 0; r < requests; ++r)
+            simulateRequest<mstl::malloc_alloc>(n);
+    });
+    double viaPool = time([&]() {
+        for (int r = 0; r < requests; ++r)
+            simulateRequest<mstl::default_alloc>(n);
+    });
+    mstl::Arena arena;
+    double viaArena = time([&]() {
+        for (int r = 0; r < requests; ++r) {
+            mstl::ArenaScope scope(arena);
+            simulateRequest<mstl::ArenaAlloc>(n);
+            arena.reset();
+        }
+    });
+
+    std::cout << std::setw(16) << "malloc(秒)" << std::setw(16) << "内存池(秒)" << std::setw(16)
+              << "Arena(秒)" << std::endl;
+    std::cout << std::setw(16) << std::fixed << std::setprecision(6) << viaMalloc << std::setw(16)
+              << viaPool << std::setw(16) << viaArena << std::endl;
+}
+
+int main() {
+    testArenaBasics();
+    testContainersOnArena();
+    testNoArenaBound();
+    testStatefulAllocators();
+    benchmarkPerRequest();
+    std::cout << "\n所有 Arena 测试完成" << std::endl;
+    return 0;
+}
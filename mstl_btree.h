@@ -0,0 +1,832 @@
+#ifndef __MSGI_STL_INTERNAL_BTREE_H
+#define __MSGI_STL_INTERNAL_BTREE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include "mstl_alloc.h"
+#include "mstl_allocator.h"
+#include "mstl_construct.h"
+#include "mstl_iterator.h"
+#include "mstl_iterator_tags.h"
+#include "mstl_pair.h"
+
+namespace mstl {
+
+// 默认的节点大小：4 条 64 字节的 cache line
+constexpr size_t kBTreeNodeSize = 256;
+
+// 每个节点最多保存的值的个数：值区按 NodeSize 字节计算，至少 3 个
+template <typename Value, size_t NodeSize>
+constexpr size_t btree_node_slots() {
+    constexpr size_t header = 2 * sizeof(void*);
+    constexpr size_t slots = NodeSize > header ? (NodeSize - header) / sizeof(Value) : 0;
+    return slots < 3 ? 3 : (slots > 255 ? 255 : slots);
+}
+
+template <typename Value, size_t Slots>
+struct BTreeInternalNode;
+
+// 叶子节点：值连续存放在节点内，查找一个节点只需要读几条相邻的 cache line
+template <typename Value, size_t Slots>
+struct BTreeNode {
+    using ValueType = Value;
+    using InternalType = BTreeInternalNode<Value, Slots>;
+
+    BTreeNode* parent;   // 根节点为 nullptr
+    uint8_t position;    // 在父节点 children 中的下标
+    uint8_t count;       // 值的个数
+    bool leaf;
+    alignas(Value) unsigned char storage[Slots * sizeof(Value)];
+
+    Value* slot(size_t i) { return reinterpret_cast<Value*>(storage) + i; }
+    const Value* slot(size_t i) const { return reinterpret_cast<const Value*>(storage) + i; }
+    Value& value(size_t i) { return *slot(i); }
+    const Value& value(size_t i) const { return *slot(i); }
+};
+
+// 内部节点：在叶子节点之后多出 Slots + 1 个孩子指针
+template <typename Value, size_t Slots>
+struct BTreeInternalNode : public BTreeNode<Value, Slots> {
+    BTreeNode<Value, Slots>* children[Slots + 1];
+};
+
+// 迭代器由 (节点, 下标) 组成；end() 是最右叶子的 (节点, count)
+template <typename Node, typename Ref, typename Ptr>
+struct BTreeIterator {
+    using IteratorCategory = BidirectionalIteratorTag;
+    using ValueType = typename Node::ValueType;
+    using Reference = Ref;
+    using Pointer = Ptr;
+    using DifferenceType = ptrdiff_t;
+    using Iterator = BTreeIterator<Node, ValueType&, ValueType*>;
+    using ConstIterator = BTreeIterator<Node, const ValueType&, const ValueType*>;
+    using Self = BTreeIterator<Node, Ref, Ptr>;
+
+    Node* node;
+    int position;
+
+    BTreeIterator() : node(nullptr), position(0) {}
+    BTreeIterator(Node* n, int pos) : node(n), position(pos) {}
+    BTreeIterator(const Iterator& it) : node(it.node), position(it.position) {}
+    Self& operator=(const Self&) = default;
+
+    Reference operator*() const { return node->value(position); }
+    Pointer operator->() const { return &(operator*()); }
+
+    static Node* child(Node* x, size_t i) {
+        return static_cast<typename Node::InternalType*>(x)->children[i];
+    }
+
+    void increment() {
+        if (node->leaf) {
+            if (++position < node->count)
+                return;
+            // 走到叶子末尾：向上找第一个还有后继值的祖先；已经是最后一个值时停在 end()
+            Self save = *this;
+            while (position == node->count && node->parent != nullptr) {
+                position = node->position;
+                node = node->parent;
+            }
+            if (position == node->count)
+                *this = save;
+        } else {
+            node = child(node, position + 1);
+            while (!node->leaf)
+                node = child(node, 0);
+            position = 0;
+        }
+    }
+
+    void decrement() {
+        if (node->leaf) {
+            if (--position >= 0)
+                return;
+            while (position < 0 && node->parent != nullptr) {
+                position = node->position - 1;
+                node = node->parent;
+            }
+        } else {
+            node = child(node, position);
+            while (!node->leaf)
+                node = child(node, node->count);
+            position = node->count - 1;
+        }
+    }
+
+    Self& operator++() {
+        increment();
+        return *this;
+    }
+
+    Self operator++(int) {
+        Self tmp = *this;
+        increment();
+        return tmp;
+    }
+
+    Self& operator--() {
+        decrement();
+        return *this;
+    }
+
+    Self operator--(int) {
+        Self tmp = *this;
+        decrement();
+        return tmp;
+    }
+
+    bool operator==(const Self& x) const { return node == x.node && position == x.position; }
+    bool operator!=(const Self& x) const { return !(*this == x); }
+};
+
+// B 树：与 RbTree 相同的 insert_unique/insert_equal/find/lower_bound/upper_bound/equal_range 接口
+// 每个节点保存 kNodeSlots 个值 (int 键约 60 个)，千万级的树只有 4~5 层，
+// 查找时每层读一个连续的节点，而不是 RbTree 那样每层一次指针跳转和一次 cache miss
+// 插入/删除会在节点内移动值，迭代器在任何插入/删除之后失效
+template <typename Key, typename Value, typename KeyOfValue, typename Compare,
+          typename Alloc = thread_safe_alloc, size_t NodeSize = kBTreeNodeSize>
+class BTree {
+public:
+    static constexpr size_t kNodeSlots = btree_node_slots<Value, NodeSize>();
+    // 非根节点至少保存的值的个数
+    static constexpr size_t kMinSlots = (kNodeSlots - 1) / 2;
+
+    using KeyType = Key;
+    using ValueType = Value;
+    using Pointer = ValueType*;
+    using ConstPointer = const ValueType*;
+    using Reference = ValueType&;
+    using ConstReference = const ValueType&;
+    using SizeType = size_t;
+    using DifferenceType = ptrdiff_t;
+    using AllocatorType = Alloc;
+
+protected:
+    using Node = BTreeNode<Value, kNodeSlots>;
+    using InternalNode = BTreeInternalNode<Value, kNodeSlots>;
+    using LeafAllocator = SimpleAlloc<Node, Alloc>;
+    using InternalAllocator = SimpleAlloc<InternalNode, Alloc>;
+
+public:
+    using Iterator = BTreeIterator<Node, Reference, Pointer>;
+    using ConstIterator = BTreeIterator<Node, ConstReference, ConstPointer>;
+    using ReverseIterator = mstl::ReverseIterator<Iterator>;
+    using ConstReverseIterator = mstl::ReverseIterator<ConstIterator>;
+
+protected:
+    [[no_unique_address]] LeafAllocator node_allocator;  // 内部节点使用同一个分配器，按需 rebind
+    Node* root;
+    Node* leftmost;
+    Node* rightmost;
+    SizeType node_count;
+    Compare key_compare;
+
+    static Node*& child(Node* x, size_t i) { return static_cast<InternalNode*>(x)->children[i]; }
+    static const Node* child(const Node* x, size_t i) {
+        return static_cast<const InternalNode*>(x)->children[i];
+    }
+    static decltype(auto) key(const Node* x, size_t i) { return KeyOfValue()(x->value(i)); }
+
+    // 把 src 处的值移动构造到 dst，并析构 src
+    static void transfer(Value* dst, Value* src) {
+        construct(dst, std::move(*src));
+        destroy(src);
+    }
+
+    Node* new_leaf() {
+        Node* x = node_allocator.allocate();
+        x->parent = nullptr;
+        x->position = 0;
+        x->count = 0;
+        x->leaf = true;
+        return x;
+    }
+
+    Node* new_internal() {
+        InternalNode* x = InternalAllocator(node_allocator).allocate();
+        x->parent = nullptr;
+        x->position = 0;
+        x->count = 0;
+        x->leaf = false;
+        return x;
+    }
+
+    void free_node(Node* x) {
+        if (x->leaf)
+            node_allocator.deallocate(x);
+        else
+            InternalAllocator(node_allocator).deallocate(static_cast<InternalNode*>(x));
+    }
+
+    void set_child(Node* x, size_t i, Node* c) {
+        child(x, i) = c;
+        c->parent = x;
+        c->position = static_cast<uint8_t>(i);
+    }
+
+    // 销毁以 x 为根的子树
+    void destroy_subtree(Node* x) {
+        if (!x->leaf) {
+            for (size_t i = 0; i <= x->count; ++i)
+                destroy_subtree(child(x, i));
+        }
+        for (size_t i = 0; i < x->count; ++i)
+            destroy(x->slot(i));
+        free_node(x);
+    }
+
+    // 复制以 x 为根的子树
+    Node* copy_subtree(const Node* x) {
+        Node* y = x->leaf ? new_leaf() : new_internal();
+        size_t values = 0, children = 0;
+        try {
+            for (; values < x->count; ++values)
+                construct(y->slot(values), x->value(values));
+            if (!x->leaf) {
+                for (; children <= x->count; ++children)
+                    set_child(y, children, copy_subtree(child(x, children)));
+            }
+        } catch (...) {
+            for (size_t i = 0; i < children; ++i)
+                destroy_subtree(child(y, i));
+            for (size_t i = 0; i < values; ++i)
+                destroy(y->slot(i));
+            free_node(y);
+            throw;
+        }
+        y->count = x->count;
+        return y;
+    }
+
+    void update_extremes() {
+        if (root == nullptr) {
+            leftmost = rightmost = nullptr;
+            return;
+        }
+        leftmost = root;
+        while (!leftmost->leaf)
+            leftmost = child(leftmost, 0);
+        rightmost = root;
+        while (!rightmost->leaf)
+            rightmost = child(rightmost, rightmost->count);
+    }
+
+    // 节点内第一个不小于 k 的下标
+    size_t lower_bound_in(const Node* x, const Key& k) const {
+        size_t lo = 0, hi = x->count;
+        while (lo < hi) {
+            size_t mid = (lo + hi) / 2;
+            if (key_compare(key(x, mid), k))
+                lo = mid + 1;
+            else
+                hi = mid;
+        }
+        return lo;
+    }
+
+    // 节点内第一个大于 k 的下标
+    size_t upper_bound_in(const Node* x, const Key& k) const {
+        size_t lo = 0, hi = x->count;
+        while (lo < hi) {
+            size_t mid = (lo + hi) / 2;
+            if (key_compare(k, key(x, mid)))
+                hi = mid;
+            else
+                lo = mid + 1;
+        }
+        return lo;
+    }
+
+    // 叶子上的 (x, i) 可能在节点末尾，向上找到真正指向的值，没有时返回 end()
+    Iterator normalize(Node* x, size_t i) const {
+        while (i == x->count && x->parent != nullptr) {
+            i = x->position;
+            x = x->parent;
+        }
+        if (i == x->count)
+            return Iterator(rightmost, rightmost->count);
+        return Iterator(x, static_cast<int>(i));
+    }
+
+    // 在未满的节点 x 的位置 i 插入一个值；先构造好新值，构造抛出异常时节点不变
+    template <typename V>
+    void insert_value(Node* x, size_t i, V&& v) {
+        if (i == x->count) {
+            construct(x->slot(i), std::forward<V>(v));
+        } else {
+            Value tmp(std::forward<V>(v));
+            for (size_t j = x->count; j > i; --j)
+                transfer(x->slot(j), x->slot(j - 1));
+            construct(x->slot(i), std::move(tmp));
+        }
+        ++x->count;
+    }
+
+    // 内部节点 x 的第 i 个孩子已满：把它从中间分成两个，中间值上移到 x 的位置 i
+    void split_child(Node* x, size_t i) {
+        Node* left = child(x, i);
+        Node* right = left->leaf ? new_leaf() : new_internal();
+        const size_t mid = kNodeSlots / 2;
+
+        for (size_t j = mid + 1; j < left->count; ++j)
+            transfer(right->slot(j - mid - 1), left->slot(j));
+        right->count = static_cast<uint8_t>(left->count - mid - 1);
+        if (!left->leaf) {
+            for (size_t j = mid + 1; j <= left->count; ++j)
+                set_child(right, j - mid - 1, child(left, j));
+        }
+
+        for (size_t j = x->count; j > i; --j)
+            transfer(x->slot(j), x->slot(j - 1));
+        transfer(x->slot(i), left->slot(mid));
+        for (size_t j = x->count + 1; j > i + 1; --j)
+            set_child(x, j, child(x, j - 1));
+        set_child(x, i + 1, right);
+        ++x->count;
+        left->count = static_cast<uint8_t>(mid);
+    }
+
+    // 根节点已满时长高一层，保证从根向下插入时经过的节点都有空位
+    void grow_if_full() {
+        if (root->count < kNodeSlots)
+            return;
+        Node* new_root = new_internal();
+        set_child(new_root, 0, root);
+        root = new_root;
+        split_child(root, 0);
+        update_extremes();
+    }
+
+    // 位置 i 的值已经析构或移走：后面的值前移
+    static void close_gap(Node* x, size_t i) {
+        for (size_t j = i + 1; j < x->count; ++j)
+            transfer(x->slot(j - 1), x->slot(j));
+        --x->count;
+    }
+
+    // 把 right 与两者之间的分隔值并入 left，释放 right
+    void merge_nodes(Node* left, Node* right) {
+        Node* parent = left->parent;
+        const size_t sep = left->position;
+        transfer(left->slot(left->count), parent->slot(sep));
+        for (size_t j = 0; j < right->count; ++j)
+            transfer(left->slot(left->count + 1 + j), right->slot(j));
+        if (!left->leaf) {
+            for (size_t j = 0; j <= right->count; ++j)
+                set_child(left, left->count + 1 + j, child(right, j));
+        }
+        left->count = static_cast<uint8_t>(left->count + 1 + right->count);
+
+        for (size_t j = sep + 1; j < parent->count; ++j)
+            transfer(parent->slot(j - 1), parent->slot(j));
+        for (size_t j = sep + 2; j <= parent->count; ++j)
+            set_child(parent, j - 1, child(parent, j));
+        --parent->count;
+        right->count = 0;
+        free_node(right);
+    }
+
+    // 从右兄弟借 n 个值给 left (经过父节点中的分隔值)
+    void rebalance_right_to_left(size_t n, Node* right, Node* left) {
+        Node* parent = left->parent;
+        const size_t sep = left->position;
+        transfer(left->slot(left->count), parent->slot(sep));
+        for (size_t j = 0; j + 1 < n; ++j)
+            transfer(left->slot(left->count + 1 + j), right->slot(j));
+        transfer(parent->slot(sep), right->slot(n - 1));
+        for (size_t j = n; j < right->count; ++j)
+            transfer(right->slot(j - n), right->slot(j));
+        if (!left->leaf) {
+            for (size_t j = 0; j < n; ++j)
+                set_child(left, left->count + 1 + j, child(right, j));
+            for (size_t j = n; j <= right->count; ++j)
+                set_child(right, j - n, child(right, j));
+        }
+        left->count = static_cast<uint8_t>(left->count + n);
+        right->count = static_cast<uint8_t>(right->count - n);
+    }
+
+    // 从左兄弟借 n 个值给 right
+    void rebalance_left_to_right(size_t n, Node* right, Node* left) {
+        Node* parent = left->parent;
+        const size_t sep = left->position;
+        for (size_t j = right->count; j > 0; --j)
+            transfer(right->slot(j - 1 + n), right->slot(j - 1));
+        transfer(right->slot(n - 1), parent->slot(sep));
+        for (size_t j = 0; j + 1 < n; ++j)
+            transfer(right->slot(j), left->slot(left->count - n + 1 + j));
+        transfer(parent->slot(sep), left->slot(left->count - n));
+        if (!right->leaf) {
+            for (size_t j = right->count + 1; j > 0; --j)
+                set_child(right, j - 1 + n, child(right, j - 1));
+            for (size_t j = 0; j < n; ++j)
+                set_child(right, j, child(left, left->count - n + 1 + j));
+        }
+        left->count = static_cast<uint8_t>(left->count - n);
+        right->count = static_cast<uint8_t>(right->count + n);
+    }
+
+    // it 所在的非根节点不足 kMinSlots 个值：与兄弟合并 (返回 true) 或者从兄弟借值
+    // 同时调整 it，使它仍然指向原来的位置
+    bool merge_or_rebalance(Iterator& it) {
+        Node* x = it.node;
+        Node* parent = x->parent;
+        if (x->position > 0) {
+            Node* left = child(parent, x->position - 1);
+            if (1u + left->count + x->count <= kNodeSlots) {
+                it.position += 1 + left->count;
+                merge_nodes(left, x);
+                it.node = left;
+                return true;
+            }
+        }
+        if (x->position < parent->count) {
+            Node* right = child(parent, x->position + 1);
+            if (1u + x->count + right->count <= kNodeSlots) {
+                merge_nodes(x, right);
+                return true;
+            }
+            if (right->count > kMinSlots) {
+                size_t n = (right->count - x->count) / 2;
+                rebalance_right_to_left(n < 1 ? 1 : n, right, x);
+                return false;
+            }
+        }
+        if (x->position > 0) {
+            Node* left = child(parent, x->position - 1);
+            if (left->count > kMinSlots) {
+                size_t n = (left->count - x->count) / 2;
+                n = n < 1 ? 1 : n;
+                rebalance_left_to_right(n, x, left);
+                it.position += static_cast<int>(n);
+            }
+        }
+        return false;
+    }
+
+    // 删除后自底向上合并或借值，返回被删除值的下一个位置
+    Iterator rebalance_after_erase(Iterator it) {
+        Iterator res = it;
+        bool first = true;
+        for (;;) {
+            if (it.node == root) {
+                if (root->count == 0) {
+                    Node* old = root;
+                    if (root->leaf) {
+                        root = nullptr;
+                    } else {
+                        root = child(root, 0);
+                        root->parent = nullptr;
+                        root->position = 0;
+                    }
+                    free_node(old);
+                }
+                break;
+            }
+            if (it.node->count >= kMinSlots)
+                break;
+            bool merged = merge_or_rebalance(it);
+            if (first) {
+                res = it;
+                first = false;
+            }
+            if (!merged)
+                break;
+            it.position = it.node->position;
+            it.node = it.node->parent;
+        }
+        update_extremes();
+        if (root == nullptr)
+            return end();
+        return normalize(res.node, res.position);
+    }
+
+public:
+    explicit BTree(const Compare& comp = Compare(), const Alloc& a = Alloc())
+        : node_allocator(a),
+          root(nullptr),
+          leftmost(nullptr),
+          rightmost(nullptr),
+          node_count(0),
+          key_compare(comp) {}
+
+    BTree(const BTree& x)
+        : node_allocator(
+              AllocatorTraits<LeafAllocator>::select_on_container_copy_construction(x.node_allocator)),
+          root(nullptr),
+          leftmost(nullptr),
+          rightmost(nullptr),
+          node_count(0),
+          key_compare(x.key_compare) {
+        if (x.root != nullptr) {
+            root = copy_subtree(x.root);
+            node_count = x.node_count;
+            update_extremes();
+        }
+    }
+
+    BTree(BTree&& x) noexcept
+        : node_allocator(x.node_allocator),
+          root(x.root),
+          leftmost(x.leftmost),
+          rightmost(x.rightmost),
+          node_count(x.node_count),
+          key_compare(x.key_compare) {
+        x.root = x.leftmost = x.rightmost = nullptr;
+        x.node_count = 0;
+    }
+
+    BTree& operator=(const BTree& x) {
+        if (this != &x) {
+            clear();
+            propagateOnCopyAssignment(node_allocator, x.node_allocator);
+            key_compare = x.key_compare;
+            if (x.root != nullptr) {
+                root = copy_subtree(x.root);
+                node_count = x.node_count;
+                update_extremes();
+            }
+        }
+        return *this;
+    }
+
+    // 分配器相等或者随移动传播时直接接管 x 的节点，否则逐个复制
+    BTree& operator=(BTree&& x) {
+        if (this != &x) {
+            clear();
+            key_compare = x.key_compare;
+            if (AllocatorTraits<LeafAllocator>::PropagateOnContainerMoveAssignment::value ||
+                node_allocator == x.node_allocator) {
+                propagateOnMoveAssignment(node_allocator, x.node_allocator);
+                swap_nodes(x);
+            } else if (x.root != nullptr) {
+                root = copy_subtree(x.root);
+                node_count = x.node_count;
+                update_extremes();
+            }
+        }
+        return *this;
+    }
+
+    ~BTree() { clear(); }
+
+    Compare key_comp() const { return key_compare; }
+    AllocatorType get_allocator() const { return node_allocator.rawAllocator(); }
+
+    Iterator begin() { return root ? Iterator(leftmost, 0) : Iterator(); }
+    Iterator end() { return end_aux<Iterator>(); }
+    ConstIterator begin() const { return root ? ConstIterator(leftmost, 0) : ConstIterator(); }
+    ConstIterator end() const { return end_aux<ConstIterator>(); }
+
+    ReverseIterator rbegin() { return ReverseIterator(end()); }
+    ReverseIterator rend() { return ReverseIterator(begin()); }
+    ConstReverseIterator rbegin() const { return ConstReverseIterator(end()); }
+    ConstReverseIterator rend() const { return ConstReverseIterator(begin()); }
+
+    bool empty() const { return node_count == 0; }
+    SizeType size() const { return node_count; }
+    SizeType max_size() const { return SizeType(-1); }
+
+    // 树的层数，空树为 0
+    SizeType height() const {
+        SizeType h = 0;
+        for (const Node* x = root; x != nullptr; x = x->leaf ? nullptr : child(x, 0))
+            ++h;
+        return h;
+    }
+
+    void swap(BTree& x) {
+        propagateOnSwap(node_allocator, x.node_allocator);
+        std::swap(key_compare, x.key_compare);
+        swap_nodes(x);
+    }
+
+    void clear() {
+        if (root != nullptr) {
+            destroy_subtree(root);
+            root = leftmost = rightmost = nullptr;
+            node_count = 0;
+        }
+    }
+
+    Pair<Iterator, bool> insert_unique(const Value& v) { return insert_unique_aux(v); }
+    Pair<Iterator, bool> insert_unique(Value&& v) { return insert_unique_aux(std::move(v)); }
+
+    Iterator insert_equal(const Value& v) { return insert_equal_aux(v); }
+    Iterator insert_equal(Value&& v) { return insert_equal_aux(std::move(v)); }
+
+    template <typename InputIterator>
+    void insert_unique(InputIterator first, InputIterator last) {
+        for (; first != last; ++first)
+            insert_unique(*first);
+    }
+
+    template <typename InputIterator>
+    void insert_equal(InputIterator first, InputIterator last) {
+        for (; first != last; ++first)
+            insert_equal(*first);
+    }
+
+    // 删除 position 处的值，返回下一个值的位置
+    // 内部节点上的值由它的前驱 (一定在叶子上) 顶替，再从叶子上去掉前驱原来的位置
+    Iterator erase(Iterator position) {
+        bool internal = !position.node->leaf;
+        if (internal) {
+            Iterator target = position;
+            --position;
+            destroy(target.node->slot(target.position));
+            transfer(target.node->slot(target.position), position.node->slot(position.position));
+        } else {
+            destroy(position.node->slot(position.position));
+        }
+        close_gap(position.node, position.position);
+        --node_count;
+        Iterator res = rebalance_after_erase(position);
+        if (internal)
+            ++res;
+        return res;
+    }
+
+    Iterator erase(Iterator first, Iterator last) {
+        if (first == begin() && last == end()) {
+            clear();
+            return end();
+        }
+        SizeType n = 0;
+        for (Iterator it = first; it != last; ++it)
+            ++n;
+        while (n-- > 0)
+            first = erase(first);
+        return first;
+    }
+
+    SizeType erase(const Key& k) {
+        Iterator first = lower_bound(k);
+        SizeType n = 0;
+        while (first != end() && !key_compare(k, KeyOfValue()(*first))) {
+            first = erase(first);
+            ++n;
+        }
+        return n;
+    }
+
+    // 在某一层遇到相等的值就返回，不必走到叶子
+    Iterator find(const Key& k) { return find_aux<Iterator>(k); }
+    ConstIterator find(const Key& k) const { return find_aux<ConstIterator>(k); }
+
+    SizeType count(const Key& k) const {
+        Pair<ConstIterator, ConstIterator> p = equal_range(k);
+        SizeType n = 0;
+        for (ConstIterator it = p.first; it != p.second; ++it)
+            ++n;
+        return n;
+    }
+
+    // 每层在节点内二分查找，记住最深处第一个不小于 (大于) k 的值
+    Iterator lower_bound(const Key& k) { return bound_aux<Iterator, false>(k); }
+    ConstIterator lower_bound(const Key& k) const { return bound_aux<ConstIterator, false>(k); }
+    Iterator upper_bound(const Key& k) { return bound_aux<Iterator, true>(k); }
+    ConstIterator upper_bound(const Key& k) const { return bound_aux<ConstIterator, true>(k); }
+
+    Pair<Iterator, Iterator> equal_range(const Key& k) {
+        return Pair<Iterator, Iterator>(lower_bound(k), upper_bound(k));
+    }
+
+    Pair<ConstIterator, ConstIterator> equal_range(const Key& k) const {
+        return Pair<ConstIterator, ConstIterator>(lower_bound(k), upper_bound(k));
+    }
+
+    // 检查 B 树的性质：节点内有序、非根节点不少于 kMinSlots 个值、所有叶子同一深度、父子指针一致
+    bool verify() const {
+        if (root == nullptr)
+            return node_count == 0;
+        SizeType n = 0;
+        int leaf_depth = -1;
+        return verify_node(root, 0, leaf_depth, n) && n == node_count && root->parent == nullptr;
+    }
+
+private:
+    void swap_nodes(BTree& x) {
+        std::swap(root, x.root);
+        std::swap(leftmost, x.leftmost);
+        std::swap(rightmost, x.rightmost);
+        std::swap(node_count, x.node_count);
+    }
+
+    template <typename It>
+    It end_aux() const {
+        return root ? It(rightmost, rightmost->count) : It();
+    }
+
+    template <typename It>
+    It find_aux(const Key& k) const {
+        for (Node* x = root; x != nullptr;) {
+            size_t i = lower_bound_in(x, k);
+            if (i < x->count && !key_compare(k, key(x, i)))
+                return It(x, static_cast<int>(i));
+            x = x->leaf ? nullptr : child(x, i);
+        }
+        return end_aux<It>();
+    }
+
+    template <typename It, bool Upper>
+    It bound_aux(const Key& k) const {
+        Node* result = nullptr;
+        size_t pos = 0;
+        for (Node* x = root; x != nullptr;) {
+            size_t i = Upper ? upper_bound_in(x, k) : lower_bound_in(x, k);
+            if (i < x->count) {
+                result = x;
+                pos = i;
+            }
+            x = x->leaf ? nullptr : child(x, i);
+        }
+        return result ? It(result, static_cast<int>(pos)) : end_aux<It>();
+    }
+
+    // 从根向下，沿途先把已满的孩子分裂开，到达叶子时一定有空位
+    template <typename V>
+    Pair<Iterator, bool> insert_unique_aux(V&& v) {
+        const Key& k = KeyOfValue()(v);
+        if (root == nullptr)
+            root = leftmost = rightmost = new_leaf();
+        grow_if_full();
+        Node* x = root;
+        for (;;) {
+            size_t i = lower_bound_in(x, k);
+            if (i < x->count && !key_compare(k, key(x, i)))
+                return Pair<Iterator, bool>(Iterator(x, static_cast<int>(i)), false);
+            if (x->leaf) {
+                insert_value(x, i, std::forward<V>(v));
+                ++node_count;
+                return Pair<Iterator, bool>(Iterator(x, static_cast<int>(i)), true);
+            }
+            if (child(x, i)->count == kNodeSlots) {
+                split_child(x, i);
+                update_extremes();
+                if (key_compare(key(x, i), k))
+                    ++i;
+                else if (!key_compare(k, key(x, i)))
+                    return Pair<Iterator, bool>(Iterator(x, static_cast<int>(i)), false);
+            }
+            x = child(x, i);
+        }
+    }
+
+    // 相等的值插在已有的相等值之后
+    template <typename V>
+    Iterator insert_equal_aux(V&& v) {
+        const Key& k = KeyOfValue()(v);
+        if (root == nullptr)
+            root = leftmost = rightmost = new_leaf();
+        grow_if_full();
+        Node* x = root;
+        for (;;) {
+            size_t i = upper_bound_in(x, k);
+            if (x->leaf) {
+                insert_value(x, i, std::forward<V>(v));
+                ++node_count;
+                return Iterator(x, static_cast<int>(i));
+            }
+            if (child(x, i)->count == kNodeSlots) {
+                split_child(x, i);
+                update_extremes();
+                if (!key_compare(k, key(x, i)))
+                    ++i;
+            }
+            x = child(x, i);
+        }
+    }
+
+    bool verify_node(const Node* x, int depth, int& leaf_depth, SizeType& n) const {
+        if (x != root && x->count < kMinSlots)
+            return false;
+        for (size_t i = 1; i < x->count; ++i) {
+            if (key_compare(key(x, i), key(x, i - 1)))
+                return false;
+        }
+        n += x->count;
+        if (x->leaf) {
+            if (leaf_depth < 0)
+                leaf_depth = depth;
+            return leaf_depth == depth;
+        }
+        for (size_t i = 0; i <= x->count; ++i) {
+            const Node* c = child(x, i);
+            if (c->parent != x || c->position != i)
+                return false;
+            if (i > 0 && key_compare(key(c, 0), key(x, i - 1)))
+                return false;
+            if (i < x->count && key_compare(key(x, i), key(c, c->count - 1)))
+                return false;
+            if (!verify_node(c, depth + 1, leaf_depth, n))
+                return false;
+        }
+        return true;
+    }
+};
+
+}  // namespace mstl
+
+#endif  // __MSGI_STL_INTERNAL_BTREE_H
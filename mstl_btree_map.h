@@ -0,0 +1,192 @@
+#ifndef __MSGI_STL_INTERNAL_BTREE_MAP_H
+#define __MSGI_STL_INTERNAL_BTREE_MAP_H
+
+#include "mstl_functional.h"
+#include "mstl_alloc.h"
+#include "mstl_btree.h"
+#include "mstl_pair.h"
+
+#include <algorithm>
+#include <concepts>
+namespace mstl {
+    // 以 B 树为底层的有序映射，值类型为 Pair<const Key, T>
+    // 任何插入/删除都会使迭代器失效
+    template <typename Key, typename T, typename Compare = Less<Key>, typename Alloc = thread_safe_alloc>
+    requires std::strict_weak_order<Compare, Key, Key>
+    class BTreeMap {
+    public:
+        using KeyType = Key;
+        using MappedType = T;
+        using ValueType = Pair<const Key, T>;
+        using KeyCompare = Compare;
+        using AllocatorType = Alloc;
+
+    private:
+        using RepType = BTree<KeyType, ValueType, Select1st<ValueType>, Compare, Alloc>;
+
+        RepType t;
+    public:
+        using Pointer = typename RepType::Pointer;
+        using ConstPointer = typename RepType::ConstPointer;
+        using Reference = typename RepType::Reference;
+        using ConstReference = typename RepType::ConstReference;
+        using Iterator = typename RepType::Iterator;
+        using ConstIterator = typename RepType::ConstIterator;
+        using ReverseIterator = typename RepType::ReverseIterator;
+        using ConstReverseIterator = typename RepType::ConstReverseIterator;
+
+        using SizeType = size_t;
+        using DifferenceType = typename RepType::DifferenceType;
+
+        BTreeMap() : t(Compare()) {}
+        explicit BTreeMap(const Compare& comp, const Alloc& a = Alloc()) : t(comp, a) {}
+        explicit BTreeMap(const Alloc& a) : t(Compare(), a) {}
+        BTreeMap(const BTreeMap& x) : t(x.t) {}
+        BTreeMap(BTreeMap&& x) noexcept : t(std::move(x.t)) {}
+
+        template <typename InputIterator>
+        BTreeMap(InputIterator first, InputIterator last) : t(Compare()) {
+            t.insert_unique(first, last);
+        }
+
+        BTreeMap& operator=(const BTreeMap& x) {
+            t = x.t;
+            return *this;
+        }
+
+        BTreeMap& operator=(BTreeMap&& x) {
+            t = std::move(x.t);
+            return *this;
+        }
+
+        KeyCompare key_comp() const {
+            return t.key_comp();
+        }
+
+        AllocatorType get_allocator() const {
+            return t.get_allocator();
+        }
+
+        Iterator begin() {
+            return t.begin();
+        }
+
+        Iterator end() {
+            return t.end();
+        }
+
+        ConstIterator begin() const {
+            return t.begin();
+        }
+
+        ConstIterator end() const {
+            return t.end();
+        }
+
+        ReverseIterator rbegin() {
+            return t.rbegin();
+        }
+
+        ReverseIterator rend() {
+            return t.rend();
+        }
+
+        ConstReverseIterator rbegin() const {
+            return t.rbegin();
+        }
+
+        ConstReverseIterator rend() const {
+            return t.rend();
+        }
+
+        bool empty() const {
+            return t.empty();
+        }
+
+        SizeType size() const {
+            return t.size();
+        }
+
+        SizeType max_size() const {
+            return t.max_size();
+        }
+
+        void swap(BTreeMap& x) {
+            t.swap(x.t);
+        }
+
+        // 键不存在时插入 T()
+        T& operator[](const Key& k) {
+            Iterator it = t.lower_bound(k);
+            if (it == t.end() || t.key_comp()(k, it->first))
+                it = t.insert_unique(ValueType(k, T())).first;
+            return it->second;
+        }
+
+        Pair<Iterator, bool> insert(const ValueType& x) {
+            return t.insert_unique(x);
+        }
+
+        template <typename InputIterator>
+        void insert(InputIterator first, InputIterator last) {
+            t.insert_unique(first, last);
+        }
+
+        Iterator erase(Iterator position) {
+            return t.erase(position);
+        }
+
+        SizeType erase(const Key& x) {
+            return t.erase(x);
+        }
+
+        void clear() {
+            t.clear();
+        }
+
+        Iterator find(const Key& x) {
+            return t.find(x);
+        }
+
+        ConstIterator find(const Key& x) const {
+            return t.find(x);
+        }
+
+        SizeType count(const Key& x) const {
+            return t.find(x) != t.end() ? 1 : 0;
+        }
+
+        Iterator lower_bound(const Key& x) {
+            return t.lower_bound(x);
+        }
+
+        ConstIterator lower_bound(const Key& x) const {
+            return t.lower_bound(x);
+        }
+
+        Iterator upper_bound(const Key& x) {
+            return t.upper_bound(x);
+        }
+
+        ConstIterator upper_bound(const Key& x) const {
+            return t.upper_bound(x);
+        }
+
+        Pair<Iterator, Iterator> equal_range(const Key& x) {
+            return t.equal_range(x);
+        }
+
+        Pair<ConstIterator, ConstIterator> equal_range(const Key& x) const {
+            return t.equal_range(x);
+        }
+
+        friend bool operator==(const BTreeMap& x, const BTreeMap& y) {
+            return x.size() == y.size() && std::equal(x.begin(), x.end(), y.begin());
+        }
+        friend bool operator!=(const BTreeMap& x, const BTreeMap& y) {
+            return !(x == y);
+        }
+    };
+}
+
+#endif // __MSGI_STL_INTERNAL_BTREE_MAP_H
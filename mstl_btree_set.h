@@ -0,0 +1,167 @@
+#ifndef __MSGI_STL_INTERNAL_BTREE_SET_H
+#define __MSGI_STL_INTERNAL_BTREE_SET_H
+
+#include "mstl_functional.h"
+#include "mstl_alloc.h"
+#include "mstl_btree.h"
+#include "mstl_pair.h"
+
+#include <algorithm>
+#include <concepts>
+namespace mstl {
+    // 以 B 树为底层的 Set：接口与 Set 相同，查找与顺序遍历更快
+    // 与 Set 不同，任何插入/删除都会使迭代器失效
+    template <typename Key, typename Compare = Less<Key>, typename Alloc = thread_safe_alloc>
+    requires (std::equality_comparable<Key> && std::strict_weak_order<Compare, Key, Key>)
+    class BTreeSet {
+    public:
+        using KeyType = Key;
+        using ValueType = Key;
+        using KeyCompare = Compare;
+        using ValueCompare = Compare;
+        using AllocatorType = Alloc;
+
+    private:
+        using RepType = BTree<KeyType, ValueType, Identity<Key>, Compare, Alloc>;
+
+        RepType t;
+    public:
+        using Pointer = typename RepType::ConstPointer;
+        using ConstPointer = typename RepType::ConstPointer;
+        using Reference = typename RepType::ConstReference;
+        using ConstReference = typename RepType::ConstReference;
+        using Iterator = typename RepType::ConstIterator;
+        using ConstIterator = typename RepType::ConstIterator;
+        using ReverseIterator = typename RepType::ConstReverseIterator;
+        using ConstReverseIterator = typename RepType::ConstReverseIterator;
+
+        using SizeType = size_t;
+        using DifferenceType = typename RepType::DifferenceType;
+
+        BTreeSet() : t(Compare()) {}
+        explicit BTreeSet(const Compare& comp, const Alloc& a = Alloc()) : t(comp, a) {}
+        explicit BTreeSet(const Alloc& a) : t(Compare(), a) {}
+        BTreeSet(const BTreeSet& x) : t(x.t) {}
+        BTreeSet(BTreeSet&& x) noexcept : t(std::move(x.t)) {}
+
+        template <typename InputIterator>
+        BTreeSet(InputIterator first, InputIterator last) : t(Compare()) {
+            t.insert_unique(first, last);
+        }
+
+        BTreeSet& operator=(const BTreeSet& x) {
+            t = x.t;
+            return *this;
+        }
+
+        BTreeSet& operator=(BTreeSet&& x) {
+            t = std::move(x.t);
+            return *this;
+        }
+
+        KeyCompare key_comp() const {
+            return t.key_comp();
+        }
+
+        ValueCompare value_comp() const {
+            return t.key_comp();
+        }
+
+        AllocatorType get_allocator() const {
+            return t.get_allocator();
+        }
+
+        Iterator begin() const {
+            return t.begin();
+        }
+
+        Iterator end() const {
+            return t.end();
+        }
+
+        ReverseIterator rbegin() const {
+            return t.rbegin();
+        }
+
+        ReverseIterator rend() const {
+            return t.rend();
+        }
+
+        bool empty() const {
+            return t.empty();
+        }
+
+        SizeType size() const {
+            return t.size();
+        }
+
+        SizeType max_size() const {
+            return t.max_size();
+        }
+
+        void swap(BTreeSet& x) {
+            t.swap(x.t);
+        }
+
+        using PairIteratorBool = Pair<Iterator, bool>;
+
+        PairIteratorBool insert(const ValueType& x) {
+            auto p = t.insert_unique(x);
+            return PairIteratorBool(p.first, p.second);
+        }
+
+        PairIteratorBool insert(ValueType&& x) {
+            auto p = t.insert_unique(std::move(x));
+            return PairIteratorBool(p.first, p.second);
+        }
+
+        template <typename InputIterator>
+        void insert(InputIterator first, InputIterator last) {
+            t.insert_unique(first, last);
+        }
+
+        Iterator erase(ConstIterator position) {
+            return t.erase(typename RepType::Iterator(position.node, position.position));
+        }
+
+        SizeType erase(const Key& x) {
+            return t.erase(x);
+        }
+
+        void clear() {
+            t.clear();
+        }
+
+        Iterator find(const Key& x) const {
+            return t.find(x);
+        }
+
+        SizeType count(const Key& x) const {
+            return t.find(x) != t.end() ? 1 : 0;
+        }
+
+        Iterator lower_bound(const Key& x) const {
+            return t.lower_bound(x);
+        }
+
+        Iterator upper_bound(const Key& x) const {
+            return t.upper_bound(x);
+        }
+
+        Pair<ConstIterator, ConstIterator> equal_range(const Key& x) const {
+            return t.equal_range(x);
+        }
+
+        friend bool operator==(const BTreeSet& x, const BTreeSet& y) {
+            return x.size() == y.size() && std::equal(x.begin(), x.end(), y.begin());
+        }
+        friend bool operator!=(const BTreeSet& x, const BTreeSet& y) {
+            return !(x == y);
+        }
+        friend bool operator<(const BTreeSet& x, const BTreeSet& y) {
+            return std::lexicographical_compare(x.begin(), x.end(), y.begin(), y.end());
+        }
+    };
+}
+
+#endif // __MSGI_STL_INTERNAL_BTREE_SET_H
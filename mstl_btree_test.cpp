@@ -0,0 +1,296 @@
+#include "mstl_btree.h"
+#include <algorithm>
+#include <cassert>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <set>
+#include <string>
+#include <vector>
+#include "mstl_btree_map.h"
+#include "mstl_btree_set.h"
+#include "mstl_functional.h"
+#include "mstl_set.h"
+
+using namespace mstl;
+
+// 节点只有 3 个值的 B 树：很少的元素就能触发多层分裂、合并与借值
+using TinyTree = BTree<int, int, Identity<int>, Less<int>, alloc, 16>;
+using SmallTree = BTree<int, int, Identity<int>, Less<int>, alloc, 64>;
+
+static_assert(TinyTree::kNodeSlots == 3);
+static_assert(BTree<int, int, Identity<int>, Less<int>>::kNodeSlots == 60);
+
+template <typename Tree, typename Ref>
+bool same_contents(const Tree& t, const Ref& ref) {
+    if (t.size() != ref.size())
+        return false;
+    auto it = ref.begin();
+    for (auto x : t) {
+        if (x != *it++)
+            return false;
+    }
+    // 反向遍历同样有序
+    auto rit = ref.rbegin();
+    for (auto i = t.rbegin(); i != t.rend(); ++i) {
+        if (*i != *rit++)
+            return false;
+    }
+    return true;
+}
+
+void test_basic_operations() {
+    std::cout << "\n=== BTree 基本操作测试 ===" << std::endl;
+    TinyTree t;
+    assert(t.empty() && t.begin() == t.end() && t.height() == 0);
+
+    for (int i = 0; i < 100; ++i) {
+        auto res = t.insert_unique(i * 2);
+        assert(res.second && *res.first == i * 2);
+        assert(t.verify());
+    }
+    assert(t.size() == 100);
+    assert(!t.insert_unique(10).second);
+    std::cout << "100 个元素, 高度 " << t.height() << std::endl;
+
+    assert(*t.find(42) == 42);
+    assert(t.find(43) == t.end());
+    assert(*t.lower_bound(43) == 44);
+    assert(*t.upper_bound(44) == 46);
+    assert(t.lower_bound(1000) == t.end());
+    assert(t.count(42) == 1 && t.count(43) == 0);
+
+    // erase 返回下一个元素
+    auto it = t.erase(t.find(42));
+    assert(*it == 44 && t.verify());
+    assert(t.erase(44) == 1 && t.erase(44) == 0);
+
+    const TinyTree& ct = t;
+    assert(*ct.find(0) == 0 && *ct.lower_bound(-1) == 0);
+
+    std::cout << "基本操作测试通过!" << std::endl;
+}
+
+// 随机插入/删除，与 std::set/std::multiset 对照，并检查 B 树性质
+template <typename Tree>
+void random_test(unsigned seed, int ops) {
+    std::mt19937 rng(seed);
+    Tree unique_tree, equal_tree;
+    std::set<int> unique_ref;
+    std::multiset<int> equal_ref;
+
+    for (int op = 0; op < ops; ++op) {
+        int k = static_cast<int>(rng() % 500);
+        if (rng() % 3 != 0) {
+            auto r = unique_tree.insert_unique(k);
+            assert(r.second == unique_ref.insert(k).second && *r.first == k);
+            assert(*equal_tree.insert_equal(k) == k);
+            equal_ref.insert(k);
+        } else {
+            assert(unique_tree.erase(k) == unique_ref.erase(k));
+            auto it = equal_tree.find(k);
+            if (it != equal_tree.end()) {
+                // 相等的键可能有多个，erase 应返回被删除元素在树中的下一个元素
+                auto after = it;
+                ++after;
+                bool has_next = after != equal_tree.end();
+                int next_value = has_next ? *after : 0;
+                auto next = equal_tree.erase(it);
+                equal_ref.erase(equal_ref.find(k));
+                assert((next != equal_tree.end()) == has_next);
+                assert(!has_next || *next == next_value);
+            }
+        }
+        if (op % 97 == 0) {
+            assert(unique_tree.verify() && equal_tree.verify());
+            assert(same_contents(unique_tree, unique_ref));
+            assert(same_contents(equal_tree, equal_ref));
+        }
+    }
+    assert(same_contents(unique_tree, unique_ref));
+    assert(same_contents(equal_tree, equal_ref));
+
+    for (int k = -1; k <= 501; ++k) {
+        auto lb = equal_tree.lower_bound(k);
+        auto ref_lb = equal_ref.lower_bound(k);
+        assert((lb == equal_tree.end()) == (ref_lb == equal_ref.end()));
+        assert(lb == equal_tree.end() || *lb == *ref_lb);
+        assert(equal_tree.count(k) == equal_ref.count(k));
+    }
+
+    // 区间删除
+    auto first = unique_tree.lower_bound(100), last = unique_tree.lower_bound(300);
+    unique_tree.erase(first, last);
+    unique_ref.erase(unique_ref.lower_bound(100), unique_ref.lower_bound(300));
+    assert(unique_tree.verify() && same_contents(unique_tree, unique_ref));
+
+    // 逐个删除直到为空
+    while (!equal_tree.empty()) {
+        equal_tree.erase(equal_tree.begin());
+        equal_ref.erase(equal_ref.begin());
+        assert(same_contents(equal_tree, equal_ref));
+    }
+    assert(equal_tree.verify() && equal_tree.height() == 0);
+}
+
+void test_random_operations() {
+    std::cout << "\n=== BTree 随机操作测试 ===" << std::endl;
+    for (unsigned seed = 1; seed <= 3; ++seed) {
+        random_test<TinyTree>(seed, 5000);
+        random_test<SmallTree>(seed, 5000);
+    }
+    std::cout << "随机操作测试通过!" << std::endl;
+}
+
+void test_copy_and_move() {
+    std::cout << "\n=== BTree 拷贝与移动测试 ===" << std::endl;
+    TinyTree t;
+    for (int i = 0; i < 200; ++i)
+        t.insert_equal(i % 50);
+
+    TinyTree copy(t);
+    assert(copy.verify() && copy.size() == 200);
+    assert(std::equal(copy.begin(), copy.end(), t.begin()));
+
+    TinyTree moved(std::move(copy));
+    assert(moved.size() == 200 && copy.empty());
+    copy.insert_unique(1);
+    assert(copy.size() == 1);
+
+    copy = t;
+    assert(copy.size() == 200 && copy.verify());
+    moved = std::move(copy);
+    assert(moved.size() == 200 && moved.verify());
+
+    TinyTree other;
+    other.insert_unique(-1);
+    other.swap(moved);
+    assert(other.size() == 200 && moved.size() == 1 && *moved.begin() == -1);
+    std::cout << "拷贝与移动测试通过!" << std::endl;
+}
+
+void test_string_values() {
+    std::cout << "\n=== BTree<string> 测试 ===" << std::endl;
+    BTree<std::string, std::string, Identity<std::string>, Less<std::string>> t;
+    std::vector<std::string> words;
+    for (int i = 0; i < 1000; ++i)
+        words.push_back("key" + std::to_string(i * 7919 % 1000));
+    t.insert_unique(words.begin(), words.end());
+    assert(t.size() == 1000 && t.verify());
+    assert(*t.find("key500") == "key500");
+    for (int i = 0; i < 1000; i += 2)
+        t.erase("key" + std::to_string(i));
+    assert(t.size() == 500 && t.verify());
+    assert(t.find("key2") == t.end() && *t.find("key3") == "key3");
+    std::cout << "BTree<string> 测试通过!" << std::endl;
+}
+
+void test_adapters() {
+    std::cout << "\n=== BTreeSet/BTreeMap 测试 ===" << std::endl;
+    BTreeSet<int> s;
+    for (int i = 10; i > 0; --i)
+        assert(s.insert(i).second);
+    assert(!s.insert(5).second);
+    assert(s.size() == 10 && *s.begin() == 1 && *s.rbegin() == 10);
+    assert(s.count(3) == 1 && s.erase(3) == 1 && s.count(3) == 0);
+    assert(*s.erase(s.find(4)) == 5);
+
+    BTreeSet<int> s2(s);
+    assert(s == s2);
+    s2.insert(100);
+    assert(s != s2 && s < s2);
+
+    BTreeMap<std::string, int> m;
+    m["apple"] = 1;
+    m["banana"] = 2;
+    m["apple"] += 10;
+    assert(m.size() == 2 && m["apple"] == 11);
+    assert(m.insert(Pair<const std::string, int>("cherry", 3)).second);
+    assert(!m.insert(Pair<const std::string, int>("cherry", 4)).second);
+    assert(m.find("cherry")->second == 3);
+    m.find("banana")->second = 20;
+    assert(m["banana"] == 20);
+    assert(m.erase("apple") == 1 && m.size() == 2);
+    assert(m.begin()->first == "banana");
+
+    const BTreeMap<std::string, int>& cm = m;
+    assert(cm.find("durian") == cm.end() && cm.count("cherry") == 1);
+    std::cout << "BTreeSet/BTreeMap 测试通过!" << std::endl;
+}
+
+// 与红黑树的 Set 比较插入、查找和顺序遍历
+void benchmark_vs_rbtree() {
+    const int n = 100000;
+    std::cout << "\n=== BTreeSet 与 Set 性能比较 (" << n << " 个随机 int) ===" << std::endl;
+    std::vector<int> keys(n);
+    for (int i = 0; i < n; ++i)
+        keys[i] = i * 2;
+    std::shuffle(keys.begin(), keys.end(), std::mt19937(7));
+
+    auto time = [](auto&& fn) {
+        auto start = std::chrono::high_resolution_clock::now();
+        fn();
+        auto end = std::chrono::high_resolution_clock::now();
+        return std::chrono::duration<double>(end - start).count();
+    };
+
+    Set<int> rb;
+    BTreeSet<int> bt;
+    double rb_insert = time([&]() {
+        for (int k : keys)
+            rb.insert(k);
+    });
+    double bt_insert = time([&]() {
+        for (int k : keys)
+            bt.insert(k);
+    });
+
+    size_t found = 0;
+    double rb_find = time([&]() {
+        for (int k : keys)
+            found += rb.find(k) != rb.end();
+    });
+    double bt_find = time([&]() {
+        for (int k : keys)
+            found += bt.find(k) != bt.end();
+    });
+    assert(found == 2 * keys.size());
+
+    // 区间扫描：每次从 lower_bound 开始顺序读 100 个元素
+    long long sum_rb = 0, sum_bt = 0;
+    double rb_scan = time([&]() {
+        for (int i = 0; i < 1000; ++i) {
+            auto it = rb.lower_bound(keys[i]);
+            for (int j = 0; j < 100 && it != rb.end(); ++j, ++it)
+                sum_rb += *it;
+        }
+    });
+    double bt_scan = time([&]() {
+        for (int i = 0; i < 1000; ++i) {
+            auto it = bt.lower_bound(keys[i]);
+            for (int j = 0; j < 100 && it != bt.end(); ++j, ++it)
+                sum_bt += *it;
+        }
+    });
+    assert(sum_rb == sum_bt);
+
+    std::cout << std::setw(12) << "" << std::setw(14) << "insert(秒)" << std::setw(14)
+              << "find(秒)" << std::setw(14) << "scan(秒)" << std::endl;
+    std::cout << std::fixed << std::setprecision(6) << std::setw(12) << "Set" << std::setw(14)
+              << rb_insert << std::setw(14) << rb_find << std::setw(14) << rb_scan << std::endl;
+    std::cout << std::setw(12) << "BTreeSet" << std::setw(14) << bt_insert << std::setw(14)
+              << bt_find << std::setw(14) << bt_scan << std::endl;
+}
+
+int main() {
+    std::cout << "开始测试 mstl::BTree..." << std::endl;
+    test_basic_operations();
+    test_random_operations();
+    test_copy_and_move();
+    test_string_values();
+    test_adapters();
+    benchmark_vs_rbtree();
+    std::cout << "\n所有测试通过!" << std::endl;
+    return 0;
+}
@@ -28,6 +28,18 @@ concept TriviallyCopyable = std::is_trivially_copyable_v<T>;
 template <typename T>
 concept TriviallyDestructible = std::is_trivially_destructible_v<T>;
 
+// 可平凡重定位：把对象按字节搬到新地址、不再析构旧对象，等价于移动构造后析构旧对象
+// 平凡可复制的类型天然满足；其他类型 (例如只持有一个堆指针的句柄) 可以声明
+// using IsTriviallyRelocatable = std::true_type，或者特化下面的 IsTriviallyRelocatable 来加入，
+// 加入的类型的移动构造不能抛异常
+template <typename T>
+struct IsTriviallyRelocatable
+    : std::bool_constant<std::is_trivially_copyable_v<T> ||
+                         requires { requires T::IsTriviallyRelocatable::value; }> {};
+
+template <typename T>
+concept TriviallyRelocatable = IsTriviallyRelocatable<std::remove_cv_t<T>>::value;
+
 // 基本迭代器概念
 template <typename I>
 concept Iterator = requires(I i) {
@@ -150,6 +162,18 @@ concept BinaryPredicate = Predicate<F, T, U>;
 template <typename F, typename T, typename U>
 concept Compare = BinaryPredicate<F, T, U> && BinaryPredicate<F, U, T>;
 
+// 可以多次遍历的迭代器：mstl 或标准库的前向迭代器，用于先扫描一遍再处理的算法
+template <typename I>
+concept MultiPassIterator =
+    std::forward_iterator<I> ||
+    (requires { typename I::IteratorCategory; } &&
+     std::is_base_of_v<ForwardIteratorTag, typename I::IteratorCategory>);
+
+// 透明比较器：声明了 IsTransparent (或标准库的 is_transparent)
+template <typename F>
+concept TransparentCompare =
+    requires { typename F::IsTransparent; } || requires { typename F::is_transparent; };
+
 }  // namespace mstl
 
 #endif  // __MSGI_STL_INTERNAL_CONCEPTS_H
\ No newline at end of file
@@ -0,0 +1,312 @@
+#ifndef __MSGI_STL_INTERNAL_CONCURRENT_SET_H
+#define __MSGI_STL_INTERNAL_CONCURRENT_SET_H
+
+#include <algorithm>
+#include <atomic>
+#include <concepts>
+#include <cstdint>
+#include <mutex>
+#include "mstl_alloc.h"
+#include "mstl_concepts.h"
+#include "mstl_construct.h"
+#include "mstl_epoch.h"
+#include "mstl_functional.h"
+#include "mstl_iterator_tags.h"
+#include "mstl_pair.h"
+#include "mstl_vector.h"
+
+namespace mstl {
+
+// 读多写少的并发有序集合，底层是跳表
+// 读者 (contains/for_each/迭代) 不加锁，只做 acquire load，靠 EpochGuard 保证读到的节点不被释放；
+// 写者 (insert/erase/clear) 用一把互斥锁串行化，新节点先初始化完再用 release store 挂上，
+// 摘下的节点按 epoch 延迟回收
+template <typename Key, typename Compare = Less<Key>, typename Alloc = thread_safe_alloc>
+requires std::strict_weak_order<Compare, Key, Key>
+class ConcurrentSet {
+    static constexpr int kMaxHeight = 20;       // 每层 1/4 的概率升高，足够上亿个元素
+    static constexpr size_t kReclaimBatch = 64;  // 至少攒够这么多退休节点再尝试回收
+
+    // next 数组紧跟在节点之后，长度为 height
+    struct alignas(void*) Node {
+        int height;
+        Key value;
+
+        std::atomic<Node*>* next() { return reinterpret_cast<std::atomic<Node*>*>(this + 1); }
+    };
+
+public:
+    using KeyType = Key;
+    using ValueType = Key;
+    using KeyCompare = Compare;
+    using SizeType = size_t;
+    using DifferenceType = ptrdiff_t;
+
+    // 只能在 EpochGuard 存活期间使用，迭代时可能看到也可能看不到并发的修改
+    class ConstIterator {
+    public:
+        using IteratorCategory = ForwardIteratorTag;
+        using ValueType = Key;
+        using DifferenceType = ptrdiff_t;
+        using Pointer = const Key*;
+        using Reference = const Key&;
+
+        ConstIterator() : node(0) {}
+
+        Reference operator*() const { return node->value; }
+        Pointer operator->() const { return &node->value; }
+
+        ConstIterator& operator++() {
+            node = node->next()[0].load(std::memory_order_acquire);
+            return *this;
+        }
+
+        ConstIterator operator++(int) {
+            ConstIterator tmp = *this;
+            ++*this;
+            return tmp;
+        }
+
+        bool operator==(const ConstIterator& x) const { return node == x.node; }
+        bool operator!=(const ConstIterator& x) const { return node != x.node; }
+
+    private:
+        friend class ConcurrentSet;
+        explicit ConstIterator(Node* x) : node(x) {}
+
+        Node* node;
+    };
+
+    explicit ConcurrentSet(const Compare& comp = Compare())
+        : key_compare(comp), head(allocate_node(kMaxHeight)), height(1), node_count(0), rng_state(0x9E3779B97F4A7C15ull),
+          reclaim_threshold(kReclaimBatch) {
+        for (int i = 0; i < kMaxHeight; ++i)
+            construct(&head->next()[i], nullptr);
+    }
+
+    ConcurrentSet(const ConcurrentSet&) = delete;
+    ConcurrentSet& operator=(const ConcurrentSet&) = delete;
+
+    // 调用者保证析构时没有读者
+    ~ConcurrentSet() {
+        Node* x = head->next()[0].load(std::memory_order_relaxed);
+        while (x != 0) {
+            Node* next = x->next()[0].load(std::memory_order_relaxed);
+            destroy_node(x);
+            x = next;
+        }
+        for (auto& r : retired)
+            destroy_node(r.first);
+        deallocate_node(head);
+    }
+
+    KeyCompare key_comp() const { return key_compare; }
+
+    // 并发修改时只是一个近似值
+    SizeType size() const { return node_count.load(std::memory_order_relaxed); }
+    bool empty() const { return size() == 0; }
+
+    ConstIterator begin() const { return ConstIterator(head->next()[0].load(std::memory_order_acquire)); }
+    ConstIterator end() const { return ConstIterator(); }
+
+    ConstIterator lower_bound(const Key& k) const { return ConstIterator(lower_bound_node(k)); }
+
+    template <typename K>
+        requires TransparentCompare<Compare>
+    ConstIterator lower_bound(const K& k) const { return ConstIterator(lower_bound_node(k)); }
+
+    // 以下读操作自带 EpochGuard
+    bool contains(const Key& k) const { return contains_aux(k); }
+
+    template <typename K>
+        requires TransparentCompare<Compare>
+    bool contains(const K& k) const { return contains_aux(k); }
+
+    template <typename Function>
+    void for_each(Function f) const {
+        EpochGuard guard;
+        for (ConstIterator it = begin(); it != end(); ++it)
+            f(*it);
+    }
+
+    // 依次访问 [first, last) 中的元素
+    template <typename Function>
+    void for_each(const Key& first, const Key& last, Function f) const {
+        EpochGuard guard;
+        for (ConstIterator it = lower_bound(first); it != end() && key_compare(*it, last); ++it)
+            f(*it);
+    }
+
+    bool insert(const Key& k) { return insert_aux(k); }
+    bool insert(Key&& k) { return insert_aux(std::move(k)); }
+
+    SizeType erase(const Key& k) {
+        std::lock_guard<std::mutex> lock(write_mutex);
+        Node* preds[kMaxHeight];
+        Node* x = find_preds(k, preds);
+        if (x == 0 || key_compare(k, x->value))
+            return 0;
+        // 自上而下摘下，读者停在 x 上时仍能沿 x 的 next 继续走
+        for (int i = x->height - 1; i >= 0; --i)
+            preds[i]->next()[i].store(x->next()[i].load(std::memory_order_relaxed), std::memory_order_release);
+        node_count.fetch_sub(1, std::memory_order_relaxed);
+        retire(x);
+        return 1;
+    }
+
+    void clear() {
+        std::lock_guard<std::mutex> lock(write_mutex);
+        Node* x = head->next()[0].load(std::memory_order_relaxed);
+        for (int i = 0; i < kMaxHeight; ++i)
+            head->next()[i].store(nullptr, std::memory_order_release);
+        node_count.store(0, std::memory_order_relaxed);
+        retire_chain(x);
+    }
+
+private:
+    static SizeType node_bytes(int h) { return sizeof(Node) + h * sizeof(std::atomic<Node*>); }
+
+    static Node* allocate_node(int h) {
+        Node* x = static_cast<Node*>(Alloc::allocate(node_bytes(h)));
+        x->height = h;
+        return x;
+    }
+
+    static void deallocate_node(Node* x) { Alloc::deallocate(x, node_bytes(x->height)); }
+
+    template <typename Arg>
+    static Node* create_node(int h, Arg&& arg) {
+        Node* x = allocate_node(h);
+        try {
+            construct(&x->value, std::forward<Arg>(arg));
+        } catch (...) {
+            deallocate_node(x);
+            throw;
+        }
+        for (int i = 0; i < h; ++i)
+            construct(&x->next()[i], nullptr);
+        return x;
+    }
+
+    static void destroy_node(Node* x) {
+        destroy(&x->value);
+        deallocate_node(x);
+    }
+
+    // 写者持锁时调用，每层 1/4 的概率升高一层
+    int random_height() {
+        rng_state ^= rng_state << 13;
+        rng_state ^= rng_state >> 7;
+        rng_state ^= rng_state << 17;
+        uint64_t bits = rng_state;
+        int h = 1;
+        while (h < kMaxHeight && (bits & 3) == 0) {
+            ++h;
+            bits >>= 2;
+        }
+        return h;
+    }
+
+    template <typename K>
+    Node* lower_bound_node(const K& k) const {
+        Node* x = head;
+        for (int i = height.load(std::memory_order_relaxed) - 1; i >= 0; --i) {
+            Node* next = x->next()[i].load(std::memory_order_acquire);
+            while (next != 0 && key_compare(next->value, k)) {
+                x = next;
+                next = x->next()[i].load(std::memory_order_acquire);
+            }
+        }
+        return x->next()[0].load(std::memory_order_acquire);
+    }
+
+    template <typename K>
+    bool contains_aux(const K& k) const {
+        EpochGuard guard;
+        Node* x = lower_bound_node(k);
+        return x != 0 && !key_compare(k, x->value);
+    }
+
+    // 持锁时调用：preds[i] 是第 i 层最后一个小于 k 的节点，返回第一个不小于 k 的节点
+    Node* find_preds(const Key& k, Node** preds) {
+        Node* x = head;
+        for (int i = kMaxHeight - 1; i >= 0; --i) {
+            Node* next = x->next()[i].load(std::memory_order_relaxed);
+            while (next != 0 && key_compare(next->value, k)) {
+                x = next;
+                next = x->next()[i].load(std::memory_order_relaxed);
+            }
+            preds[i] = x;
+        }
+        return x->next()[0].load(std::memory_order_relaxed);
+    }
+
+    template <typename Arg>
+    bool insert_aux(Arg&& k) {
+        std::lock_guard<std::mutex> lock(write_mutex);
+        Node* preds[kMaxHeight];
+        Node* succ = find_preds(k, preds);
+        if (succ != 0 && !key_compare(k, succ->value))
+            return false;
+        int h = random_height();
+        Node* x = create_node(h, std::forward<Arg>(k));
+        for (int i = 0; i < h; ++i)
+            x->next()[i].store(preds[i]->next()[i].load(std::memory_order_relaxed), std::memory_order_relaxed);
+        // 节点完全初始化后自下而上发布
+        for (int i = 0; i < h; ++i)
+            preds[i]->next()[i].store(x, std::memory_order_release);
+        if (h > height.load(std::memory_order_relaxed))
+            height.store(h, std::memory_order_relaxed);
+        node_count.fetch_add(1, std::memory_order_relaxed);
+        return true;
+    }
+
+    // 持锁时调用
+    void retire(Node* x) {
+        retired.push_back(Pair<Node*, uint64_t>(x, EpochDomain::instance().retire_epoch()));
+        if (retired.size() >= reclaim_threshold)
+            reclaim();
+    }
+
+    // 持锁时调用：整条已摘下的链共用一次 retire_epoch，只推进一次全局 epoch
+    void retire_chain(Node* x) {
+        if (x == 0)
+            return;
+        uint64_t e = EpochDomain::instance().retire_epoch();
+        while (x != 0) {
+            retired.push_back(Pair<Node*, uint64_t>(x, e));
+            x = x->next()[0].load(std::memory_order_relaxed);
+        }
+        if (retired.size() >= reclaim_threshold)
+            reclaim();
+    }
+
+    // 释放所有读者都已离开的退休节点
+    void reclaim() {
+        uint64_t safe = EpochDomain::instance().safe_epoch();
+        SizeType kept = 0;
+        for (SizeType i = 0; i < retired.size(); ++i) {
+            if (retired[i].second < safe)
+                destroy_node(retired[i].first);
+            else
+                retired[kept++] = retired[i];
+        }
+        retired.erase(retired.begin() + kept, retired.end());
+        // 有读者长时间停在临界区时一个也释放不了，阈值随剩下的数量翻倍，
+        // 不让之后的每次 retire 都重新扫描整个列表
+        reclaim_threshold = std::max(kReclaimBatch, 2 * retired.size());
+    }
+
+    Compare key_compare;
+    Node* head;
+    std::atomic<int> height;
+    alignas(64) std::atomic<SizeType> node_count;
+    std::mutex write_mutex;
+    uint64_t rng_state;
+    Vector<Pair<Node*, uint64_t>> retired;
+    SizeType reclaim_threshold;
+};
+
+}  // namespace mstl
+
+#endif  // __MSGI_STL_INTERNAL_CONCURRENT_SET_H
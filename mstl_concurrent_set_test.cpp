@@ -0,0 +1,220 @@
+#include "mstl_concurrent_set.h"
+#include <atomic>
+#include <cassert>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <set>
+#include <shared_mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+#include "mstl_set.h"
+
+using namespace mstl;
+
+void test_single_thread() {
+    std::cout << "\n=== ConcurrentSet 单线程测试 ===" << std::endl;
+    ConcurrentSet<int> s;
+    assert(s.empty() && s.begin() == s.end());
+
+    std::mt19937 rng(3);
+    std::set<int> ref;
+    for (int i = 0; i < 20000; ++i) {
+        int k = static_cast<int>(rng() % 2000);
+        if (rng() % 3 != 0)
+            assert(s.insert(k) == ref.insert(k).second);
+        else
+            assert(s.erase(k) == ref.erase(k));
+    }
+    assert(s.size() == ref.size());
+
+    {
+        EpochGuard guard;
+        auto it = ref.begin();
+        for (int x : s)
+            assert(x == *it++);
+        assert(it == ref.end());
+        for (int k = -1; k <= 2001; k += 7) {
+            auto lb = s.lower_bound(k);
+            auto ref_lb = ref.lower_bound(k);
+            assert((lb == s.end()) == (ref_lb == ref.end()));
+            assert(lb == s.end() || *lb == *ref_lb);
+            assert(s.contains(k) == (ref.count(k) == 1));
+        }
+    }
+
+    std::vector<int> range;
+    s.for_each(100, 200, [&](int x) { range.push_back(x); });
+    assert(std::equal(range.begin(), range.end(), ref.lower_bound(100)));
+    assert(range.size() == static_cast<size_t>(std::distance(ref.lower_bound(100), ref.lower_bound(200))));
+
+    s.clear();
+    assert(s.empty() && !s.contains(*ref.begin()));
+    assert(s.insert(5) && !s.insert(5) && s.contains(5));
+
+    ConcurrentSet<std::string, Less<>> names;
+    names.insert("alpha");
+    names.insert(std::string("beta"));
+    assert(names.contains(std::string_view("beta")) && !names.contains(std::string_view("gamma")));
+    std::cout << "单线程测试通过!" << std::endl;
+}
+
+// 读者长时间停在临界区时什么都回收不了：逐个 erase 和 clear 都不能让每次 retire 重新扫描整个退休列表
+void test_retire_under_long_reader() {
+    std::cout << "\n=== ConcurrentSet 长时间读者下的回收测试 ===" << std::endl;
+    const int n = 100000;
+    ConcurrentSet<int> s;
+    auto start = std::chrono::steady_clock::now();
+    {
+        EpochGuard guard;
+        for (int i = 0; i < n; ++i)
+            s.insert(i);
+        for (int i = 0; i < n; i += 2)
+            assert(s.erase(i) == 1);
+        assert(s.size() == static_cast<size_t>(n / 2) && s.contains(1) && !s.contains(0));
+        s.clear();
+        assert(s.empty() && !s.contains(1));
+    }
+    for (int i = 0; i < 1000; ++i)
+        s.insert(i);
+    for (int i = 0; i < 1000; ++i)
+        assert(s.erase(i) == 1);
+    assert(s.empty());
+    auto ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    std::cout << "退休 " << n + 1000 << " 个节点耗时: " << std::fixed << std::setprecision(2) << ms << " ms" << std::endl;
+    std::cout << "回收测试通过!" << std::endl;
+}
+
+// 偶数键一直存在，奇数键被写者反复插入/删除：读者必须始终能找到偶数键，遍历结果始终有序
+void test_concurrent_readers() {
+    std::cout << "\n=== ConcurrentSet 并发读写测试 ===" << std::endl;
+    const int n = 2000;
+    ConcurrentSet<int> s;
+    for (int i = 0; i < n; i += 2)
+        s.insert(i);
+
+    std::atomic<bool> stop(false);
+    std::atomic<long long> reads(0);
+    std::vector<std::thread> readers;
+    for (int t = 0; t < 4; ++t) {
+        readers.emplace_back([&, t]() {
+            std::mt19937 rng(t);
+            long long local = 0;
+            while (!stop.load(std::memory_order_relaxed)) {
+                int k = static_cast<int>(rng() % n) & ~1;
+                assert(s.contains(k));
+                if (++local % 512 == 0) {
+                    int prev = -1, evens = 0;
+                    s.for_each([&](int x) {
+                        assert(x > prev);
+                        prev = x;
+                        evens += x % 2 == 0;
+                    });
+                    assert(evens == n / 2);
+                }
+            }
+            reads += local;
+        });
+    }
+
+    std::mt19937 rng(99);
+    for (int i = 0; i < 20000; ++i) {
+        int k = static_cast<int>(rng() % n) | 1;
+        if (rng() % 2)
+            s.insert(k);
+        else
+            s.erase(k);
+        if (i % 1000 == 0)
+            std::this_thread::yield();
+    }
+    stop = true;
+    for (auto& r : readers)
+        r.join();
+
+    int evens = 0;
+    s.for_each([&](int x) { evens += x % 2 == 0; });
+    assert(evens == n / 2);
+    std::cout << "读者共完成 " << reads.load() << " 次查找" << std::endl;
+    std::cout << "并发读写测试通过!" << std::endl;
+}
+
+// 读者数从 1 增加到 8，另有一个写者每隔一段时间修改一次：
+// ConcurrentSet 无锁读 vs Set + std::shared_mutex
+void benchmark_reader_scaling() {
+    const int n = 100000;
+    const auto duration = std::chrono::milliseconds(200);
+    std::cout << "\n=== 读者扩展性测试 (" << n << " 个键, 每组 " << duration.count()
+              << " ms, 硬件线程 " << std::thread::hardware_concurrency() << ") ===" << std::endl;
+
+    ConcurrentSet<int> lock_free;
+    Set<int> locked;
+    std::shared_mutex rw;
+    for (int i = 0; i < n; ++i) {
+        lock_free.insert(i);
+        locked.insert(i);
+    }
+
+    auto run = [&](int threads, auto&& lookup, auto&& update) {
+        std::atomic<bool> stop(false);
+        std::atomic<long long> total(0);
+        std::vector<std::thread> readers;
+        for (int t = 0; t < threads; ++t) {
+            readers.emplace_back([&, t]() {
+                std::mt19937 rng(t + 1);
+                long long local = 0;
+                while (!stop.load(std::memory_order_relaxed)) {
+                    for (int j = 0; j < 64; ++j)
+                        local += lookup(static_cast<int>(rng() % n));
+                }
+                total += local;
+            });
+        }
+        std::thread writer([&]() {
+            int i = 0;
+            while (!stop.load(std::memory_order_relaxed)) {
+                update(n + i % 100, i % 2 == 0);
+                ++i;
+                std::this_thread::sleep_for(std::chrono::microseconds(200));
+            }
+        });
+        std::this_thread::sleep_for(duration);
+        stop = true;
+        for (auto& r : readers)
+            r.join();
+        writer.join();
+        return total.load() / (std::chrono::duration<double>(duration).count() * 1e6);
+    };
+
+    std::cout << std::setw(10) << "读者数" << std::setw(24) << "ConcurrentSet(M/s)" << std::setw(24)
+              << "Set+shared_mutex(M/s)" << std::endl;
+    for (int threads : {1, 2, 4, 8}) {
+        double a = run(
+            threads, [&](int k) { return lock_free.contains(k); },
+            [&](int k, bool add) { add ? (void)lock_free.insert(k) : (void)lock_free.erase(k); });
+        double b = run(
+            threads,
+            [&](int k) {
+                std::shared_lock<std::shared_mutex> lock(rw);
+                return locked.find(k) != locked.end();
+            },
+            [&](int k, bool add) {
+                std::unique_lock<std::shared_mutex> lock(rw);
+                add ? (void)locked.insert(k) : (void)locked.erase(k);
+            });
+        std::cout << std::fixed << std::setprecision(2) << std::setw(10) << threads << std::setw(24) << a
+                  << std::setw(24) << b << std::endl;
+    }
+}
+
+int main() {
+    std::cout << "开始测试 mstl::ConcurrentSet..." << std::endl;
+    test_single_thread();
+    test_retire_under_long_reader();
+    test_concurrent_readers();
+    benchmark_reader_scaling();
+    std::cout << "\n所有测试通过!" << std::endl;
+    return 0;
+}
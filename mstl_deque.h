@@ -173,6 +173,7 @@ public:
 
     using DataAllocator = SimpleAlloc<ValueType, Alloc>;
     using MapAllocator = SimpleAlloc<Pointer, Alloc>;
+    using AllocatorType = Alloc;
 
     static size_t buffer_size() {
         return __deque_buf_size(sizeof(Tp));
@@ -190,6 +191,7 @@ public:
     }
 
 protected:
+    [[no_unique_address]] DataAllocator data_allocator;  // map 使用同一个分配器，按需 rebind
     Iterator start;      // 第一个节点
     Iterator finish;     // 最后一个节点
     MapPointer map;     // 指向map, map是连续空间
@@ -203,16 +205,26 @@ public:
         finish.cur = finish.first;
     }
 
-    explicit Deque(SizeType n) : start(), finish(), map(nullptr), map_size(0) {
+    explicit Deque(const Alloc& a)
+        : data_allocator(a), start(), finish(), map(nullptr), map_size(0) {
+        create_map_and_nodes(1);
+        start.cur = start.first;
+        finish.cur = finish.first;
+    }
+
+    explicit Deque(SizeType n, const Alloc& a = Alloc())
+        : data_allocator(a), start(), finish(), map(nullptr), map_size(0) {
         fill_initialize(n, ValueType());
     }
 
-    Deque(SizeType n, const ValueType& value) : start(), finish(), map(nullptr), map_size(0) {
+    Deque(SizeType n, const ValueType& value, const Alloc& a = Alloc())
+        : data_allocator(a), start(), finish(), map(nullptr), map_size(0) {
         fill_initialize(n, value);
     }
 
     // 移动构造函数
-    Deque(Deque&& other) noexcept : start(), finish(), map(nullptr), map_size(0) {
+    Deque(Deque&& other) noexcept
+        : data_allocator(other.data_allocator), start(), finish(), map(nullptr), map_size(0) {
         // 交换资源
         start = other.start;
         finish = other.finish;
@@ -227,7 +239,8 @@ public:
     }
 
     // 移动赋值运算符
-    Deque& operator=(Deque&& other) noexcept {
+    // 分配器相等或者随移动传播时直接接管 other 的内存，否则只能用自己的分配器逐个移动元素
+    Deque& operator=(Deque&& other) {
         if (this != &other) {
             // 释放当前资源
             if (map) {
@@ -235,9 +248,29 @@ public:
                 for (MapPointer node = start.node; node <= finish.node; ++node) {
                     deallocate_node(*node);
                 }
-                MapAllocator::deallocate(map, map_size);
+                map_allocator().deallocate(map, map_size);
+                map = nullptr;
+                map_size = 0;
+            }
+
+            if (!AllocatorTraits<DataAllocator>::PropagateOnContainerMoveAssignment::value &&
+                data_allocator != other.data_allocator) {
+                create_map_and_nodes(other.size());
+                try {
+                    mstl::uninitialized_move(other.start, other.finish, start);
+                } catch (...) {
+                    for (MapPointer node = start.node; node <= finish.node; ++node) {
+                        deallocate_node(*node);
+                    }
+                    map_allocator().deallocate(map, map_size);
+                    map = nullptr;
+                    map_size = 0;
+                    throw;
+                }
+                return *this;
             }
 
+            propagateOnMoveAssignment(data_allocator, other.data_allocator);
             // 交换资源
             start = other.start;
             finish = other.finish;
@@ -254,7 +287,13 @@ public:
     }
 
     // 拷贝构造函数
-    Deque(const Deque& other) : start(), finish(), map(nullptr), map_size(0) {
+    Deque(const Deque& other)
+        : data_allocator(AllocatorTraits<DataAllocator>::select_on_container_copy_construction(
+              other.data_allocator)),
+          start(),
+          finish(),
+          map(nullptr),
+          map_size(0) {
         create_map_and_nodes(other.size());
         try {
             uninitialized_copy(other.start, other.finish, start);
@@ -263,7 +302,7 @@ public:
             for (MapPointer node = start.node; node <= finish.node; ++node) {
                 deallocate_node(*node);
             }
-            MapAllocator::deallocate(map, map_size);
+            map_allocator().deallocate(map, map_size);
             throw;
         }
     }
@@ -277,9 +316,12 @@ public:
                 for (MapPointer node = start.node; node <= finish.node; ++node) {
                     deallocate_node(*node);
                 }
-                MapAllocator::deallocate(map, map_size);
+                map_allocator().deallocate(map, map_size);
             }
 
+            // 旧的内存已经释放，可以直接换成 other 的分配器
+            propagateOnCopyAssignment(data_allocator, other.data_allocator);
+
             // 分配新资源并复制元素
             create_map_and_nodes(other.size());
             try {
@@ -289,7 +331,7 @@ public:
                 for (MapPointer node = start.node; node <= finish.node; ++node) {
                     deallocate_node(*node);
                 }
-                MapAllocator::deallocate(map, map_size);
+                map_allocator().deallocate(map, map_size);
                 throw;
             }
         }
@@ -308,12 +350,26 @@ public:
             }
 
             // 释放 map 数组
-            MapAllocator::deallocate(map, map_size);
+            map_allocator().deallocate(map, map_size);
             map = nullptr;
             map_size = 0;
         }
     }
 
+    AllocatorType get_allocator() const {
+        return data_allocator.rawAllocator();
+    }
+
+    // 交换两个 deque 的内容；分配器只在 PropagateOnContainerSwap 时交换，
+    // 否则两个分配器必须相等
+    void swap(Deque& other) noexcept {
+        propagateOnSwap(data_allocator, other.data_allocator);
+        std::swap(start, other.start);
+        std::swap(finish, other.finish);
+        std::swap(map, other.map);
+        std::swap(map_size, other.map_size);
+    }
+
     Iterator begin() {
         return start;
     }
@@ -371,7 +427,7 @@ public:
     void create_map_and_nodes(SizeType num_elements) {
         SizeType num_nodes = num_elements / buffer_size() + 1;
         map_size = std::max(initial_map_size(), num_nodes + 2);
-        map = MapAllocator::allocate(map_size);
+        map = map_allocator().allocate(map_size);
         MapPointer nstart = map + (map_size - num_nodes) / 2;
         MapPointer nfinish = nstart + num_nodes;
 
@@ -386,7 +442,7 @@ public:
                 deallocate_node(*node);
             }
             // 释放 map 数组
-            MapAllocator::deallocate(map, map_size);
+            map_allocator().deallocate(map, map_size);
             map = nullptr;
             map_size = 0;
             throw;
@@ -402,12 +458,16 @@ public:
         return std::max(map_size, SizeType(8));
     }
 
+    MapAllocator map_allocator() const {
+        return MapAllocator(data_allocator);
+    }
+
     Pointer allocate_node() {
-        return DataAllocator::allocate(buffer_size());
+        return data_allocator.allocate(buffer_size());
     }
 
     void deallocate_node(Pointer p) {
-        DataAllocator::deallocate(p, buffer_size());
+        data_allocator.deallocate(p, buffer_size());
     }
 
     template <typename U>
@@ -509,7 +569,7 @@ public:
                 destroy(start, new_start);
 
                 for (MapPointer cur = start.node; cur < new_start.node; ++cur) {
-                    DataAllocator::deallocate(*cur, buffer_size());
+                    deallocate_node(*cur);
                 }
                 start = new_start;
             } else {
@@ -518,7 +578,7 @@ public:
                 destroy(new_finish, finish);
 
                 for (MapPointer cur = new_finish.node + 1; cur <= finish.node; ++cur) {
-                    DataAllocator::deallocate(*cur, buffer_size());
+                    deallocate_node(*cur);
                 }
                 finish = new_finish;
             }
@@ -552,11 +612,11 @@ public:
             }
         } else {
             SizeType new_map_size = map_size + std::max(map_size, nodes_to_add) + 2;
-            MapPointer new_map = MapAllocator::allocate(new_map_size);
+            MapPointer new_map = map_allocator().allocate(new_map_size);
             new_start =
                 new_map + (new_map_size - new_num_nodes) / 2 + (add_at_front ? nodes_to_add : 0);
             std::copy(start.node, finish.node + 1, new_start);
-            MapAllocator::deallocate(map, map_size);
+            map_allocator().deallocate(map, map_size);
             map = new_map;
             map_size = new_map_size;
         }
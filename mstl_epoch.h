@@ -0,0 +1,121 @@
+#ifndef __MSGI_STL_INTERNAL_EPOCH_H
+#define __MSGI_STL_INTERNAL_EPOCH_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <thread>
+
+namespace mstl {
+
+// 基于 epoch 的延迟回收 (EBR)
+// 读者进入临界区时把当前全局 epoch 写进本线程独占的槽 (一次普通 store 加一个 fence)，
+// 退出时清零；不加锁，也不对共享缓存行做原子读-改-写
+// 写者摘下节点后调用 retire_epoch() 推进全局 epoch 并记下旧值 r，
+// 之后所有活跃槽都为 0 或大于 r 时，不可能还有读者持有这个节点，可以释放
+class EpochDomain {
+public:
+    static constexpr size_t kMaxThreads = 128;
+
+    static EpochDomain& instance() {
+        static EpochDomain domain;
+        return domain;
+    }
+
+    // 可以嵌套，只有最外层真正登记
+    void enter() {
+        ThreadState& ts = thread_state();
+        if (ts.depth++ != 0)
+            return;
+        Slot& slot = slots[ts.index];
+        uint64_t e = global_epoch.load(std::memory_order_relaxed);
+        for (;;) {
+            slot.epoch.store(e, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            // 登记之后全局 epoch 没变，写者扫描槽时一定能看到这次登记
+            uint64_t now = global_epoch.load(std::memory_order_relaxed);
+            if (now == e)
+                break;
+            e = now;
+        }
+    }
+
+    void exit() {
+        ThreadState& ts = thread_state();
+        if (--ts.depth == 0)
+            slots[ts.index].epoch.store(0, std::memory_order_release);
+    }
+
+    // 写者在摘下节点之后调用，返回的 epoch 作为节点的退休时间
+    uint64_t retire_epoch() {
+        return global_epoch.fetch_add(1, std::memory_order_seq_cst);
+    }
+
+    // 退休时间小于返回值的节点都可以释放
+    uint64_t safe_epoch() const {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        uint64_t min = UINT64_MAX;
+        for (size_t i = 0; i < kMaxThreads; ++i) {
+            uint64_t e = slots[i].epoch.load(std::memory_order_acquire);
+            if (e != 0 && e < min)
+                min = e;
+        }
+        return min;
+    }
+
+private:
+    // 每个槽独占一条缓存行，读者之间互不干扰
+    struct alignas(64) Slot {
+        std::atomic<uint64_t> epoch{0};
+        std::atomic<bool> owned{false};
+    };
+
+    // 线程第一次进入时认领一个槽，线程退出时归还
+    struct ThreadState {
+        EpochDomain* domain;
+        size_t index;
+        int depth;
+
+        explicit ThreadState(EpochDomain* d) : domain(d), index(d->claim_slot()), depth(0) {}
+        ~ThreadState() { domain->slots[index].owned.store(false, std::memory_order_release); }
+    };
+
+    EpochDomain() = default;
+    EpochDomain(const EpochDomain&) = delete;
+    EpochDomain& operator=(const EpochDomain&) = delete;
+
+    ThreadState& thread_state() {
+        thread_local ThreadState ts(this);
+        return ts;
+    }
+
+    // 同时登记的线程超过 kMaxThreads 时等待其他线程退出
+    size_t claim_slot() {
+        for (;;) {
+            for (size_t i = 0; i < kMaxThreads; ++i) {
+                bool expected = false;
+                if (!slots[i].owned.load(std::memory_order_relaxed) &&
+                    slots[i].owned.compare_exchange_strong(expected, true, std::memory_order_acquire))
+                    return i;
+            }
+            std::this_thread::yield();
+        }
+    }
+
+    alignas(64) std::atomic<uint64_t> global_epoch{1};
+    Slot slots[kMaxThreads];
+};
+
+// 读者临界区：存活期间读到的节点都不会被释放
+class EpochGuard {
+public:
+    EpochGuard() { EpochDomain::instance().enter(); }
+    ~EpochGuard() { EpochDomain::instance().exit(); }
+
+    EpochGuard(const EpochGuard&) = delete;
+    EpochGuard& operator=(const EpochGuard&) = delete;
+};
+
+}  // namespace mstl
+
+#endif  // __MSGI_STL_INTERNAL_EPOCH_H
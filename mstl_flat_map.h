@@ -0,0 +1,292 @@
+#ifndef __MSGI_STL_INTERNAL_FLAT_MAP_H
+#define __MSGI_STL_INTERNAL_FLAT_MAP_H
+
+#include "mstl_functional.h"
+#include "mstl_alloc.h"
+#include "mstl_flat_tree.h"
+#include "mstl_pair.h"
+
+#include <algorithm>
+#include <concepts>
+#include <stdexcept>
+#include <tuple>
+namespace mstl {
+    // 以有序 Vector 为底层的映射
+    // 元素要在数组中搬动，值类型是 Pair<Key, T> 而不是 Pair<const Key, T>：不要通过迭代器修改键
+    // 单个插入/删除为 O(n)，并且会使迭代器失效
+    template <typename Key, typename T, typename Compare = Less<Key>, typename Alloc = alloc>
+    requires std::strict_weak_order<Compare, Key, Key>
+    class FlatMap {
+    public:
+        using KeyType = Key;
+        using MappedType = T;
+        using ValueType = Pair<Key, T>;
+        using KeyCompare = Compare;
+        using AllocatorType = Alloc;
+
+    private:
+        using RepType = FlatTree<KeyType, ValueType, Select1st<ValueType>, Compare, Alloc>;
+
+        RepType t;
+    public:
+        using Pointer = typename RepType::Pointer;
+        using ConstPointer = typename RepType::ConstPointer;
+        using Reference = typename RepType::Reference;
+        using ConstReference = typename RepType::ConstReference;
+        using Iterator = typename RepType::Iterator;
+        using ConstIterator = typename RepType::ConstIterator;
+        using ReverseIterator = typename RepType::ReverseIterator;
+        using ConstReverseIterator = typename RepType::ConstReverseIterator;
+
+        using SizeType = size_t;
+        using DifferenceType = typename RepType::DifferenceType;
+
+        FlatMap() : t(Compare()) {}
+        explicit FlatMap(const Compare& comp, const Alloc& a = Alloc()) : t(comp, a) {}
+        explicit FlatMap(const Alloc& a) : t(Compare(), a) {}
+        FlatMap(const FlatMap& x) : t(x.t) {}
+        FlatMap(FlatMap&& x) : t(std::move(x.t)) {}
+
+        template <typename InputIterator>
+        FlatMap(InputIterator first, InputIterator last) : t(Compare()) {
+            t.insert_unique(first, last);
+        }
+
+        template <typename InputIterator>
+        FlatMap(SortedUniqueT, InputIterator first, InputIterator last, const Compare& comp = Compare(),
+                const Alloc& a = Alloc())
+            : t(comp, a) {
+            t.insert_unique(kSortedUnique, first, last);
+        }
+
+        FlatMap& operator=(const FlatMap& x) {
+            t = x.t;
+            return *this;
+        }
+
+        FlatMap& operator=(FlatMap&& x) {
+            t = std::move(x.t);
+            return *this;
+        }
+
+        KeyCompare key_comp() const {
+            return t.key_comp();
+        }
+
+        AllocatorType get_allocator() const {
+            return t.get_allocator();
+        }
+
+        Iterator begin() {
+            return t.begin();
+        }
+
+        Iterator end() {
+            return t.end();
+        }
+
+        ConstIterator begin() const {
+            return t.begin();
+        }
+
+        ConstIterator end() const {
+            return t.end();
+        }
+
+        ReverseIterator rbegin() {
+            return t.rbegin();
+        }
+
+        ReverseIterator rend() {
+            return t.rend();
+        }
+
+        ConstReverseIterator rbegin() const {
+            return t.rbegin();
+        }
+
+        ConstReverseIterator rend() const {
+            return t.rend();
+        }
+
+        bool empty() const {
+            return t.empty();
+        }
+
+        SizeType size() const {
+            return t.size();
+        }
+
+        SizeType max_size() const {
+            return t.max_size();
+        }
+
+        SizeType capacity() const {
+            return t.capacity();
+        }
+
+        void reserve(SizeType n) {
+            t.reserve(n);
+        }
+
+        void swap(FlatMap& x) {
+            t.swap(x.t);
+        }
+
+        // 键不存在时插入默认构造的 T
+        T& operator[](const Key& k) {
+            return try_emplace(k).first->second;
+        }
+
+        // 键不存在时从 k 移动构造新节点的键
+        T& operator[](Key&& k) {
+            return try_emplace(std::move(k)).first->second;
+        }
+
+        T& at(const Key& k) {
+            Iterator it = t.find(k);
+            if (it == t.end())
+                throw std::out_of_range("mstl::FlatMap::at");
+            return it->second;
+        }
+
+        const T& at(const Key& k) const {
+            ConstIterator it = t.find(k);
+            if (it == t.end())
+                throw std::out_of_range("mstl::FlatMap::at");
+            return it->second;
+        }
+
+        Pair<Iterator, bool> insert(const ValueType& x) {
+            return t.insert_unique(x);
+        }
+
+        Pair<Iterator, bool> insert(ValueType&& x) {
+            return t.insert_unique(std::move(x));
+        }
+
+        // 追加、排序、归并一次完成；键重复时保留先出现的
+        template <typename InputIterator>
+        void insert(InputIterator first, InputIterator last) {
+            t.insert_unique(first, last);
+        }
+
+        template <typename... Args>
+        Pair<Iterator, bool> emplace(Args&&... args) {
+            return t.emplace_unique(std::forward<Args>(args)...);
+        }
+
+        // 键已存在时什么都不做，不会用 args 构造 T
+        template <typename... Args>
+        Pair<Iterator, bool> try_emplace(const Key& k, Args&&... args) {
+            return t.emplace_unique_key(k, kPiecewiseConstruct, std::forward_as_tuple(k),
+                                        std::forward_as_tuple(std::forward<Args>(args)...));
+        }
+
+        // 先用 k 查找，确定要插入时才移走 k；键已存在时 k 保持原样
+        template <typename... Args>
+        Pair<Iterator, bool> try_emplace(Key&& k, Args&&... args) {
+            return t.emplace_unique_key(k, kPiecewiseConstruct, std::forward_as_tuple(std::move(k)),
+                                        std::forward_as_tuple(std::forward<Args>(args)...));
+        }
+
+        template <typename M>
+        Pair<Iterator, bool> insert_or_assign(const Key& k, M&& obj) {
+            Pair<Iterator, bool> res = t.emplace_unique_key(k, k, std::forward<M>(obj));
+            if (!res.second)
+                res.first->second = std::forward<M>(obj);
+            return res;
+        }
+
+        template <typename M>
+        Pair<Iterator, bool> insert_or_assign(Key&& k, M&& obj) {
+            Pair<Iterator, bool> res = t.emplace_unique_key(k, std::move(k), std::forward<M>(obj));
+            if (!res.second)
+                res.first->second = std::forward<M>(obj);
+            return res;
+        }
+
+        Iterator erase(ConstIterator position) {
+            return t.erase(position);
+        }
+
+        Iterator erase(ConstIterator first, ConstIterator last) {
+            return t.erase(first, last);
+        }
+
+        SizeType erase(const Key& x) {
+            return t.erase(x);
+        }
+
+        void clear() {
+            t.clear();
+        }
+
+        Iterator find(const Key& x) {
+            return t.find(x);
+        }
+
+        ConstIterator find(const Key& x) const {
+            return t.find(x);
+        }
+
+        SizeType count(const Key& x) const {
+            return t.count(x);
+        }
+
+        bool contains(const Key& x) const {
+            return t.count(x) != 0;
+        }
+
+        Iterator lower_bound(const Key& x) {
+            return t.lower_bound(x);
+        }
+
+        ConstIterator lower_bound(const Key& x) const {
+            return t.lower_bound(x);
+        }
+
+        Iterator upper_bound(const Key& x) {
+            return t.upper_bound(x);
+        }
+
+        ConstIterator upper_bound(const Key& x) const {
+            return t.upper_bound(x);
+        }
+
+        Pair<Iterator, Iterator> equal_range(const Key& x) {
+            return t.equal_range(x);
+        }
+
+        Pair<ConstIterator, ConstIterator> equal_range(const Key& x) const {
+            return t.equal_range(x);
+        }
+
+        template <typename K>
+            requires TransparentCompare<Compare>
+        Iterator find(const K& x) {
+            return t.find(x);
+        }
+
+        template <typename K>
+            requires TransparentCompare<Compare>
+        ConstIterator find(const K& x) const {
+            return t.find(x);
+        }
+
+        template <typename K>
+            requires TransparentCompare<Compare>
+        bool contains(const K& x) const {
+            return t.count(x) != 0;
+        }
+
+        friend bool operator==(const FlatMap& x, const FlatMap& y) {
+            return x.size() == y.size() && std::equal(x.begin(), x.end(), y.begin());
+        }
+        friend bool operator!=(const FlatMap& x, const FlatMap& y) {
+            return !(x == y);
+        }
+    };
+}
+
+#endif // __MSGI_STL_INTERNAL_FLAT_MAP_H
@@ -0,0 +1,228 @@
+#ifndef __MSGI_STL_INTERNAL_FLAT_SET_H
+#define __MSGI_STL_INTERNAL_FLAT_SET_H
+
+#include "mstl_functional.h"
+#include "mstl_alloc.h"
+#include "mstl_flat_tree.h"
+#include "mstl_pair.h"
+
+#include <algorithm>
+#include <concepts>
+namespace mstl {
+    // 以有序 Vector 为底层的 Set：接口与 Set 相同，查找与遍历都在连续内存上进行
+    // 与 Set 不同，单个插入/删除为 O(n)，并且会使迭代器失效
+    template <typename Key, typename Compare = Less<Key>, typename Alloc = alloc>
+    requires (std::equality_comparable<Key> && std::strict_weak_order<Compare, Key, Key>)
+    class FlatSet {
+    public:
+        using KeyType = Key;
+        using ValueType = Key;
+        using KeyCompare = Compare;
+        using ValueCompare = Compare;
+        using AllocatorType = Alloc;
+
+    private:
+        using RepType = FlatTree<KeyType, ValueType, Identity<Key>, Compare, Alloc>;
+
+        RepType t;
+    public:
+        using Pointer = typename RepType::ConstPointer;
+        using ConstPointer = typename RepType::ConstPointer;
+        using Reference = typename RepType::ConstReference;
+        using ConstReference = typename RepType::ConstReference;
+        using Iterator = typename RepType::ConstIterator;
+        using ConstIterator = typename RepType::ConstIterator;
+        using ReverseIterator = typename RepType::ConstReverseIterator;
+        using ConstReverseIterator = typename RepType::ConstReverseIterator;
+
+        using SizeType = size_t;
+        using DifferenceType = typename RepType::DifferenceType;
+
+        FlatSet() : t(Compare()) {}
+        explicit FlatSet(const Compare& comp, const Alloc& a = Alloc()) : t(comp, a) {}
+        explicit FlatSet(const Alloc& a) : t(Compare(), a) {}
+        FlatSet(const FlatSet& x) : t(x.t) {}
+        FlatSet(FlatSet&& x) : t(std::move(x.t)) {}
+
+        template <typename InputIterator>
+        FlatSet(InputIterator first, InputIterator last) : t(Compare()) {
+            t.insert_unique(first, last);
+        }
+
+        // 调用者保证 [first, last) 严格递增，直接追加
+        template <typename InputIterator>
+        FlatSet(SortedUniqueT, InputIterator first, InputIterator last, const Compare& comp = Compare(),
+                const Alloc& a = Alloc())
+            : t(comp, a) {
+            t.insert_unique(kSortedUnique, first, last);
+        }
+
+        FlatSet& operator=(const FlatSet& x) {
+            t = x.t;
+            return *this;
+        }
+
+        FlatSet& operator=(FlatSet&& x) {
+            t = std::move(x.t);
+            return *this;
+        }
+
+        KeyCompare key_comp() const {
+            return t.key_comp();
+        }
+
+        ValueCompare value_comp() const {
+            return t.key_comp();
+        }
+
+        AllocatorType get_allocator() const {
+            return t.get_allocator();
+        }
+
+        Iterator begin() const {
+            return t.begin();
+        }
+
+        Iterator end() const {
+            return t.end();
+        }
+
+        ReverseIterator rbegin() const {
+            return t.rbegin();
+        }
+
+        ReverseIterator rend() const {
+            return t.rend();
+        }
+
+        bool empty() const {
+            return t.empty();
+        }
+
+        SizeType size() const {
+            return t.size();
+        }
+
+        SizeType max_size() const {
+            return t.max_size();
+        }
+
+        SizeType capacity() const {
+            return t.capacity();
+        }
+
+        void reserve(SizeType n) {
+            t.reserve(n);
+        }
+
+        void swap(FlatSet& x) {
+            t.swap(x.t);
+        }
+
+        using PairIteratorBool = Pair<Iterator, bool>;
+
+        PairIteratorBool insert(const ValueType& x) {
+            auto p = t.insert_unique(x);
+            return PairIteratorBool(p.first, p.second);
+        }
+
+        PairIteratorBool insert(ValueType&& x) {
+            auto p = t.insert_unique(std::move(x));
+            return PairIteratorBool(p.first, p.second);
+        }
+
+        // 追加、排序、归并一次完成，比逐个插入快得多
+        template <typename InputIterator>
+        void insert(InputIterator first, InputIterator last) {
+            t.insert_unique(first, last);
+        }
+
+        template <typename... Args>
+        PairIteratorBool emplace(Args&&... args) {
+            auto p = t.emplace_unique(std::forward<Args>(args)...);
+            return PairIteratorBool(p.first, p.second);
+        }
+
+        Iterator erase(ConstIterator position) {
+            return t.erase(position);
+        }
+
+        Iterator erase(ConstIterator first, ConstIterator last) {
+            return t.erase(first, last);
+        }
+
+        SizeType erase(const Key& x) {
+            return t.erase(x);
+        }
+
+        void clear() {
+            t.clear();
+        }
+
+        Iterator find(const Key& x) const {
+            return t.find(x);
+        }
+
+        SizeType count(const Key& x) const {
+            return t.count(x);
+        }
+
+        bool contains(const Key& x) const {
+            return t.count(x) != 0;
+        }
+
+        Iterator lower_bound(const Key& x) const {
+            return t.lower_bound(x);
+        }
+
+        Iterator upper_bound(const Key& x) const {
+            return t.upper_bound(x);
+        }
+
+        Pair<ConstIterator, ConstIterator> equal_range(const Key& x) const {
+            return t.equal_range(x);
+        }
+
+        template <typename K>
+            requires TransparentCompare<Compare>
+        Iterator find(const K& x) const {
+            return t.find(x);
+        }
+
+        template <typename K>
+            requires TransparentCompare<Compare>
+        SizeType count(const K& x) const {
+            return t.count(x);
+        }
+
+        template <typename K>
+            requires TransparentCompare<Compare>
+        bool contains(const K& x) const {
+            return t.count(x) != 0;
+        }
+
+        template <typename K>
+            requires TransparentCompare<Compare>
+        Iterator lower_bound(const K& x) const {
+            return t.lower_bound(x);
+        }
+
+        template <typename K>
+            requires TransparentCompare<Compare>
+        Iterator upper_bound(const K& x) const {
+            return t.upper_bound(x);
+        }
+
+        friend bool operator==(const FlatSet& x, const FlatSet& y) {
+            return x.size() == y.size() && std::equal(x.begin(), x.end(), y.begin());
+        }
+        friend bool operator!=(const FlatSet& x, const FlatSet& y) {
+            return !(x == y);
+        }
+        friend bool operator<(const FlatSet& x, const FlatSet& y) {
+            return std::lexicographical_compare(x.begin(), x.end(), y.begin(), y.end());
+        }
+    };
+}
+
+#endif // __MSGI_STL_INTERNAL_FLAT_SET_H
@@ -0,0 +1,240 @@
+#ifndef __MSGI_STL_INTERNAL_FLAT_TREE_H
+#define __MSGI_STL_INTERNAL_FLAT_TREE_H
+
+#include <algorithm>
+#include <cstddef>
+#include "mstl_alloc.h"
+#include "mstl_concepts.h"
+#include "mstl_iterator.h"
+#include "mstl_pair.h"
+#include "mstl_tree.h"
+#include "mstl_vector.h"
+
+namespace mstl {
+
+// 有序连续数组上的唯一键集合：元素按键递增存放在一个 Vector 中
+// 查找是对连续内存的二分，比沿指针走红黑树少得多的 cache miss；
+// 单个插入/删除要搬动后面的元素，为 O(n)，适合元素不多或读远多于写的场景
+// 任何插入/删除都会使迭代器失效
+template <typename Key, typename Value, typename KeyOfValue, typename Compare, typename Alloc = alloc>
+class FlatTree {
+public:
+    using KeyType = Key;
+    using ValueType = Value;
+    using Pointer = Value*;
+    using ConstPointer = const Value*;
+    using Reference = Value&;
+    using ConstReference = const Value&;
+    using Iterator = Value*;
+    using ConstIterator = const Value*;
+    using ReverseIterator = mstl::ReverseIterator<Iterator>;
+    using ConstReverseIterator = mstl::ReverseIterator<ConstIterator>;
+    using SizeType = size_t;
+    using DifferenceType = ptrdiff_t;
+    using AllocatorType = Alloc;
+
+private:
+    using Container = Vector<Value, Alloc>;
+
+    Container c;
+    Compare key_compare;
+
+    static decltype(auto) key(const Value& v) { return KeyOfValue()(v); }
+
+public:
+    explicit FlatTree(const Compare& comp = Compare(), const Alloc& a = Alloc()) : c(a), key_compare(comp) {}
+
+    FlatTree(const FlatTree& x) : c(x.c.begin(), x.c.end(), x.c.get_allocator()), key_compare(x.key_compare) {}
+
+    FlatTree(FlatTree&& x) : c(x.c.get_allocator()), key_compare(x.key_compare) { c.swap(x.c); }
+
+    FlatTree& operator=(const FlatTree& x) {
+        if (this != &x) {
+            FlatTree tmp(x);
+            swap(tmp);
+        }
+        return *this;
+    }
+
+    FlatTree& operator=(FlatTree&& x) {
+        swap(x);
+        return *this;
+    }
+
+    Compare key_comp() const { return key_compare; }
+    AllocatorType get_allocator() const { return c.get_allocator(); }
+
+    Iterator begin() { return c.begin(); }
+    Iterator end() { return c.end(); }
+    ConstIterator begin() const { return c.begin(); }
+    ConstIterator end() const { return c.end(); }
+    ReverseIterator rbegin() { return ReverseIterator(end()); }
+    ReverseIterator rend() { return ReverseIterator(begin()); }
+    ConstReverseIterator rbegin() const { return ConstReverseIterator(end()); }
+    ConstReverseIterator rend() const { return ConstReverseIterator(begin()); }
+
+    bool empty() const { return c.empty(); }
+    SizeType size() const { return c.size(); }
+    SizeType max_size() const { return SizeType(-1) / sizeof(Value); }
+    SizeType capacity() const { return c.capacity(); }
+    void reserve(SizeType n) { c.reserve(n); }
+
+    void swap(FlatTree& x) {
+        c.swap(x.c);
+        std::swap(key_compare, x.key_compare);
+    }
+
+    void clear() { c.clear(); }
+
+    Pair<Iterator, bool> insert_unique(const Value& v) { return insert_unique_aux(v); }
+    Pair<Iterator, bool> insert_unique(Value&& v) { return insert_unique_aux(std::move(v)); }
+
+    template <typename... Args>
+    Pair<Iterator, bool> emplace_unique(Args&&... args) {
+        return insert_unique_aux(Value(std::forward<Args>(args)...));
+    }
+
+    // 调用者已经知道新值的键为 k：键已存在时不构造任何值
+    template <typename... Args>
+    Pair<Iterator, bool> emplace_unique_key(const Key& k, Args&&... args) {
+        SizeType i = lower_bound(k) - begin();
+        if (i != size() && !key_compare(k, key(c[i])))
+            return Pair<Iterator, bool>(begin() + i, false);
+        c.emplace_back(std::forward<Args>(args)...);
+        std::rotate(begin() + i, end() - 1, end());
+        return Pair<Iterator, bool>(begin() + i, true);
+    }
+
+    // 先把新元素全部追加到末尾，对这一段稳定排序，再与原有部分归并，最后一次去重：
+    // O(m log m + n)，而不是 m 次 O(n) 的插入；键重复时保留先出现的 (原有的优先)
+    template <typename InputIterator>
+    void insert_unique(InputIterator first, InputIterator last) {
+        SizeType old_size = size();
+        for (; first != last; ++first)
+            c.push_back(*first);
+        auto comp = value_compare();
+        std::stable_sort(begin() + old_size, end(), comp);
+        std::inplace_merge(begin(), begin() + old_size, end(), comp);
+        c.erase(std::unique(begin(), end(), [&](const Value& x, const Value& y) { return !comp(x, y); }),
+                end());
+    }
+
+    // 调用者保证 [first, last) 严格递增：空容器时直接追加
+    template <typename InputIterator>
+    void insert_unique(SortedUniqueT, InputIterator first, InputIterator last) {
+        if (!empty()) {
+            insert_unique(first, last);
+            return;
+        }
+        for (; first != last; ++first)
+            c.push_back(*first);
+    }
+
+    Iterator erase(ConstIterator position) { return c.erase(begin() + (position - begin())); }
+
+    Iterator erase(ConstIterator first, ConstIterator last) {
+        return c.erase(begin() + (first - begin()), begin() + (last - begin()));
+    }
+
+    SizeType erase(const Key& k) {
+        Iterator it = find(k);
+        if (it == end())
+            return 0;
+        erase(it);
+        return 1;
+    }
+
+    Iterator find(const Key& k) { return find_aux(k); }
+    ConstIterator find(const Key& k) const { return find_aux(k); }
+    SizeType count(const Key& k) const { return find_aux(k) != end() ? 1 : 0; }
+
+    Iterator lower_bound(const Key& k) { return begin() + (lower_bound_aux(k) - c.begin()); }
+    ConstIterator lower_bound(const Key& k) const { return lower_bound_aux(k); }
+    Iterator upper_bound(const Key& k) { return begin() + (upper_bound_aux(k) - c.begin()); }
+    ConstIterator upper_bound(const Key& k) const { return upper_bound_aux(k); }
+
+    Pair<Iterator, Iterator> equal_range(const Key& k) {
+        return Pair<Iterator, Iterator>(lower_bound(k), upper_bound(k));
+    }
+
+    Pair<ConstIterator, ConstIterator> equal_range(const Key& k) const {
+        return Pair<ConstIterator, ConstIterator>(lower_bound(k), upper_bound(k));
+    }
+
+    template <typename K>
+        requires TransparentCompare<Compare>
+    Iterator find(const K& k) { return find_aux(k); }
+
+    template <typename K>
+        requires TransparentCompare<Compare>
+    ConstIterator find(const K& k) const { return find_aux(k); }
+
+    template <typename K>
+        requires TransparentCompare<Compare>
+    SizeType count(const K& k) const { return find_aux(k) != end() ? 1 : 0; }
+
+    template <typename K>
+        requires TransparentCompare<Compare>
+    ConstIterator lower_bound(const K& k) const { return lower_bound_aux(k); }
+
+    template <typename K>
+        requires TransparentCompare<Compare>
+    ConstIterator upper_bound(const K& k) const { return upper_bound_aux(k); }
+
+private:
+    auto value_compare() const {
+        return [this](const Value& x, const Value& y) { return key_compare(key(x), key(y)); };
+    }
+
+    template <typename V>
+    Pair<Iterator, bool> insert_unique_aux(V&& v) {
+        SizeType i = lower_bound(key(v)) - begin();
+        if (i != size() && !key_compare(key(v), key(c[i])))
+            return Pair<Iterator, bool>(begin() + i, false);
+        c.push_back(std::forward<V>(v));
+        std::rotate(begin() + i, end() - 1, end());
+        return Pair<Iterator, bool>(begin() + i, true);
+    }
+
+    // 无分支二分：每轮只根据一次比较决定 base 是否前进 half，
+    // 编译成条件传送而不是跳转，不受分支预测失败的影响，循环次数只取决于元素个数
+    template <typename K>
+    ConstIterator lower_bound_aux(const K& k) const {
+        ConstIterator base = c.begin();
+        SizeType n = c.size();
+        if (n == 0)
+            return base;
+        while (n > 1) {
+            SizeType half = n / 2;
+            base = key_compare(key(base[half - 1]), k) ? base + half : base;
+            n -= half;
+        }
+        return base + key_compare(key(*base), k);
+    }
+
+    template <typename K>
+    ConstIterator upper_bound_aux(const K& k) const {
+        ConstIterator base = c.begin();
+        SizeType n = c.size();
+        if (n == 0)
+            return base;
+        while (n > 1) {
+            SizeType half = n / 2;
+            base = !key_compare(k, key(base[half - 1])) ? base + half : base;
+            n -= half;
+        }
+        return base + !key_compare(k, key(*base));
+    }
+
+    template <typename K>
+    Iterator find_aux(const K& k) const {
+        ConstIterator it = lower_bound_aux(k);
+        if (it == c.end() || key_compare(k, key(*it)))
+            return const_cast<Iterator>(c.end());
+        return const_cast<Iterator>(it);
+    }
+};
+
+}  // namespace mstl
+
+#endif  // __MSGI_STL_INTERNAL_FLAT_TREE_H
@@ -0,0 +1,237 @@
+#include "mstl_flat_tree.h"
+#include <algorithm>
+#include <cassert>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <random>
+#include <set>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "mstl_flat_map.h"
+#include "mstl_flat_set.h"
+#include "mstl_set.h"
+
+using namespace mstl;
+
+void test_basic_operations() {
+    std::cout << "\n=== FlatSet 基本操作测试 ===" << std::endl;
+    FlatSet<int> s;
+    assert(s.empty() && s.begin() == s.end());
+    assert(s.lower_bound(1) == s.end() && s.find(1) == s.end());
+
+    for (int i = 10; i > 0; --i)
+        assert(s.insert(i * 2).second);
+    assert(!s.insert(4).second && s.size() == 10);
+    assert(*s.begin() == 2 && *s.rbegin() == 20);
+    assert(*s.find(8) == 8 && s.find(9) == s.end());
+    assert(*s.lower_bound(9) == 10 && *s.upper_bound(10) == 12);
+    assert(s.lower_bound(21) == s.end() && *s.lower_bound(-5) == 2);
+    assert(s.count(12) == 1 && s.contains(12) && !s.contains(13));
+
+    // erase 返回下一个元素
+    assert(*s.erase(s.find(10)) == 12);
+    assert(s.erase(12) == 1 && s.erase(12) == 0 && s.size() == 8);
+    s.erase(s.begin(), s.lower_bound(8));
+    assert(*s.begin() == 8 && s.size() == 5);
+
+    FlatSet<int> copy(s);
+    assert(copy == s);
+    copy.insert(100);
+    assert(copy != s && s < copy);
+    FlatSet<int> moved(std::move(copy));
+    assert(moved.size() == 6 && copy.empty());
+    copy = moved;
+    assert(copy == moved);
+    std::cout << "基本操作测试通过!" << std::endl;
+}
+
+// 与 std::set 对照：单个插入/删除与区间插入混合
+void test_random_against_std() {
+    std::cout << "\n=== FlatSet 随机测试 ===" << std::endl;
+    std::mt19937 rng(41);
+    FlatSet<int> s;
+    std::set<int> ref;
+    for (int round = 0; round < 200; ++round) {
+        switch (rng() % 3) {
+        case 0: {
+            std::vector<int> batch(rng() % 50);
+            for (int& x : batch)
+                x = static_cast<int>(rng() % 1000);
+            s.insert(batch.begin(), batch.end());
+            ref.insert(batch.begin(), batch.end());
+            break;
+        }
+        case 1:
+            for (int i = 0; i < 10; ++i) {
+                int k = static_cast<int>(rng() % 1000);
+                assert(s.insert(k).second == ref.insert(k).second);
+            }
+            break;
+        default:
+            for (int i = 0; i < 10; ++i) {
+                int k = static_cast<int>(rng() % 1000);
+                assert(s.erase(k) == ref.erase(k));
+            }
+        }
+        assert(s.size() == ref.size() && std::equal(s.begin(), s.end(), ref.begin()));
+    }
+    for (int k = -1; k <= 1001; ++k) {
+        auto lb = s.lower_bound(k);
+        auto ub = s.upper_bound(k);
+        assert(lb - s.begin() == std::distance(ref.begin(), ref.lower_bound(k)));
+        assert(ub - s.begin() == std::distance(ref.begin(), ref.upper_bound(k)));
+    }
+    std::cout << "随机测试通过!" << std::endl;
+}
+
+void test_flat_map() {
+    std::cout << "\n=== FlatMap 测试 ===" << std::endl;
+    FlatMap<std::string, int, Less<>> m;
+    m["beta"] = 2;
+    m["alpha"] = 1;
+    assert(m.try_emplace("gamma", 3).second && !m.try_emplace("gamma", 30).second);
+    assert(m["gamma"] == 3 && m.size() == 3);
+    assert(!m.insert_or_assign("alpha", 10).second && m.at("alpha") == 10);
+    assert(m.begin()->first == "alpha" && (m.end() - 1)->first == "gamma");
+    assert(m.find(std::string_view("beta"))->second == 2 && m.contains(std::string_view("gamma")));
+    bool thrown = false;
+    try {
+        m.at("delta");
+    } catch (const std::out_of_range&) {
+        thrown = true;
+    }
+    assert(thrown);
+
+    // 区间插入：键重复时保留先出现的，已有的键不被覆盖
+    std::vector<Pair<std::string, int>> batch = {{"delta", 4}, {"alpha", 100}, {"delta", 40}, {"epsilon", 5}};
+    m.insert(batch.begin(), batch.end());
+    assert(m.size() == 5 && m["alpha"] == 10 && m["delta"] == 4 && m["epsilon"] == 5);
+    assert(m.erase("beta") == 1 && m.size() == 4);
+
+    // 右值键插入时移动到元素中，键已存在时不会被移走
+    std::string key(64, 'k');
+    m[std::move(key)] = 6;
+    assert(key.empty() && m.size() == 5);
+    std::string again(64, 'k');
+    assert(!m.try_emplace(std::move(again), 60).second && again.size() == 64);
+    assert(!m.insert_or_assign(std::move(again), 7).second && again.size() == 64 && m[again] == 7);
+    std::string other(64, 'o');
+    assert(m.try_emplace(std::move(other), 8).second && other.empty() && m.size() == 6);
+    assert(m.erase(std::string(64, 'k')) == 1 && m.erase(std::string(64, 'o')) == 1);
+
+    std::map<int, int> ref;
+    FlatMap<int, int> fm;
+    std::mt19937 rng(43);
+    for (int i = 0; i < 5000; ++i) {
+        int k = static_cast<int>(rng() % 300);
+        if (rng() % 4 == 0) {
+            assert(fm.erase(k) == ref.erase(k));
+        } else {
+            fm[k] += i;
+            ref[k] += i;
+        }
+    }
+    assert(fm.size() == ref.size());
+    auto it = ref.begin();
+    for (const auto& kv : fm) {
+        assert(kv.first == it->first && kv.second == it->second);
+        ++it;
+    }
+
+    std::vector<Pair<int, int>> sorted;
+    for (int i = 0; i < 100; ++i)
+        sorted.emplace_back(i, i * i);
+    FlatMap<int, int> bulk(kSortedUnique, sorted.begin(), sorted.end());
+    assert(bulk.size() == 100 && bulk.at(9) == 81);
+    FlatMap<int, int> withAlloc(kSortedUnique, sorted.begin() + 50, sorted.end(), Less<int>(), alloc());
+    assert(withAlloc.size() == 50 && withAlloc.begin()->first == 50);
+    std::cout << "FlatMap 测试通过!" << std::endl;
+}
+
+// 不同规模下的随机查找：FlatSet (连续内存 + 无分支二分) vs Set (红黑树)
+void benchmark_lookup() {
+    std::cout << "\n=== FlatSet 与 Set 查找性能比较 (每组 500000 次 find) ===" << std::endl;
+    std::cout << std::setw(10) << "元素数" << std::setw(16) << "Set(ns/次)" << std::setw(16)
+              << "FlatSet(ns/次)" << std::endl;
+    const int lookups = 500000;
+
+    auto time = [](auto&& fn) {
+        auto start = std::chrono::high_resolution_clock::now();
+        fn();
+        auto end = std::chrono::high_resolution_clock::now();
+        return std::chrono::duration<double>(end - start).count();
+    };
+
+    for (int n : {16, 256, 4096, 65536, 1 << 20}) {
+        std::vector<int> keys(n);
+        for (int i = 0; i < n; ++i)
+            keys[i] = i * 2;
+        std::vector<int> probes(lookups);
+        std::mt19937 rng(n);
+        for (int& p : probes)
+            p = static_cast<int>(rng() % (2 * n));
+
+        Set<int> tree(kSortedUnique, keys.begin(), keys.end());
+        FlatSet<int> flat(kSortedUnique, keys.begin(), keys.end());
+
+        size_t found_tree = 0, found_flat = 0;
+        double tree_time = time([&]() {
+            for (int p : probes)
+                found_tree += tree.find(p) != tree.end();
+        });
+        double flat_time = time([&]() {
+            for (int p : probes)
+                found_flat += flat.find(p) != flat.end();
+        });
+        assert(found_tree == found_flat);
+
+        std::cout << std::setw(10) << n << std::fixed << std::setprecision(2) << std::setw(16)
+                  << tree_time * 1e9 / lookups << std::setw(16) << flat_time * 1e9 / lookups << std::endl;
+    }
+}
+
+// 一批无序的键并入已有集合：逐个插入 vs 追加-排序-归并
+void benchmark_bulk_insert() {
+    const int n = 100000, batch = 20000;
+    std::cout << "\n=== FlatSet 区间插入测试 (已有 " << n << " 个键, 并入 " << batch << " 个) ===" << std::endl;
+    std::vector<int> base(n), extra(batch);
+    for (int i = 0; i < n; ++i)
+        base[i] = i * 2;
+    std::mt19937 rng(47);
+    for (int& x : extra)
+        x = static_cast<int>(rng() % (4 * n));
+
+    auto time = [](auto&& fn) {
+        auto start = std::chrono::high_resolution_clock::now();
+        fn();
+        auto end = std::chrono::high_resolution_clock::now();
+        return std::chrono::duration<double>(end - start).count();
+    };
+
+    FlatSet<int> one_by_one(kSortedUnique, base.begin(), base.end());
+    FlatSet<int> merged(one_by_one);
+    double single = time([&]() {
+        for (int x : extra)
+            one_by_one.insert(x);
+    });
+    double bulk = time([&]() { merged.insert(extra.begin(), extra.end()); });
+    assert(one_by_one == merged);
+
+    std::cout << std::setw(16) << "逐个插入(秒)" << std::setw(16) << "区间插入(秒)" << std::endl;
+    std::cout << std::fixed << std::setprecision(6) << std::setw(16) << single << std::setw(16) << bulk
+              << std::endl;
+}
+
+int main() {
+    std::cout << "开始测试 mstl::FlatSet/FlatMap..." << std::endl;
+    test_basic_operations();
+    test_random_against_std();
+    test_flat_map();
+    benchmark_lookup();
+    benchmark_bulk_insert();
+    std::cout << "\n所有测试通过!" << std::endl;
+    return 0;
+}
@@ -4,7 +4,7 @@
 namespace mstl {
 
 // 基础函数对象
-template <typename T>
+template <typename T = void>
 struct Less {
     using FirstArgumentType = T;
     using SecondArgumentType = T;
@@ -15,6 +15,19 @@ struct Less {
     }
 };
 
+// 透明比较器：两个参数可以是不同类型 (例如 std::string 与 std::string_view)，
+// 关联容器用它做比较器时，find/lower_bound 等接受任何可与键比较的类型，不必先构造临时的键
+template <>
+struct Less<void> {
+    using IsTransparent = void;
+    using ResultType = bool;
+
+    template <typename T, typename U>
+    bool operator()(const T& x, const U& y) const {
+        return x < y;
+    }
+};
+
 template <typename T>
 struct Greater {
     using FirstArgumentType = T;
@@ -37,6 +50,17 @@ struct Identity {
     }
 };
 
+// 取出 Pair 的 first，作为 map 类容器的 KeyOfValue
+template <typename Pair>
+struct Select1st {
+    using ArgumentType = Pair;
+    using ResultType = typename Pair::FirstType;
+
+    const typename Pair::FirstType& operator()(const Pair& x) const {
+        return x.first;
+    }
+};
+
 }  // namespace mstl
 
 #endif  // __MSGI_STL_INTERNAL_FUNCTIONAL_H
\ No newline at end of file
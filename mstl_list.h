@@ -3,6 +3,7 @@
 
 #include <cstddef>
 #include <initializer_list>
+#include <utility>
 #include "mstl_alloc.h"
 #include "mstl_allocator.h"
 #include "mstl_iterator.h"
@@ -116,38 +117,66 @@ public:
 
     using Iterator = ListIterator<T, T&, T*>;
     using ConstIterator = ListIterator<T, const T&, const T*>;
+    using AllocatorType = Alloc;
 
     // 构造函数
     List() {
         createNode();
     }
-    List(SizeType n, const T& value = T()) {
+    explicit List(const Alloc& a) : kNodeAllocator(a) {
+        createNode();
+    }
+    List(SizeType n, const T& value = T(), const Alloc& a = Alloc()) : kNodeAllocator(a) {
         createNode();
         insert(begin(), n, value);
     }
-    List(const List& x) {
+    List(const List& x)
+        : kNodeAllocator(
+              AllocatorTraits<NodeAllocator>::select_on_container_copy_construction(x.kNodeAllocator)) {
         createNode();
         insert(begin(), x.begin(), x.end());
     }
 
-    List(List&& x) noexcept {
-        kNode = x.kNode;
-        x.kNode = nullptr;
+    // 被移动的 list 换上一个新的空哨兵节点，仍然可以继续使用
+    List(List&& x) : kNodeAllocator(x.kNodeAllocator) {
+        createNode();
+        std::swap(kNode, x.kNode);
     }
 
     List& operator=(const List& x) {
         if (this != &x) {
             clear();
+            if (AllocatorTraits<NodeAllocator>::PropagateOnContainerCopyAssignment::value &&
+                kNodeAllocator != x.kNodeAllocator) {
+                // 哨兵节点要用新的分配器重新分配
+                putNode(kNode);
+                propagateOnCopyAssignment(kNodeAllocator, x.kNodeAllocator);
+                createNode();
+            } else {
+                propagateOnCopyAssignment(kNodeAllocator, x.kNodeAllocator);
+            }
             insert(begin(), x.begin(), x.end());
         }
         return *this;
     }
 
-    List& operator=(List&& x) noexcept {
+    // 分配器相等或者随移动传播时直接接管 x 的节点，否则只能逐个移动元素
+    List& operator=(List&& x) {
         if (this != &x) {
             clear();
-            kNode = x.kNode;
-            x.kNode = nullptr;
+            if (kNodeAllocator == x.kNodeAllocator) {
+                propagateOnMoveAssignment(kNodeAllocator, x.kNodeAllocator);
+                std::swap(kNode, x.kNode);
+            } else if (AllocatorTraits<NodeAllocator>::PropagateOnContainerMoveAssignment::value) {
+                putNode(kNode);
+                propagateOnMoveAssignment(kNodeAllocator, x.kNodeAllocator);
+                createNode();
+                std::swap(kNode, x.kNode);
+            } else {
+                for (Iterator it = x.begin(); it != x.end(); ++it)
+                    push_back(std::move(*it));
+                x.clear();
+            }
         }
         return *this;
     }
@@ -158,7 +187,7 @@ public:
     }
 
     // 初始化列表构造函数
-    List(std::initializer_list<T> il) {
+    List(std::initializer_list<T> il, const Alloc& a = Alloc()) : kNodeAllocator(a) {
         createNode();
         for (const auto& x : il) {
             push_back(x);
@@ -179,6 +208,17 @@ public:
         return kNode;
     }
 
+    AllocatorType get_allocator() const {
+        return kNodeAllocator.rawAllocator();
+    }
+
+    // 交换两个 list 的内容；分配器只在 PropagateOnContainerSwap 时交换，
+    // 否则两个分配器必须相等
+    void swap(List& x) noexcept {
+        propagateOnSwap(kNodeAllocator, x.kNodeAllocator);
+        std::swap(kNode, x.kNode);
+    }
+
     // 容量相关
     bool empty() const {
         return kNode->next == kNode;
@@ -227,7 +267,12 @@ public:
     template <typename U>
     Iterator insert(Iterator position, U&& x) {
         Node* tmp = getNode();
-        tmp->data = std::forward<U>(x);
+        try {
+            construct(&tmp->data, std::forward<U>(x));
+        } catch (...) {
+            putNode(tmp);
+            throw;
+        }
 
         Node* node = position.kNode;
 
@@ -263,6 +308,7 @@ public:
         nextNode->prev = prevNode;
         prevNode->next = nextNode;
 
+        destroy(&node->data);
         putNode(node);
 
         return Iterator(nextNode);
@@ -339,9 +385,11 @@ public:
     }
 
 protected:
-    Node* kNode;
     using NodeAllocator = typename AllocatorTraits<SimpleAlloc<T, Alloc>>::template RebindAlloc<Node>;
 
+    [[no_unique_address]] NodeAllocator kNodeAllocator;
+    Node* kNode;
+
     void createNode() {
         kNode = getNode();
         kNode->next = kNode;
@@ -366,11 +414,11 @@ protected:
     }
 
     void putNode(Node* p) {
-        NodeAllocator::deallocate(p, 1);
+        kNodeAllocator.deallocate(p, 1);
     }
 
     Node* getNode() {
-        return NodeAllocator::allocate(1);
+        return kNodeAllocator.allocate(1);
     }
 };
 }  // namespace mstl
@@ -0,0 +1,579 @@
+#ifndef __MSGI_STL_INTERNAL_MAP_H
+#define __MSGI_STL_INTERNAL_MAP_H
+
+#include "mstl_functional.h"
+#include "mstl_alloc.h"
+#include "mstl_allocator.h"
+#include "mstl_tree.h"
+#include "mstl_pair.h"
+
+#include <algorithm>
+#include <concepts>
+#include <stdexcept>
+#include <tuple>
+namespace mstl {
+    // 以红黑树为底层的有序映射，值类型为 Pair<const Key, T>
+    template <typename Key, typename T, typename Compare = Less<Key>, typename Alloc = thread_safe_alloc>
+    requires std::strict_weak_order<Compare, Key, Key>
+    class Map {
+    public:
+        using KeyType = Key;
+        using MappedType = T;
+        using ValueType = Pair<const Key, T>;
+        using KeyCompare = Compare;
+        using AllocatorType = Alloc;
+
+        // 按键比较两个值
+        class ValueCompare {
+            friend class Map;
+        protected:
+            Compare comp;
+            ValueCompare(Compare c) : comp(c) {}
+        public:
+            bool operator()(const ValueType& x, const ValueType& y) const {
+                return comp(x.first, y.first);
+            }
+        };
+
+    private:
+        using RepType = RbTree<KeyType, ValueType, Select1st<ValueType>, Compare, Alloc>;
+
+        RepType t;
+    public:
+        using Pointer = typename RepType::Pointer;
+        using ConstPointer = typename RepType::ConstPointer;
+        using Reference = ValueType&;
+        using ConstReference = typename RepType::ConstReference;
+        using Iterator = typename RepType::Iterator;
+        using ConstIterator = typename RepType::ConstIterator;
+        using ReverseIterator = typename RepType::ReverseIterator;
+        using ConstReverseIterator = typename RepType::ConstReverseIterator;
+
+        using SizeType = size_t;
+        using DifferenceType = typename RepType::DifferenceType;
+
+        Map() : t(Compare()) {}
+        explicit Map(const Compare& comp, const Alloc& a = Alloc()) : t(comp, a) {}
+        explicit Map(const Alloc& a) : t(Compare(), a) {}
+        Map(const Map& x) : t(x.t) {}
+
+        // 输入已按键严格递增时线性建树
+        template <typename InputIterator>
+        Map(InputIterator first, InputIterator last) : t(Compare()) {
+            t.insert_unique(first, last);
+        }
+
+        // 调用者保证 [first, last) 按键严格递增，不再检查
+        template <typename InputIterator>
+        Map(SortedUniqueT, InputIterator first, InputIterator last, const Compare& comp = Compare(),
+            const Alloc& a = Alloc())
+            : t(comp, a) {
+            t.insert_unique(kSortedUnique, first, last);
+        }
+
+        Map& operator=(const Map& x) {
+            t = x.t;
+            return *this;
+        }
+
+        KeyCompare key_comp() const {
+            return t.key_comp();
+        }
+
+        ValueCompare value_comp() const {
+            return ValueCompare(t.key_comp());
+        }
+
+        AllocatorType get_allocator() const {
+            return t.get_allocator();
+        }
+
+        Iterator begin() {
+            return t.begin();
+        }
+
+        Iterator end() {
+            return t.end();
+        }
+
+        ConstIterator begin() const {
+            return t.begin();
+        }
+
+        ConstIterator end() const {
+            return t.end();
+        }
+
+        ReverseIterator rbegin() {
+            return t.rbegin();
+        }
+
+        ReverseIterator rend() {
+            return t.rend();
+        }
+
+        ConstReverseIterator rbegin() const {
+            return t.rbegin();
+        }
+
+        ConstReverseIterator rend() const {
+            return t.rend();
+        }
+
+        bool empty() const {
+            return t.empty();
+        }
+
+        SizeType size() const {
+            return t.size();
+        }
+
+        SizeType max_size() const {
+            return t.max_size();
+        }
+
+        void swap(Map& x) {
+            t.swap(x.t);
+        }
+
+        // 键不存在时插入默认构造的 T
+        T& operator[](const Key& k) {
+            return try_emplace(k).first->second;
+        }
+
+        // 键不存在时从 k 移动构造新节点的键
+        T& operator[](Key&& k) {
+            return try_emplace(std::move(k)).first->second;
+        }
+
+        T& at(const Key& k) {
+            Iterator it = t.find(k);
+            if (it == t.end())
+                throw std::out_of_range("mstl::Map::at");
+            return it->second;
+        }
+
+        const T& at(const Key& k) const {
+            ConstIterator it = t.find(k);
+            if (it == t.end())
+                throw std::out_of_range("mstl::Map::at");
+            return it->second;
+        }
+
+        Pair<Iterator, bool> insert(const ValueType& x) {
+            return t.insert_unique(x);
+        }
+
+        // position 是 x 插入后的下一个位置时均摊 O(1)，例如按键递增插入时用 end()
+        Iterator insert(ConstIterator position, const ValueType& x) {
+            return t.insert_unique(position, x);
+        }
+
+        template <typename InputIterator>
+        void insert(InputIterator first, InputIterator last) {
+            t.insert_unique(first, last);
+        }
+
+        template <typename... Args>
+        Pair<Iterator, bool> emplace(Args&&... args) {
+            return t.emplace_unique(std::forward<Args>(args)...);
+        }
+
+        // 键已存在时什么都不做，不会用 args 构造 T
+        template <typename... Args>
+        Pair<Iterator, bool> try_emplace(const Key& k, Args&&... args) {
+            return t.emplace_unique_key(k, kPiecewiseConstruct, std::forward_as_tuple(k),
+                                        std::forward_as_tuple(std::forward<Args>(args)...));
+        }
+
+        // 先用 k 查找，确定要插入时才移走 k；键已存在时 k 保持原样
+        template <typename... Args>
+        Pair<Iterator, bool> try_emplace(Key&& k, Args&&... args) {
+            return t.emplace_unique_key(k, kPiecewiseConstruct, std::forward_as_tuple(std::move(k)),
+                                        std::forward_as_tuple(std::forward<Args>(args)...));
+        }
+
+        // 键已存在时赋值给已有的 T，否则插入；返回值的 second 表示是否插入
+        template <typename M>
+        Pair<Iterator, bool> insert_or_assign(const Key& k, M&& obj) {
+            Pair<Iterator, bool> res = t.emplace_unique_key(k, k, std::forward<M>(obj));
+            if (!res.second)
+                res.first->second = std::forward<M>(obj);
+            return res;
+        }
+
+        template <typename M>
+        Pair<Iterator, bool> insert_or_assign(Key&& k, M&& obj) {
+            Pair<Iterator, bool> res = t.emplace_unique_key(k, std::move(k), std::forward<M>(obj));
+            if (!res.second)
+                res.first->second = std::forward<M>(obj);
+            return res;
+        }
+
+        void erase(Iterator position) {
+            t.erase(position);
+        }
+
+        void erase(Iterator first, Iterator last) {
+            t.erase(first, last);
+        }
+
+        SizeType erase(const Key& x) {
+            return t.erase(x);
+        }
+
+        void clear() {
+            t.clear();
+        }
+
+        Iterator find(const Key& x) {
+            return t.find(x);
+        }
+
+        ConstIterator find(const Key& x) const {
+            return t.find(x);
+        }
+
+        SizeType count(const Key& x) const {
+            return t.find(x) == t.end() ? 0 : 1;
+        }
+
+        bool contains(const Key& x) const {
+            return t.find(x) != t.end();
+        }
+
+        Iterator lower_bound(const Key& x) {
+            return t.lower_bound(x);
+        }
+
+        ConstIterator lower_bound(const Key& x) const {
+            return t.lower_bound(x);
+        }
+
+        Iterator upper_bound(const Key& x) {
+            return t.upper_bound(x);
+        }
+
+        ConstIterator upper_bound(const Key& x) const {
+            return t.upper_bound(x);
+        }
+
+        Pair<Iterator, Iterator> equal_range(const Key& x) {
+            return t.equal_range(x);
+        }
+
+        Pair<ConstIterator, ConstIterator> equal_range(const Key& x) const {
+            return t.equal_range(x);
+        }
+
+        // Compare 为透明比较器 (例如 Less<>) 时按任何可与 Key 比较的类型查找，
+        // 例如 Map<std::string, V, Less<>> 用 std::string_view 查找时不构造临时的 std::string
+        template <typename K>
+            requires TransparentCompare<Compare>
+        Iterator find(const K& x) {
+            return t.find(x);
+        }
+
+        template <typename K>
+            requires TransparentCompare<Compare>
+        ConstIterator find(const K& x) const {
+            return t.find(x);
+        }
+
+        template <typename K>
+            requires TransparentCompare<Compare>
+        SizeType count(const K& x) const {
+            return t.find(x) == t.end() ? 0 : 1;
+        }
+
+        template <typename K>
+            requires TransparentCompare<Compare>
+        bool contains(const K& x) const {
+            return t.find(x) != t.end();
+        }
+
+        template <typename K>
+            requires TransparentCompare<Compare>
+        Iterator lower_bound(const K& x) {
+            return t.lower_bound(x);
+        }
+
+        template <typename K>
+            requires TransparentCompare<Compare>
+        ConstIterator lower_bound(const K& x) const {
+            return t.lower_bound(x);
+        }
+
+        template <typename K>
+            requires TransparentCompare<Compare>
+        Iterator upper_bound(const K& x) {
+            return t.upper_bound(x);
+        }
+
+        template <typename K>
+            requires TransparentCompare<Compare>
+        ConstIterator upper_bound(const K& x) const {
+            return t.upper_bound(x);
+        }
+
+        template <typename K>
+            requires TransparentCompare<Compare>
+        Pair<Iterator, Iterator> equal_range(const K& x) {
+            return t.equal_range(x);
+        }
+
+        template <typename K>
+            requires TransparentCompare<Compare>
+        Pair<ConstIterator, ConstIterator> equal_range(const K& x) const {
+            return t.equal_range(x);
+        }
+
+        friend bool operator==(const Map& x, const Map& y) {
+            return x.size() == y.size() && std::equal(x.begin(), x.end(), y.begin());
+        }
+        friend bool operator!=(const Map& x, const Map& y) {
+            return !(x == y);
+        }
+    };
+
+    // 允许重复键的 Map，相等的键按插入顺序排列
+    template <typename Key, typename T, typename Compare = Less<Key>, typename Alloc = thread_safe_alloc>
+    requires std::strict_weak_order<Compare, Key, Key>
+    class Multimap {
+    public:
+        using KeyType = Key;
+        using MappedType = T;
+        using ValueType = Pair<const Key, T>;
+        using KeyCompare = Compare;
+        using AllocatorType = Alloc;
+
+    private:
+        using RepType = RbTree<KeyType, ValueType, Select1st<ValueType>, Compare, Alloc>;
+
+        RepType t;
+    public:
+        using Pointer = typename RepType::Pointer;
+        using ConstPointer = typename RepType::ConstPointer;
+        using Reference = ValueType&;
+        using ConstReference = typename RepType::ConstReference;
+        using Iterator = typename RepType::Iterator;
+        using ConstIterator = typename RepType::ConstIterator;
+        using ReverseIterator = typename RepType::ReverseIterator;
+        using ConstReverseIterator = typename RepType::ConstReverseIterator;
+
+        using SizeType = size_t;
+        using DifferenceType = typename RepType::DifferenceType;
+
+        Multimap() : t(Compare()) {}
+        explicit Multimap(const Compare& comp, const Alloc& a = Alloc()) : t(comp, a) {}
+        explicit Multimap(const Alloc& a) : t(Compare(), a) {}
+        Multimap(const Multimap& x) : t(x.t) {}
+
+        template <typename InputIterator>
+        Multimap(InputIterator first, InputIterator last) : t(Compare()) {
+            t.insert_equal(first, last);
+        }
+
+        // 调用者保证 [first, last) 按键非递减，不再检查
+        template <typename InputIterator>
+        Multimap(SortedEquivalentT, InputIterator first, InputIterator last,
+                 const Compare& comp = Compare(), const Alloc& a = Alloc())
+            : t(comp, a) {
+            t.insert_equal(kSortedEquivalent, first, last);
+        }
+
+        Multimap& operator=(const Multimap& x) {
+            t = x.t;
+            return *this;
+        }
+
+        KeyCompare key_comp() const {
+            return t.key_comp();
+        }
+
+        AllocatorType get_allocator() const {
+            return t.get_allocator();
+        }
+
+        Iterator begin() {
+            return t.begin();
+        }
+
+        Iterator end() {
+            return t.end();
+        }
+
+        ConstIterator begin() const {
+            return t.begin();
+        }
+
+        ConstIterator end() const {
+            return t.end();
+        }
+
+        ReverseIterator rbegin() {
+            return t.rbegin();
+        }
+
+        ReverseIterator rend() {
+            return t.rend();
+        }
+
+        ConstReverseIterator rbegin() const {
+            return t.rbegin();
+        }
+
+        ConstReverseIterator rend() const {
+            return t.rend();
+        }
+
+        bool empty() const {
+            return t.empty();
+        }
+
+        SizeType size() const {
+            return t.size();
+        }
+
+        SizeType max_size() const {
+            return t.max_size();
+        }
+
+        void swap(Multimap& x) {
+            t.swap(x.t);
+        }
+
+        Iterator insert(const ValueType& x) {
+            return t.insert_equal(x);
+        }
+
+        Iterator insert(ConstIterator position, const ValueType& x) {
+            return t.insert_equal(position, x);
+        }
+
+        template <typename InputIterator>
+        void insert(InputIterator first, InputIterator last) {
+            t.insert_equal(first, last);
+        }
+
+        template <typename... Args>
+        Iterator emplace(Args&&... args) {
+            return t.emplace_equal(std::forward<Args>(args)...);
+        }
+
+        void erase(Iterator position) {
+            t.erase(position);
+        }
+
+        void erase(Iterator first, Iterator last) {
+            t.erase(first, last);
+        }
+
+        SizeType erase(const Key& x) {
+            return t.erase(x);
+        }
+
+        void clear() {
+            t.clear();
+        }
+
+        Iterator find(const Key& x) {
+            return t.find(x);
+        }
+
+        ConstIterator find(const Key& x) const {
+            return t.find(x);
+        }
+
+        SizeType count(const Key& x) const {
+            return t.count(x);
+        }
+
+        Iterator lower_bound(const Key& x) {
+            return t.lower_bound(x);
+        }
+
+        ConstIterator lower_bound(const Key& x) const {
+            return t.lower_bound(x);
+        }
+
+        Iterator upper_bound(const Key& x) {
+            return t.upper_bound(x);
+        }
+
+        ConstIterator upper_bound(const Key& x) const {
+            return t.upper_bound(x);
+        }
+
+        Pair<Iterator, Iterator> equal_range(const Key& x) {
+            return t.equal_range(x);
+        }
+
+        Pair<ConstIterator, ConstIterator> equal_range(const Key& x) const {
+            return t.equal_range(x);
+        }
+
+        template <typename K>
+            requires TransparentCompare<Compare>
+        Iterator find(const K& x) {
+            return t.find(x);
+        }
+
+        template <typename K>
+            requires TransparentCompare<Compare>
+        ConstIterator find(const K& x) const {
+            return t.find(x);
+        }
+
+        template <typename K>
+            requires TransparentCompare<Compare>
+        SizeType count(const K& x) const {
+            return t.count(x);
+        }
+
+        template <typename K>
+            requires TransparentCompare<Compare>
+        Iterator lower_bound(const K& x) {
+            return t.lower_bound(x);
+        }
+
+        template <typename K>
+            requires TransparentCompare<Compare>
+        ConstIterator lower_bound(const K& x) const {
+            return t.lower_bound(x);
+        }
+
+        template <typename K>
+            requires TransparentCompare<Compare>
+        Iterator upper_bound(const K& x) {
+            return t.upper_bound(x);
+        }
+
+        template <typename K>
+            requires TransparentCompare<Compare>
+        ConstIterator upper_bound(const K& x) const {
+            return t.upper_bound(x);
+        }
+
+        template <typename K>
+            requires TransparentCompare<Compare>
+        Pair<Iterator, Iterator> equal_range(const K& x) {
+            return t.equal_range(x);
+        }
+
+        template <typename K>
+            requires TransparentCompare<Compare>
+        Pair<ConstIterator, ConstIterator> equal_range(const K& x) const {
+            return t.equal_range(x);
+        }
+
+        friend bool operator==(const Multimap& x, const Multimap& y) {
+            return x.size() == y.size() && std::equal(x.begin(), x.end(), y.begin());
+        }
+        friend bool operator!=(const Multimap& x, const Multimap& y) {
+            return !(x == y);
+        }
+    };
+}
+
+#endif // __MSGI_STL_INTERNAL_MAP_H
@@ -0,0 +1,273 @@
+#include "mstl_map.h"
+#include <algorithm>
+#include <cassert>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <random>
+#include <string>
+#include <string_view>
+#include <vector>
+
+using namespace mstl;
+
+// 记录构造次数的类型
+struct Counted {
+    static int constructed;
+    int value;
+
+    Counted() : value(0) { ++constructed; }
+    Counted(int v) : value(v) { ++constructed; }
+    Counted(const Counted& x) : value(x.value) { ++constructed; }
+    Counted& operator=(const Counted& x) {
+        value = x.value;
+        return *this;
+    }
+};
+int Counted::constructed = 0;
+
+// 只能从 string_view 显式构造的键，构造时计数，可以直接与 string_view 比较
+struct Name {
+    static int constructed;
+    std::string s;
+
+    explicit Name(std::string_view v) : s(v) { ++constructed; }
+    Name(const Name& x) : s(x.s) { ++constructed; }
+
+    friend bool operator<(const Name& x, const Name& y) { return x.s < y.s; }
+    friend bool operator<(const Name& x, std::string_view y) { return x.s < y; }
+    friend bool operator<(std::string_view x, const Name& y) { return x < y.s; }
+};
+int Name::constructed = 0;
+
+void test_basic_operations() {
+    std::cout << "\n=== Map 基本操作测试 ===" << std::endl;
+    Map<int, std::string> m;
+    assert(m.empty());
+
+    auto res = m.insert(Pair<const int, std::string>(2, "two"));
+    assert(res.second && res.first->second == "two");
+    assert(!m.insert(Pair<const int, std::string>(2, "deux")).second);
+    assert(m.emplace(1, "one").second);
+    m[3] = "three";
+    assert(m.size() == 3 && m[2] == "two");
+
+    // 按键有序
+    int expected = 1;
+    for (const auto& kv : m)
+        assert(kv.first == expected++);
+
+    assert(m.at(1) == "one");
+    bool thrown = false;
+    try {
+        m.at(100);
+    } catch (const std::out_of_range&) {
+        thrown = true;
+    }
+    assert(thrown);
+
+    m.find(3)->second = "THREE";
+    assert(m[3] == "THREE");
+    assert(m.count(3) == 1 && m.contains(1) && !m.contains(100));
+    assert(m.lower_bound(2)->first == 2 && m.upper_bound(2)->first == 3);
+    assert(m.erase(2) == 1 && m.size() == 2);
+    m.erase(m.begin());
+    assert(m.begin()->first == 3);
+
+    Map<int, std::string> copy(m);
+    assert(copy == m);
+    copy[4] = "four";
+    assert(copy != m);
+    copy.swap(m);
+    assert(m.size() == 2 && copy.size() == 1);
+    std::cout << "Map 基本操作测试通过!" << std::endl;
+}
+
+void test_try_emplace() {
+    std::cout << "\n=== try_emplace/insert_or_assign 测试 ===" << std::endl;
+    Map<int, Counted> m;
+    Counted::constructed = 0;
+    assert(m.try_emplace(1, 10).second);
+    assert(Counted::constructed == 1);  // 在节点中原地构造，没有临时对象
+
+    // 键已存在：不构造任何 Counted
+    auto res = m.try_emplace(1, 20);
+    assert(!res.second && res.first->second.value == 10);
+    assert(Counted::constructed == 1);
+    m[1];
+    assert(Counted::constructed == 1);
+
+    // insert_or_assign：存在时赋值，不存在时插入
+    Counted c(30);
+    Counted::constructed = 0;
+    assert(!m.insert_or_assign(1, c).second);
+    assert(m[1].value == 30 && Counted::constructed == 0);
+    assert(m.insert_or_assign(2, c).second);
+    assert(m[2].value == 30 && Counted::constructed == 1);
+
+    // 右值键插入时移动到节点中，键已存在时不会被移走
+    Map<std::string, int> names;
+    std::string key(64, 'k');
+    names[std::move(key)] = 1;
+    assert(key.empty() && names.size() == 1);
+    std::string again(64, 'k');
+    assert(!names.try_emplace(std::move(again), 2).second && again.size() == 64);
+    assert(names.insert_or_assign(std::move(again), 3).second == false && again.size() == 64);
+    std::string other(64, 'o');
+    assert(names.try_emplace(std::move(other), 4).second && other.empty() && names[std::string(64, 'o')] == 4);
+
+    // 只能移动的键
+    Map<std::unique_ptr<int>, int> owners;
+    owners[std::make_unique<int>(1)] = 1;
+    assert(owners.try_emplace(std::make_unique<int>(2), 2).second);
+    assert(owners.insert_or_assign(std::make_unique<int>(3), 3).second && owners.size() == 3);
+    std::cout << "try_emplace/insert_or_assign 测试通过!" << std::endl;
+}
+
+void test_heterogeneous_lookup() {
+    std::cout << "\n=== 异构查找测试 ===" << std::endl;
+    Map<std::string, int, Less<>> m;
+    m["alpha"] = 1;
+    m["beta"] = 2;
+    m["gamma"] = 3;
+
+    std::string_view key = "beta";
+    assert(m.find(key)->second == 2);
+    assert(m.find(std::string_view("delta")) == m.end());
+    assert(m.count(std::string_view("gamma")) == 1);
+    assert(m.contains("alpha"));
+    assert(m.lower_bound(std::string_view("b"))->first == "beta");
+    assert(m.upper_bound(std::string_view("beta"))->first == "gamma");
+
+    // 键只能显式构造：查找时一个键都没有构造
+    Map<Name, int, Less<>> names;
+    names.emplace(Name("x"), 1);
+    names.emplace(Name("y"), 2);
+    Name::constructed = 0;
+    assert(names.find(std::string_view("y"))->second == 2);
+    assert(names.find(std::string_view("z")) == names.end());
+    assert(names.equal_range(std::string_view("x")).first->second == 1);
+    assert(Name::constructed == 0);
+
+    Multimap<std::string, int, Less<>> mm;
+    mm.emplace("k", 1);
+    mm.emplace("k", 2);
+    assert(mm.count(std::string_view("k")) == 2);
+    std::cout << "异构查找测试通过!" << std::endl;
+}
+
+void test_multimap() {
+    std::cout << "\n=== Multimap 测试 ===" << std::endl;
+    Multimap<int, int> mm;
+    for (int i = 0; i < 10; ++i)
+        mm.insert(Pair<const int, int>(i % 3, i));
+    assert(mm.size() == 10 && mm.count(0) == 4 && mm.count(1) == 3);
+
+    // 相等的键按插入顺序排列
+    auto range = mm.equal_range(1);
+    int expected = 1;
+    for (auto it = range.first; it != range.second; ++it, expected += 3)
+        assert(it->second == expected);
+
+    assert(mm.emplace(1, 100)->second == 100);
+    assert(mm.count(1) == 4);
+    assert(mm.erase(1) == 4 && mm.count(1) == 0);
+    assert(mm.size() == 7);
+
+    // 有序输入直接建树
+    std::vector<Pair<const int, int>> sorted;
+    for (int i = 0; i < 100; ++i)
+        sorted.emplace_back(i / 2, i);
+    Multimap<int, int> bulk(kSortedEquivalent, sorted.begin(), sorted.end());
+    assert(bulk.size() == 100 && bulk.count(10) == 2);
+    Map<int, int> unique_bulk(sorted.begin(), sorted.end());
+    assert(unique_bulk.size() == 50 && unique_bulk[10] == 20);
+    std::cout << "Multimap 测试通过!" << std::endl;
+}
+
+// 与 std::map 对照的随机测试
+void test_random_against_std() {
+    std::cout << "\n=== Map 随机测试 ===" << std::endl;
+    std::mt19937 rng(11);
+    Map<int, int> m;
+    std::map<int, int> ref;
+    for (int i = 0; i < 20000; ++i) {
+        int k = static_cast<int>(rng() % 1000);
+        switch (rng() % 4) {
+        case 0:
+            assert(m.try_emplace(k, i).second == ref.try_emplace(k, i).second);
+            break;
+        case 1:
+            assert(m.insert_or_assign(k, i).second == ref.insert_or_assign(k, i).second);
+            break;
+        case 2:
+            m[k] += 1;
+            ref[k] += 1;
+            break;
+        default:
+            assert(m.erase(k) == ref.erase(k));
+        }
+    }
+    assert(m.size() == ref.size());
+    auto it = ref.begin();
+    for (const auto& kv : m) {
+        assert(kv.first == it->first && kv.second == it->second);
+        ++it;
+    }
+    std::cout << "Map 随机测试通过!" << std::endl;
+}
+
+// string_view 查找：每次构造临时 std::string vs 透明比较器直接比较
+void benchmark_heterogeneous_lookup() {
+    const int n = 20000;
+    std::cout << "\n=== string_view 查找测试 (" << n << " 个键) ===" << std::endl;
+    std::vector<std::string> keys;
+    for (int i = 0; i < n; ++i)
+        keys.push_back("tenant/region/service/key-" + std::to_string(i));
+    std::vector<std::string_view> probes(keys.begin(), keys.end());
+    std::shuffle(probes.begin(), probes.end(), std::mt19937(5));
+
+    Map<std::string, int> plain;
+    Map<std::string, int, Less<>> transparent;
+    for (int i = 0; i < n; ++i) {
+        plain.try_emplace(keys[i], i);
+        transparent.try_emplace(keys[i], i);
+    }
+
+    auto time = [](auto&& fn) {
+        auto start = std::chrono::high_resolution_clock::now();
+        fn();
+        auto end = std::chrono::high_resolution_clock::now();
+        return std::chrono::duration<double>(end - start).count();
+    };
+
+    long long sum = 0;
+    double with_temp = time([&]() {
+        for (std::string_view k : probes)
+            sum += plain.find(std::string(k))->second;
+    });
+    double direct = time([&]() {
+        for (std::string_view k : probes)
+            sum += transparent.find(k)->second;
+    });
+    assert(sum == 2LL * n * (n - 1) / 2);
+
+    std::cout << std::setw(24) << "find(std::string(sv))" << std::setw(24) << "find(sv) + Less<>"
+              << std::endl;
+    std::cout << std::fixed << std::setprecision(6) << std::setw(24) << with_temp
+              << std::setw(24) << direct << std::endl;
+}
+
+int main() {
+    std::cout << "开始测试 mstl::Map..." << std::endl;
+    test_basic_operations();
+    test_try_emplace();
+    test_heterogeneous_lookup();
+    test_multimap();
+    test_random_against_std();
+    benchmark_heterogeneous_lookup();
+    std::cout << "\n所有测试通过!" << std::endl;
+    return 0;
+}
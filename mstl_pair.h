@@ -1,8 +1,18 @@
 #ifndef __MSGI_STL_INTERNAL_PAIR_H
 #define __MSGI_STL_INTERNAL_PAIR_H
 
+#include <cstddef>
+#include <tuple>
+#include <utility>
+
 namespace mstl {
 
+// 逐段构造的标记：first 与 second 分别用两个 tuple 中的参数原地构造
+struct PiecewiseConstructT {
+    explicit PiecewiseConstructT() = default;
+};
+inline constexpr PiecewiseConstructT kPiecewiseConstruct{};
+
 template <class T1, class T2>
 struct Pair {
     using FirstType = T1;
@@ -18,8 +28,18 @@ struct Pair {
     template <typename U1 = T1, typename U2 = T2>
     Pair(const U1& a, const U2& b) : first(a), second(b) {}
 
+    // 转发参数，右值直接移动进 first/second
+    template <typename U1, typename U2>
+    Pair(U1&& a, U2&& b) : first(std::forward<U1>(a)), second(std::forward<U2>(b)) {}
+
+    // first 与 second 分别用 a、b 中的参数原地构造，例如 map 插入时不必先构造再复制 mapped 值
+    template <typename... Args1, typename... Args2>
+    Pair(PiecewiseConstructT, std::tuple<Args1...> a, std::tuple<Args2...> b)
+        : Pair(a, b, std::index_sequence_for<Args1...>(), std::index_sequence_for<Args2...>()) {}
+
     // 复制构造函数
     Pair(const Pair& p) = default;
+    Pair(Pair&& p) = default;
 
     // 复制构造函数模板
     template <class U1, class U2>
@@ -34,6 +54,13 @@ struct Pair {
         return *this;
     }
 
+    // 移动赋值：在数组中搬动 Pair (例如 FlatMap) 时不复制 first/second
+    Pair& operator=(Pair&& p) {
+        first = std::move(p.first);
+        second = std::move(p.second);
+        return *this;
+    }
+
     // 比较操作符
     bool operator==(const Pair& p) const {
         return first == p.first && second == p.second;
@@ -58,6 +85,12 @@ struct Pair {
     bool operator>=(const Pair& p) const {
         return !(*this < p);
     }
+
+private:
+    template <typename Tuple1, typename Tuple2, size_t... I1, size_t... I2>
+    Pair(Tuple1& a, Tuple2& b, std::index_sequence<I1...>, std::index_sequence<I2...>)
+        : first(std::forward<std::tuple_element_t<I1, Tuple1>>(std::get<I1>(a))...),
+          second(std::forward<std::tuple_element_t<I2, Tuple2>>(std::get<I2>(b))...) {}
 };
 
 // 创建pair的辅助函数
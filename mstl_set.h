@@ -3,22 +3,40 @@
 
 #include "mstl_functional.h"
 #include "mstl_alloc.h"
+#include "mstl_allocator.h"
 #include "mstl_tree.h"
 #include "mstl_pair.h"
+#include "mstl_vector.h"
 
 #include <concepts>
+#include <iterator>
 namespace mstl {
-    template <typename Key, typename Compare = Less<Key>, typename Alloc = alloc>
+    template <typename Key, typename Compare, typename Alloc, bool OrderStatistic>
+    requires std::strict_weak_order<Compare, Key, Key>
+    class Multiset;
+
+    // OrderStatistic 为 true 时节点记录子树大小，提供 O(log n) 的 select/rank
+    template <typename Key, typename Compare = Less<Key>, typename Alloc = thread_safe_alloc,
+              bool OrderStatistic = false>
     requires (std::equality_comparable<Key> && std::strict_weak_order<Compare, Key, Key>)
     class Set {
+        // merge 需要访问比较器不同的 Set/Multiset 的底层树
+        template <typename K, typename C, typename A, bool OS>
+        requires (std::equality_comparable<K> && std::strict_weak_order<C, K, K>)
+        friend class Set;
+        template <typename K, typename C, typename A, bool OS>
+        requires std::strict_weak_order<C, K, K>
+        friend class Multiset;
+
     public:
         using KeyType = Key;
         using ValueType = Key;
         using KeyCompare = Compare;
         using ValueCompare = Compare;
+        using AllocatorType = Alloc;
     
     private:
-        using RepType = RbTree<KeyType, ValueType, Identity<Key>, Compare, Alloc>;
+        using RepType = RbTree<KeyType, ValueType, Identity<Key>, Compare, Alloc, OrderStatistic>;
         
         RepType t; // Red-Black Tree representation of the set
     public:
@@ -34,16 +52,28 @@ namespace mstl {
 
         using SizeType = size_t;
         using DifferenceType = typename RepType::DifferenceType;
+        using NodeHandle = typename RepType::NodeHandle;
+        using InsertReturnType = RbTreeInsertReturn<Iterator, NodeHandle>;
 
         Set() : t(Compare()) {}
-        explicit Set(const Compare& comp) : t(comp) {}
+        explicit Set(const Compare& comp, const Alloc& a = Alloc()) : t(comp, a) {}
+        explicit Set(const Alloc& a) : t(Compare(), a) {}
         Set(const Set& x) : t(x.t) {}
 
+        // 输入已按键严格递增时线性建树
         template <typename InputIterator>
         Set(InputIterator first, InputIterator last) : t(Compare()) {
             t.insert_unique(first, last);
         }
 
+        // 调用者保证 [first, last) 严格递增，不再检查
+        template <typename InputIterator>
+        Set(SortedUniqueT, InputIterator first, InputIterator last, const Compare& comp = Compare(),
+            const Alloc& a = Alloc())
+            : t(comp, a) {
+            t.insert_unique(kSortedUnique, first, last);
+        }
+
         ~Set() {}
         
         Set& operator=(const Set& x) {
@@ -64,6 +94,10 @@ namespace mstl {
             return t.key_comp();
         }
 
+        AllocatorType get_allocator() const {
+            return t.get_allocator();
+        }
+
         Iterator begin() const {
             return t.begin();
         }
@@ -102,6 +136,7 @@ namespace mstl {
             return t.insert_unique(x);
         }
 
+        // position 是 x 插入后的下一个位置时均摊 O(1)，例如递增插入时用 end()
         Iterator insert(Iterator position, const ValueType& x) {
             return t.insert_unique(position, x);
         }
@@ -110,6 +145,17 @@ namespace mstl {
         void insert(InputIterator first, InputIterator last) {
             t.insert_unique(first, last);
         }
+
+        template <typename... Args>
+        PairIteratorBool emplace(Args&&... args) {
+            return t.emplace_unique(std::forward<Args>(args)...);
+        }
+
+        // 插入 extract() 取出的节点，不分配也不拷贝；键已存在时节点留在返回值的 node 中
+        InsertReturnType insert(NodeHandle&& nh) {
+            auto r = t.insert_unique(std::move(nh));
+            return InsertReturnType{r.position, r.inserted, std::move(r.node)};
+        }
         
 
         void erase(ConstIterator position) {
@@ -131,7 +177,27 @@ namespace mstl {
             t.clear();
         }
 
-        Iterator find(const Key& x) {
+        // 从树上摘下节点交给句柄，值和节点内存都原样保留
+        NodeHandle extract(ConstIterator position) {
+            return t.extract(position);
+        }
+
+        NodeHandle extract(const Key& x) {
+            return t.extract(x);
+        }
+
+        // 把 src 中的节点直接挂过来，不分配也不拷贝；键已存在的留在 src 中，两边的分配器必须相等
+        template <typename C2>
+        void merge(Set<Key, C2, Alloc, OrderStatistic>& src) {
+            t.merge_unique(src.t);
+        }
+
+        template <typename C2>
+        void merge(Multiset<Key, C2, Alloc, OrderStatistic>& src) {
+            t.merge_unique(src.t);
+        }
+
+        Iterator find(const Key& x) const {
             return t.find(x);
         }
 
@@ -139,11 +205,11 @@ namespace mstl {
             return t.count(x);
         }
 
-        Iterator lower_bound(const Key& x) {
+        Iterator lower_bound(const Key& x) const {
             return t.lower_bound(x);
         }
 
-        Iterator upper_bound(const Key& x) {
+        Iterator upper_bound(const Key& x) const {
             return t.upper_bound(x);
         }
 
@@ -151,8 +217,55 @@ namespace mstl {
             return t.equal_range(x);
         }
 
+        // Compare 为透明比较器 (例如 Less<>) 时按任何可与 Key 比较的类型查找
+        template <typename K>
+            requires TransparentCompare<Compare>
+        Iterator find(const K& x) const {
+            return t.find(x);
+        }
+
+        template <typename K>
+            requires TransparentCompare<Compare>
+        SizeType count(const K& x) const {
+            return t.count(x);
+        }
+
+        template <typename K>
+            requires TransparentCompare<Compare>
+        Iterator lower_bound(const K& x) const {
+            return t.lower_bound(x);
+        }
+
+        template <typename K>
+            requires TransparentCompare<Compare>
+        Iterator upper_bound(const K& x) const {
+            return t.upper_bound(x);
+        }
+
+        template <typename K>
+            requires TransparentCompare<Compare>
+        Pair<ConstIterator, ConstIterator> equal_range(const K& x) const {
+            return t.equal_range(x);
+        }
+
+        // 第 k 小 (从 0 开始) 的元素，k >= size() 时返回 end()
+        Iterator select(SizeType k) const requires OrderStatistic {
+            return t.select(k);
+        }
+
+        // 小于 x 的元素个数
+        SizeType rank(const Key& x) const requires OrderStatistic {
+            return t.rank(x);
+        }
+
+        template <typename K>
+            requires (OrderStatistic && TransparentCompare<Compare>)
+        SizeType rank(const K& x) const {
+            return t.rank(x);
+        }
+
         friend bool operator==(const Set& x, const Set& y) {
-            return std::equal(x.begin(), x.end(), y.begin(), y.end());
+            return x.size() == y.size() && std::equal(x.begin(), x.end(), y.begin());
         }
         friend bool operator!=(const Set& x, const Set& y) {
             return !(x == y);
@@ -170,6 +283,327 @@ namespace mstl {
             return !(x < y);
         }
     };
+
+    // 集合运算：两棵树各按中序走一遍做线性归并 O(|a| + |b|)，结果先放进有序缓冲区，
+    // 再走有序建树的路径一次建成，不逐个插入；结果使用 a 的比较器与分配器
+    template <typename Key, typename Compare, typename Alloc, bool OS>
+    Set<Key, Compare, Alloc, OS> set_union(const Set<Key, Compare, Alloc, OS>& a,
+                                           const Set<Key, Compare, Alloc, OS>& b) {
+        Compare comp = a.key_comp();
+        Vector<Key> buf;
+        buf.reserve(a.size() + b.size());
+        auto first1 = a.begin(), last1 = a.end();
+        auto first2 = b.begin(), last2 = b.end();
+        while (first1 != last1 && first2 != last2) {
+            if (comp(*first1, *first2)) {
+                buf.push_back(*first1);
+                ++first1;
+            } else if (comp(*first2, *first1)) {
+                buf.push_back(*first2);
+                ++first2;
+            } else {
+                buf.push_back(*first1);
+                ++first1;
+                ++first2;
+            }
+        }
+        for (; first1 != last1; ++first1)
+            buf.push_back(*first1);
+        for (; first2 != last2; ++first2)
+            buf.push_back(*first2);
+        return Set<Key, Compare, Alloc, OS>(kSortedUnique, std::make_move_iterator(buf.begin()),
+                                            std::make_move_iterator(buf.end()), comp,
+                                            a.get_allocator());
+    }
+
+    template <typename Key, typename Compare, typename Alloc, bool OS>
+    Set<Key, Compare, Alloc, OS> set_intersection(const Set<Key, Compare, Alloc, OS>& a,
+                                                  const Set<Key, Compare, Alloc, OS>& b) {
+        Compare comp = a.key_comp();
+        Vector<Key> buf;
+        buf.reserve(a.size() < b.size() ? a.size() : b.size());
+        auto first1 = a.begin(), last1 = a.end();
+        auto first2 = b.begin(), last2 = b.end();
+        while (first1 != last1 && first2 != last2) {
+            if (comp(*first1, *first2)) {
+                ++first1;
+            } else if (comp(*first2, *first1)) {
+                ++first2;
+            } else {
+                buf.push_back(*first1);
+                ++first1;
+                ++first2;
+            }
+        }
+        return Set<Key, Compare, Alloc, OS>(kSortedUnique, std::make_move_iterator(buf.begin()),
+                                            std::make_move_iterator(buf.end()), comp,
+                                            a.get_allocator());
+    }
+
+    // a 中不在 b 里的键
+    template <typename Key, typename Compare, typename Alloc, bool OS>
+    Set<Key, Compare, Alloc, OS> set_difference(const Set<Key, Compare, Alloc, OS>& a,
+                                                const Set<Key, Compare, Alloc, OS>& b) {
+        Compare comp = a.key_comp();
+        Vector<Key> buf;
+        buf.reserve(a.size());
+        auto first1 = a.begin(), last1 = a.end();
+        auto first2 = b.begin(), last2 = b.end();
+        while (first1 != last1 && first2 != last2) {
+            if (comp(*first1, *first2)) {
+                buf.push_back(*first1);
+                ++first1;
+            } else if (comp(*first2, *first1)) {
+                ++first2;
+            } else {
+                ++first1;
+                ++first2;
+            }
+        }
+        for (; first1 != last1; ++first1)
+            buf.push_back(*first1);
+        return Set<Key, Compare, Alloc, OS>(kSortedUnique, std::make_move_iterator(buf.begin()),
+                                            std::make_move_iterator(buf.end()), comp,
+                                            a.get_allocator());
+    }
+
+    // 允许重复键的 Set，相等的键按插入顺序排列
+    template <typename Key, typename Compare = Less<Key>, typename Alloc = thread_safe_alloc,
+              bool OrderStatistic = false>
+    requires std::strict_weak_order<Compare, Key, Key>
+    class Multiset {
+        template <typename K, typename C, typename A, bool OS>
+        requires (std::equality_comparable<K> && std::strict_weak_order<C, K, K>)
+        friend class Set;
+        template <typename K, typename C, typename A, bool OS>
+        requires std::strict_weak_order<C, K, K>
+        friend class Multiset;
+
+    public:
+        using KeyType = Key;
+        using ValueType = Key;
+        using KeyCompare = Compare;
+        using ValueCompare = Compare;
+        using AllocatorType = Alloc;
+
+    private:
+        using RepType = RbTree<KeyType, ValueType, Identity<Key>, Compare, Alloc, OrderStatistic>;
+
+        RepType t;
+    public:
+        using Pointer = typename RepType::ConstPointer;
+        using ConstPointer = typename RepType::ConstPointer;
+        using Reference = typename RepType::ConstReference;
+        using ConstReference = typename RepType::ConstReference;
+        using Iterator = typename RepType::ConstIterator;
+        using ConstIterator = typename RepType::ConstIterator;
+        using ReverseIterator = typename RepType::ConstReverseIterator;
+        using ConstReverseIterator = typename RepType::ConstReverseIterator;
+
+        using SizeType = size_t;
+        using DifferenceType = typename RepType::DifferenceType;
+        using NodeHandle = typename RepType::NodeHandle;
+
+        Multiset() : t(Compare()) {}
+        explicit Multiset(const Compare& comp, const Alloc& a = Alloc()) : t(comp, a) {}
+        explicit Multiset(const Alloc& a) : t(Compare(), a) {}
+        Multiset(const Multiset& x) : t(x.t) {}
+
+        template <typename InputIterator>
+        Multiset(InputIterator first, InputIterator last) : t(Compare()) {
+            t.insert_equal(first, last);
+        }
+
+        // 调用者保证 [first, last) 非递减，不再检查
+        template <typename InputIterator>
+        Multiset(SortedEquivalentT, InputIterator first, InputIterator last,
+                 const Compare& comp = Compare(), const Alloc& a = Alloc())
+            : t(comp, a) {
+            t.insert_equal(kSortedEquivalent, first, last);
+        }
+
+        Multiset& operator=(const Multiset& x) {
+            t = x.t;
+            return *this;
+        }
+
+        KeyCompare key_comp() const {
+            return t.key_comp();
+        }
+
+        ValueCompare value_comp() const {
+            return t.key_comp();
+        }
+
+        AllocatorType get_allocator() const {
+            return t.get_allocator();
+        }
+
+        Iterator begin() const {
+            return t.begin();
+        }
+
+        Iterator end() const {
+            return t.end();
+        }
+
+        ReverseIterator rbegin() const {
+            return t.rbegin();
+        }
+
+        ReverseIterator rend() const {
+            return t.rend();
+        }
+
+        bool empty() const {
+            return t.empty();
+        }
+
+        SizeType size() const {
+            return t.size();
+        }
+
+        SizeType max_size() const {
+            return t.max_size();
+        }
+
+        void swap(Multiset& x) {
+            t.swap(x.t);
+        }
+
+        Iterator insert(const ValueType& x) {
+            return t.insert_equal(x);
+        }
+
+        Iterator insert(Iterator position, const ValueType& x) {
+            return t.insert_equal(position, x);
+        }
+
+        template <typename InputIterator>
+        void insert(InputIterator first, InputIterator last) {
+            t.insert_equal(first, last);
+        }
+
+        template <typename... Args>
+        Iterator emplace(Args&&... args) {
+            return t.emplace_equal(std::forward<Args>(args)...);
+        }
+
+        Iterator insert(NodeHandle&& nh) {
+            return t.insert_equal(std::move(nh));
+        }
+
+        void erase(ConstIterator position) {
+            t.erase(position);
+        }
+
+        void erase(Iterator first, Iterator last) {
+            t.erase(first, last);
+        }
+
+        SizeType erase(const Key& x) {
+            return t.erase(x);
+        }
+
+        void clear() {
+            t.clear();
+        }
+
+        NodeHandle extract(ConstIterator position) {
+            return t.extract(position);
+        }
+
+        NodeHandle extract(const Key& x) {
+            return t.extract(x);
+        }
+
+        // 把 src 中的全部节点直接挂过来，不分配也不拷贝
+        template <typename C2>
+        void merge(Multiset<Key, C2, Alloc, OrderStatistic>& src) {
+            t.merge_equal(src.t);
+        }
+
+        template <typename C2>
+        void merge(Set<Key, C2, Alloc, OrderStatistic>& src) {
+            t.merge_equal(src.t);
+        }
+
+        Iterator find(const Key& x) const {
+            return t.find(x);
+        }
+
+        SizeType count(const Key& x) const {
+            return t.count(x);
+        }
+
+        Iterator lower_bound(const Key& x) const {
+            return t.lower_bound(x);
+        }
+
+        Iterator upper_bound(const Key& x) const {
+            return t.upper_bound(x);
+        }
+
+        Pair<ConstIterator, ConstIterator> equal_range(const Key& x) const {
+            return t.equal_range(x);
+        }
+
+        template <typename K>
+            requires TransparentCompare<Compare>
+        Iterator find(const K& x) const {
+            return t.find(x);
+        }
+
+        template <typename K>
+            requires TransparentCompare<Compare>
+        SizeType count(const K& x) const {
+            return t.count(x);
+        }
+
+        template <typename K>
+            requires TransparentCompare<Compare>
+        Iterator lower_bound(const K& x) const {
+            return t.lower_bound(x);
+        }
+
+        template <typename K>
+            requires TransparentCompare<Compare>
+        Iterator upper_bound(const K& x) const {
+            return t.upper_bound(x);
+        }
+
+        template <typename K>
+            requires TransparentCompare<Compare>
+        Pair<ConstIterator, ConstIterator> equal_range(const K& x) const {
+            return t.equal_range(x);
+        }
+
+        // 第 k 小 (从 0 开始) 的元素，k >= size() 时返回 end()
+        Iterator select(SizeType k) const requires OrderStatistic {
+            return t.select(k);
+        }
+
+        // 小于 x 的元素个数
+        SizeType rank(const Key& x) const requires OrderStatistic {
+            return t.rank(x);
+        }
+
+        template <typename K>
+            requires (OrderStatistic && TransparentCompare<Compare>)
+        SizeType rank(const K& x) const {
+            return t.rank(x);
+        }
+
+        friend bool operator==(const Multiset& x, const Multiset& y) {
+            return x.size() == y.size() && std::equal(x.begin(), x.end(), y.begin());
+        }
+        friend bool operator!=(const Multiset& x, const Multiset& y) {
+            return !(x == y);
+        }
+        friend bool operator<(const Multiset& x, const Multiset& y) {
+            return std::lexicographical_compare(x.begin(), x.end(), y.begin(), y.end());
+        }
+    };
 }
 
 #endif // __MSGI_STL_INTERNAL_SET_H
\ No newline at end of file
@@ -1,7 +1,15 @@
 #include "mstl_set.h"
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
 #include <iostream>
+#include <random>
+#include <set>
 #include <string>
+#include <string_view>
 #include <cassert>
+#include <vector>
+#include "mstl_arena.h"
 
 using namespace mstl;
 
@@ -125,6 +133,496 @@ void test_iterator_validity() {
     std::cout << "迭代器有效性测试通过!" << std::endl;
 }
 
+void test_allocator() {
+    std::cout << "\n=== Set 分配器测试 ===" << std::endl;
+    // 默认从内存池分配节点
+    using NodePool = thread_safe_alloc;
+    size_t refills = NodePool::refillStats(sizeof(RbTreeNode<int>)).refills;
+    {
+        Set<int> s;
+        for (int i = 0; i < 10000; ++i) s.insert(i);
+    }
+    assert(NodePool::refillStats(sizeof(RbTreeNode<int>)).refills > refills);
+
+    // 使用用户指定的分配器
+    Arena arena;
+    {
+        Set<int, Less<int>, ArenaRef> s{ArenaRef(arena)};
+        for (int i = 0; i < 100; ++i) s.insert(i);
+        assert(s.size() == 100);
+        assert(s.get_allocator() == ArenaRef(arena));
+        assert(arena.bytesUsed() >= 100 * sizeof(RbTreeNode<int>));
+    }
+    std::cout << "分配器测试通过!" << std::endl;
+}
+
+void test_multiset() {
+    std::cout << "\n=== Multiset 测试 ===" << std::endl;
+    Multiset<int> ms;
+    for (int i = 0; i < 12; ++i) ms.insert(i % 4);
+    assert(ms.size() == 12 && ms.count(2) == 3);
+    assert(*ms.emplace(2) == 2 && ms.count(2) == 4);
+    auto range = ms.equal_range(2);
+    assert(*range.first == 2 && *range.second == 3);
+    assert(ms.erase(2) == 4 && ms.count(2) == 0 && ms.size() == 9);
+
+    int prev = -1;
+    for (int x : ms) {
+        assert(x >= prev);
+        prev = x;
+    }
+
+    // 透明比较器：用 string_view 查找 Set<string>
+    Set<std::string, Less<>> names;
+    names.emplace("alice");
+    names.emplace("bob");
+    assert(!names.emplace("bob").second);
+    std::string_view key = "alice";
+    assert(names.find(key) != names.end() && names.count(key) == 1);
+    assert(*names.lower_bound(std::string_view("b")) == "bob");
+    Multiset<std::string, Less<>> tags;
+    tags.insert("x");
+    tags.insert("x");
+    assert(tags.count(std::string_view("x")) == 2);
+    std::cout << "Multiset 测试通过!" << std::endl;
+}
+
+// 插入密集的工作负载：逐个 malloc 节点 vs 内存池节点
+template <typename Alloc>
+double run_insert_erase(const std::vector<int>& keys) {
+    auto start = std::chrono::high_resolution_clock::now();
+    for (int round = 0; round < 3; ++round) {
+        Set<int, Less<int>, Alloc> s;
+        for (int k : keys) s.insert(k);
+        for (int k : keys) s.erase(k);
+    }
+    auto end = std::chrono::high_resolution_clock::now();
+    return std::chrono::duration<double>(end - start).count();
+}
+
+void test_set_algebra() {
+    std::cout << "\n=== 集合运算测试 ===" << std::endl;
+    std::mt19937 rng(23);
+    for (int round = 0; round < 20; ++round) {
+        Set<int> a, b;
+        std::set<int> ra, rb;
+        int na = static_cast<int>(rng() % 300), nb = static_cast<int>(rng() % 300);
+        for (int i = 0; i < na; ++i) {
+            int k = static_cast<int>(rng() % 500);
+            a.insert(k);
+            ra.insert(k);
+        }
+        for (int i = 0; i < nb; ++i) {
+            int k = static_cast<int>(rng() % 500);
+            b.insert(k);
+            rb.insert(k);
+        }
+
+        std::vector<int> expected;
+        std::set_union(ra.begin(), ra.end(), rb.begin(), rb.end(), std::back_inserter(expected));
+        Set<int> u = set_union(a, b);
+        assert(u.size() == expected.size() && std::equal(u.begin(), u.end(), expected.begin()));
+
+        expected.clear();
+        std::set_intersection(ra.begin(), ra.end(), rb.begin(), rb.end(),
+                              std::back_inserter(expected));
+        Set<int> in = set_intersection(a, b);
+        assert(in.size() == expected.size() && std::equal(in.begin(), in.end(), expected.begin()));
+
+        expected.clear();
+        std::set_difference(ra.begin(), ra.end(), rb.begin(), rb.end(),
+                            std::back_inserter(expected));
+        Set<int> d = set_difference(a, b);
+        assert(d.size() == expected.size() && std::equal(d.begin(), d.end(), expected.begin()));
+
+        // 结果是合法的红黑树，之后照常插入/删除
+        u.insert(1000);
+        d.erase(d.begin(), d.end());
+        assert(u.count(1000) == 1 && d.empty());
+    }
+
+    // 空集与自身
+    Set<std::string> s, empty;
+    s.insert("a");
+    s.insert("b");
+    assert(set_union(s, empty) == s && set_union(empty, s) == s);
+    assert(set_intersection(s, empty).empty() && set_intersection(s, s) == s);
+    assert(set_difference(s, s).empty() && set_difference(s, empty) == s);
+    std::cout << "集合运算测试通过!" << std::endl;
+}
+
+void test_order_statistic() {
+    std::cout << "\n=== select/rank 测试 ===" << std::endl;
+    using RankedSet = Set<int, Less<int>, thread_safe_alloc, true>;
+    RankedSet s;
+    for (int i = 100; i > 0; --i)
+        s.insert(i * 3);
+    assert(*s.select(0) == 3 && *s.select(99) == 300 && s.select(100) == s.end());
+    assert(s.rank(3) == 0 && s.rank(4) == 1 && s.rank(1000) == 100);
+    s.erase(s.find(30));
+    assert(*s.select(9) == 33 && s.rank(33) == 9);
+
+    RankedSet evens;
+    for (int i = 0; i <= 300; i += 2)
+        evens.insert(i);
+    RankedSet both = set_intersection(s, evens);
+    assert(*both.select(1) == 12 && both.rank(12) == 1);
+
+    Multiset<int, Less<int>, thread_safe_alloc, true> ms;
+    for (int i = 0; i < 30; ++i)
+        ms.insert(i % 10);
+    assert(*ms.select(3) == 1 && ms.rank(1) == 3 && ms.rank(10) == 30);
+
+    Set<std::string, Less<>, thread_safe_alloc, true> names;
+    names.insert("a");
+    names.insert("c");
+    assert(names.rank(std::string_view("b")) == 1);
+    std::cout << "select/rank 测试通过!" << std::endl;
+}
+
+// 只记录拷贝次数的键
+struct CopyCounted {
+    static int copies;
+    int value;
+
+    CopyCounted(int v) : value(v) {}
+    CopyCounted(const CopyCounted& x) : value(x.value) { ++copies; }
+    CopyCounted& operator=(const CopyCounted& x) {
+        value = x.value;
+        ++copies;
+        return *this;
+    }
+    friend bool operator<(const CopyCounted& x, const CopyCounted& y) { return x.value < y.value; }
+    friend bool operator==(const CopyCounted& x, const CopyCounted& y) { return x.value == y.value; }
+};
+int CopyCounted::copies = 0;
+
+void test_node_handle() {
+    std::cout << "\n=== extract/merge 测试 ===" << std::endl;
+    Arena arena;
+    using ArenaSet = Set<CopyCounted, Less<CopyCounted>, ArenaRef>;
+    ArenaSet a{ArenaRef(arena)}, b{ArenaRef(arena)};
+    Multiset<CopyCounted, Less<CopyCounted>, ArenaRef> all{ArenaRef(arena)};
+    for (int i = 0; i < 100; ++i) {
+        a.emplace(i * 2);
+        b.emplace(i * 3);
+    }
+    size_t used = arena.bytesUsed();
+    CopyCounted::copies = 0;
+
+    // 取出节点，改键后插回另一个 Set
+    ArenaSet::NodeHandle nh = a.extract(CopyCounted(10));
+    assert(nh && nh.value().value == 10 && a.size() == 99 && a.count(CopyCounted(10)) == 0);
+    nh.value().value = 1001;
+    auto r = b.insert(std::move(nh));
+    assert(r.inserted && r.position->value == 1001 && r.node.empty() && b.size() == 101);
+
+    // 键已存在：节点交还给调用者
+    auto dup = b.insert(a.extract(a.find(CopyCounted(0))));
+    assert(!dup.inserted && dup.node && dup.node.value().value == 0 && dup.position->value == 0);
+    assert(a.extract(CopyCounted(-1)).empty());
+
+    // merge：b 中的键已在 a 里的留在 b 中
+    a.merge(b);
+    assert(a.size() == 98 + 101 - 33 && b.size() == 33);
+    for (const auto& x : b)
+        assert(x.value % 6 == 0 && a.count(x) == 1);
+
+    all.merge(a);
+    all.merge(b);
+    assert(a.empty() && b.empty() && all.size() == 199);
+    assert(CopyCounted::copies == 0 && arena.bytesUsed() == used);
+
+    // 带子树大小的树：节点换树后 select/rank 仍然正确
+    Set<int, Less<int>, thread_safe_alloc, true> low, high;
+    for (int i = 0; i < 50; ++i) {
+        low.insert(i);
+        high.insert(i + 50);
+    }
+    low.merge(high);
+    assert(high.empty() && *low.select(75) == 75 && low.rank(60) == 60);
+    high.insert(low.extract(low.select(10)));
+    assert(*low.select(10) == 11 && high.rank(11) == 1);
+
+    // 源容器的比较器不同：按目标的顺序重新链接
+    Set<int> asc;
+    Set<int, Greater<int>> desc;
+    for (int x : {1, 3, 5})
+        asc.insert(x);
+    for (int x : {6, 5, 4, 3})
+        desc.insert(x);
+    asc.merge(desc);
+    assert(asc.size() == 5 && desc.size() == 2 && *desc.begin() == 5 && *asc.rbegin() == 6);
+    int expected[] = {1, 3, 4, 5, 6};
+    assert(std::equal(asc.begin(), asc.end(), expected));
+
+    Multiset<int> ms;
+    Multiset<int, Greater<int>> msDesc;
+    for (int x : {2, 2, 7})
+        ms.insert(x);
+    for (int x : {9, 2, 1})
+        msDesc.insert(x);
+    ms.merge(msDesc);
+    int expectedMulti[] = {1, 2, 2, 2, 7, 9};
+    assert(msDesc.empty() && ms.size() == 6 && std::equal(ms.begin(), ms.end(), expectedMulti));
+    std::cout << "extract/merge 测试通过!" << std::endl;
+}
+
+void benchmark_node_allocation() {
+    const int n = 50000;
+    std::cout << "\n=== Set 插入/删除测试 (" << n << " 个键, 3 轮) ===" << std::endl;
+    std::vector<int> keys(n);
+    std::mt19937 rng(1);
+    for (int& k : keys) k = static_cast<int>(rng());
+
+    double via_malloc = run_insert_erase<malloc_alloc>(keys);
+    double via_pool = run_insert_erase<thread_safe_alloc>(keys);
+    std::cout << std::setw(16) << "malloc(秒)" << std::setw(16) << "内存池(秒)" << std::endl;
+    std::cout << std::setw(16) << std::fixed << std::setprecision(6) << via_malloc
+              << std::setw(16) << via_pool << std::endl;
+}
+
+// Set<std::string> 的 find/lower_bound：键比较直接引用节点中的字符串，不拷贝
+// 键长度超过短字符串优化的长度，拷贝一次就是一次堆分配；以 std::set 作为参照
+void benchmark_string_lookup() {
+    const int n = 50000;
+    std::cout << "\n=== Set<string> 查找测试 (" << n << " 个键) ===" << std::endl;
+    std::vector<std::string> keys;
+    for (int i = 0; i < n; ++i) keys.push_back("user:session:" + std::to_string(1000000 + i));
+    std::vector<std::string> probes = keys;
+    std::shuffle(probes.begin(), probes.end(), std::mt19937(3));
+
+    Set<std::string> s(keys.begin(), keys.end());
+    std::set<std::string> ref(keys.begin(), keys.end());
+    const Set<std::string>& cs = s;
+
+    auto time = [](auto&& fn) {
+        auto start = std::chrono::high_resolution_clock::now();
+        fn();
+        auto end = std::chrono::high_resolution_clock::now();
+        return std::chrono::duration<double>(end - start).count();
+    };
+
+    size_t found = 0;
+    double mstl_find = time([&]() {
+        for (const auto& k : probes) found += cs.find(k) != cs.end();
+    });
+    double mstl_lower = time([&]() {
+        for (const auto& k : probes) found += *cs.lower_bound(k) == k;
+    });
+    double std_find = time([&]() {
+        for (const auto& k : probes) found += ref.find(k) != ref.end();
+    });
+    double std_lower = time([&]() {
+        for (const auto& k : probes) found += *ref.lower_bound(k) == k;
+    });
+    assert(found == 4 * probes.size());
+    assert(cs.find("user:session:0") == cs.end());
+
+    std::cout << std::setw(16) << "" << std::setw(16) << "find(秒)" << std::setw(20)
+              << "lower_bound(秒)" << std::endl;
+    std::cout << std::fixed << std::setprecision(6) << std::setw(16) << "mstl::Set"
+              << std::setw(16) << mstl_find << std::setw(20) << mstl_lower << std::endl;
+    std::cout << std::setw(16) << "std::set" << std::setw(16) << std_find << std::setw(20)
+              << std_lower << std::endl;
+}
+
+// 从有序快照加载：逐个插入 vs 一次线性建树
+void benchmark_sorted_load() {
+    const int n = 200000;
+    std::cout << "\n=== 有序输入加载测试 (" << n << " 个键) ===" << std::endl;
+    std::vector<int> keys(n);
+    for (int i = 0; i < n; ++i) keys[i] = i;
+
+    auto time = [](auto&& fn) {
+        auto start = std::chrono::high_resolution_clock::now();
+        fn();
+        auto end = std::chrono::high_resolution_clock::now();
+        return std::chrono::duration<double>(end - start).count();
+    };
+
+    size_t total = 0;
+    double one_by_one = time([&]() {
+        Set<int> s;
+        for (int k : keys) s.insert(k);
+        total += s.size();
+    });
+    double bulk = time([&]() {
+        Set<int> s(keys.begin(), keys.end());
+        total += s.size();
+    });
+    double declared = time([&]() {
+        Set<int> s(kSortedUnique, keys.begin(), keys.end());
+        total += s.size();
+    });
+    assert(total == 3 * keys.size());
+
+    std::cout << std::setw(16) << "逐个插入(秒)" << std::setw(16) << "检查后建树(秒)" << std::setw(16)
+              << "声明有序(秒)" << std::endl;
+    std::cout << std::fixed << std::setprecision(6) << std::setw(16) << one_by_one << std::setw(16)
+              << bulk << std::setw(16) << declared << std::endl;
+}
+
+// 按时间顺序递增的键：每次从根查找 vs 以 end() 为提示
+void benchmark_hinted_insert() {
+    const int n = 200000;
+    std::cout << "\n=== 递增键插入测试 (" << n << " 个键) ===" << std::endl;
+
+    auto time = [](auto&& fn) {
+        auto start = std::chrono::high_resolution_clock::now();
+        fn();
+        auto end = std::chrono::high_resolution_clock::now();
+        return std::chrono::duration<double>(end - start).count();
+    };
+
+    size_t total = 0;
+    double plain = time([&]() {
+        Set<long long> s;
+        for (int i = 0; i < n; ++i) s.insert(1700000000000LL + i * 7);
+        total += s.size();
+    });
+    double hinted = time([&]() {
+        Set<long long> s;
+        for (int i = 0; i < n; ++i) s.insert(s.end(), 1700000000000LL + i * 7);
+        total += s.size();
+    });
+    assert(total == 2 * static_cast<size_t>(n));
+
+    std::cout << std::setw(16) << "无提示(秒)" << std::setw(16) << "end() 提示(秒)" << std::endl;
+    std::cout << std::fixed << std::setprecision(6) << std::setw(16) << plain << std::setw(16)
+              << hinted << std::endl;
+}
+
+// 两个各有 n 个 ID 的集合求交/并：逐个 find/insert vs 线性归并后一次建树
+void benchmark_set_algebra() {
+    const int n = 200000;
+    std::cout << "\n=== 集合运算测试 (两个各 " << n << " 个键) ===" << std::endl;
+    Set<int> a, b;
+    for (int i = 0; i < n; ++i) {
+        a.insert(a.end(), i * 2);
+        b.insert(b.end(), i * 3);
+    }
+
+    auto time = [](auto&& fn) {
+        auto start = std::chrono::high_resolution_clock::now();
+        fn();
+        auto end = std::chrono::high_resolution_clock::now();
+        return std::chrono::duration<double>(end - start).count();
+    };
+
+    size_t naive_size = 0, merge_size = 0;
+    double naive_inter = time([&]() {
+        Set<int> r;
+        for (int k : a)
+            if (b.find(k) != b.end()) r.insert(k);
+        naive_size += r.size();
+    });
+    double merge_inter = time([&]() { merge_size += set_intersection(a, b).size(); });
+    double naive_union = time([&]() {
+        Set<int> r(a);
+        for (int k : b) r.insert(k);
+        naive_size += r.size();
+    });
+    double merge_union = time([&]() { merge_size += set_union(a, b).size(); });
+    assert(naive_size == merge_size);
+
+    std::cout << std::setw(12) << "" << std::setw(16) << "逐个(秒)" << std::setw(16) << "归并(秒)"
+              << std::endl;
+    std::cout << std::fixed << std::setprecision(6) << std::setw(12) << "交集" << std::setw(16)
+              << naive_inter << std::setw(16) << merge_inter << std::endl;
+    std::cout << std::setw(12) << "并集" << std::setw(16) << naive_union << std::setw(16)
+              << merge_union << std::endl;
+}
+
+// 取百分位：从 begin() 向前走 k 步 vs select(k)
+void benchmark_percentile() {
+    const int n = 200000;
+    const int queries = 200;
+    std::cout << "\n=== 百分位查询测试 (" << n << " 个键, " << queries << " 次) ===" << std::endl;
+    Set<int> plain;
+    Set<int, Less<int>, thread_safe_alloc, true> ranked;
+    std::vector<int> keys(n);
+    for (int i = 0; i < n; ++i) keys[i] = i;
+    std::shuffle(keys.begin(), keys.end(), std::mt19937(31));
+    for (int k : keys) {
+        plain.insert(k);
+        ranked.insert(k);
+    }
+
+    auto time = [](auto&& fn) {
+        auto start = std::chrono::high_resolution_clock::now();
+        fn();
+        auto end = std::chrono::high_resolution_clock::now();
+        return std::chrono::duration<double>(end - start).count();
+    };
+
+    long long sum_walk = 0, sum_select = 0;
+    double walk = time([&]() {
+        for (int q = 0; q < queries; ++q) {
+            auto it = plain.begin();
+            for (long long k = static_cast<long long>(n - 1) * q / queries; k > 0; --k)
+                ++it;
+            sum_walk += *it;
+        }
+    });
+    double select = time([&]() {
+        for (int q = 0; q < queries; ++q)
+            sum_select += *ranked.select(static_cast<long long>(n - 1) * q / queries);
+    });
+    assert(sum_walk == sum_select);
+
+    std::cout << std::setw(16) << "迭代器前进(秒)" << std::setw(16) << "select(秒)" << std::endl;
+    std::cout << std::fixed << std::setprecision(6) << std::setw(16) << walk << std::setw(16)
+              << select << std::endl;
+}
+
+// 重新分片：把一半的键从一个 Set 搬到另一个，erase + insert vs extract + insert
+void benchmark_reshard() {
+    const int n = 200000;
+    std::cout << "\n=== 重新分片测试 (" << n / 2 << " 个 string 键) ===" << std::endl;
+    std::vector<std::string> keys;
+    for (int i = 0; i < n; ++i)
+        keys.push_back("shard-entry/" + std::to_string(i) + "/payload-padding-to-avoid-sso");
+
+    auto time = [](auto&& fn) {
+        auto start = std::chrono::high_resolution_clock::now();
+        fn();
+        auto end = std::chrono::high_resolution_clock::now();
+        return std::chrono::duration<double>(end - start).count();
+    };
+
+    Set<std::string> src1(keys.begin(), keys.end()), src2(src1), dst1, dst2;
+    double copy = time([&]() {
+        for (auto it = src1.begin(); it != src1.end();) {
+            dst1.insert(*it);
+            auto next = it;
+            ++next;
+            src1.erase(it);
+            if (next == src1.end())
+                break;
+            it = next;
+            ++it;
+        }
+    });
+    double relink = time([&]() {
+        for (auto it = src2.begin(); it != src2.end();) {
+            auto next = it;
+            ++next;
+            dst2.insert(src2.extract(it));
+            if (next == src2.end())
+                break;
+            it = next;
+            ++it;
+        }
+    });
+    assert(dst1 == dst2 && src1 == src2 && dst1.size() == static_cast<size_t>(n / 2));
+
+    std::cout << std::setw(20) << "erase + insert(秒)" << std::setw(20) << "extract + insert(秒)"
+              << std::endl;
+    std::cout << std::fixed << std::setprecision(6) << std::setw(20) << copy << std::setw(20)
+              << relink << std::endl;
+}
+
 int main() {
     std::cout << "开始测试 mstl::Set..." << std::endl;
     try {
@@ -133,6 +631,18 @@ int main() {
         test_copy_and_move();
         test_comparisons();
         test_iterator_validity();
+        test_allocator();
+        test_multiset();
+        test_set_algebra();
+        test_order_statistic();
+        test_node_handle();
+        benchmark_node_allocation();
+        benchmark_string_lookup();
+        benchmark_sorted_load();
+        benchmark_hinted_insert();
+        benchmark_set_algebra();
+        benchmark_percentile();
+        benchmark_reshard();
         std::cout << "\n所有测试通过!" << std::endl;
         return 0;
     } catch (const std::exception& e) {
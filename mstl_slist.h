@@ -96,35 +96,40 @@ public:
 
     using Iterator = SlistIterator<T, T&, T*>;
     using ConstIterator = SlistIterator<T, const T&, const T*>;
+    using AllocatorType = Alloc;
 
 private:
     using ListNode = SlistNode<T>;
     using ListNodeAllocator = SimpleAlloc<ListNode, Alloc>;
 
-    static ListNode* create_node(const ValueType& x) {
-        ListNode* node = ListNodeAllocator::allocate();
+    ListNode* create_node(const ValueType& x) {
+        ListNode* node = node_allocator.allocate();
         try {
             construct(&node->data, x);
             node->next = 0;
         } catch (...) {
-            ListNodeAllocator::deallocate(node);
+            node_allocator.deallocate(node);
             throw;
         }
         return node;
     }
 
-    static void destroy_node(ListNode* node) {
+    void destroy_node(ListNode* node) {
         destroy(&node->data);
-        ListNodeAllocator::deallocate(node);
+        node_allocator.deallocate(node);
     }
 
 private:
+    [[no_unique_address]] ListNodeAllocator node_allocator;
     ListNode head;
 
 public:
     Slist() {
         head.next = nullptr;
     }
+    explicit Slist(const Alloc& a) : node_allocator(a) {
+        head.next = nullptr;
+    }
     ~Slist() {
         clear();
     }
@@ -145,7 +150,13 @@ public:
         return head.next == nullptr;
     }
 
+    AllocatorType get_allocator() const {
+        return node_allocator.rawAllocator();
+    }
+
+    // 分配器只在 PropagateOnContainerSwap 时交换，否则两个分配器必须相等
     void swap(Slist& L) {
+        propagateOnSwap(node_allocator, L.node_allocator);
         ListNode* tmp = head.next;
         head.next = L.head.next;
         L.head.next = tmp;
@@ -2,8 +2,11 @@
 #define __MSGI_STL_INTERNAL_TREE_H
 
 #include <cstddef>
+#include <type_traits>
 #include "mstl_iterator_tags.h"
 #include "mstl_alloc.h"
+#include "mstl_allocator.h"
+#include "mstl_concepts.h"
 #include "mstl_construct.h"
 #include "mstl_pair.h"
 #include "mstl_iterator.h"
@@ -47,6 +50,13 @@ struct RbTreeNode : public RbTreeNodeBase {
     ValueType value_field;
 };
 
+// 带子树大小的节点：subtree_size 放在 value_field 之后，指向它的指针可以直接当 RbTreeNode<Value>* 用，
+// 迭代器与 RbTreeNode 的布局都不受影响
+template <typename Value>
+struct RbTreeSizedNode : public RbTreeNode<Value> {
+    size_t subtree_size;
+};
+
 struct RbTreeBaseIterator {
     using BasePtr = RbTreeNodeBase::BasePtr;
     using IteratorCategory = BidirectionalIteratorTag;
@@ -134,17 +144,123 @@ struct RbTreeIterator : public RbTreeBaseIterator {
     bool operator==(const Self& x) const { return node == x.node; }
 };
 
-template <typename Key, typename Value, typename KeyOfValue, typename Compare, typename Alloc = SimpleAlloc<Value, MallocAllocTemplate<0>>>
+namespace detail {
+// 红黑树节点的分配器：Alloc 按类型分配 (提供 RebindAlloc，例如 SimpleAlloc) 时 rebind 到节点类型，
+// 按字节分配 (DefaultAllocTemplate、ArenaRef 等) 时封装成 SimpleAlloc<Node, Alloc>
+template <typename Alloc, typename Node, typename = void>
+struct RbTreeNodeAlloc {
+    using type = SimpleAlloc<Node, Alloc>;
+};
+
+template <typename Alloc, typename Node>
+struct RbTreeNodeAlloc<Alloc, Node, std::void_t<typename Alloc::template RebindAlloc<Node>::Other>> {
+    using type = typename Alloc::template RebindAlloc<Node>::Other;
+};
+}  // namespace detail
+
+// 有序输入的标记：调用者保证输入按 Compare 严格递增 (kSortedUnique) 或非递减 (kSortedEquivalent)
+struct SortedUniqueT {
+    explicit SortedUniqueT() = default;
+};
+inline constexpr SortedUniqueT kSortedUnique{};
+
+struct SortedEquivalentT {
+    explicit SortedEquivalentT() = default;
+};
+inline constexpr SortedEquivalentT kSortedEquivalent{};
+
+template <typename Key, typename Value, typename KeyOfValue, typename Compare, typename Alloc, bool OrderStatistic>
+class RbTree;
+
+// extract() 取出的节点：持有一个已从树上摘下的节点，可以原样插入另一棵分配器相等的树，
+// 整个过程不分配、不拷贝值；句柄析构时仍持有节点则销毁它
+template <typename Value, typename NodeType, typename NodeAllocator>
+class RbTreeNodeHandle {
+public:
+    using ValueType = Value;
+
+    RbTreeNodeHandle() : node(0) {}
+
+    RbTreeNodeHandle(RbTreeNodeHandle&& x) noexcept : node(x.node), node_allocator(x.node_allocator) {
+        x.node = 0;
+    }
+
+    RbTreeNodeHandle& operator=(RbTreeNodeHandle&& x) noexcept {
+        if (this != &x) {
+            reset();
+            node = x.node;
+            node_allocator = x.node_allocator;
+            x.node = 0;
+        }
+        return *this;
+    }
+
+    ~RbTreeNodeHandle() { reset(); }
+
+    bool empty() const { return node == 0; }
+    explicit operator bool() const { return node != 0; }
+
+    // Set 的节点也可以修改，改完键再插回去
+    ValueType& value() const { return node->value_field; }
+
+    void swap(RbTreeNodeHandle& x) noexcept {
+        std::swap(node, x.node);
+        std::swap(node_allocator, x.node_allocator);
+    }
+
+private:
+    template <typename K, typename V, typename KoV, typename C, typename A, bool OS>
+    friend class RbTree;
+
+    RbTreeNodeHandle(NodeType* x, const NodeAllocator& a) : node(x), node_allocator(a) {}
+
+    NodeType* release() {
+        NodeType* x = node;
+        node = 0;
+        return x;
+    }
+
+    void reset() {
+        if (node) {
+            destroy(&node->value_field);
+            node_allocator.deallocate(node);
+            node = 0;
+        }
+    }
+
+    NodeType* node;
+    [[no_unique_address]] NodeAllocator node_allocator;
+};
+
+// 插入节点句柄的结果：没有插入时节点留在 node 中交还给调用者
+template <typename Iterator, typename NodeHandle>
+struct RbTreeInsertReturn {
+    Iterator position;
+    bool inserted;
+    NodeHandle node;
+};
+
+// 默认从带线程缓存的内存池分配节点，插入/删除不再每个节点一次 malloc/free
+// OrderStatistic 为 true 时每个节点额外记录子树大小，提供 O(log n) 的 select/rank；
+// 为 false (默认) 时节点仍是 RbTreeNode<Value>，布局与开销都不变
+template <typename Key, typename Value, typename KeyOfValue, typename Compare, typename Alloc = thread_safe_alloc,
+          bool OrderStatistic = false>
 class RbTree {
+    template <typename K, typename V, typename KoV, typename C, typename A, bool OS>
+    friend class RbTree;
+
 public:
     using SizeType = size_t;
+    using AllocatorType = Alloc;
 protected:
     using BasePtr = RbTreeNodeBase::BasePtr;
     using LinkType = RbTreeNode<Value>*;
-    using RbTreeNodeAllocator = SimpleAlloc<RbTreeNode<Value>, MallocAllocTemplate<0>>;
+    using NodeType = std::conditional_t<OrderStatistic, RbTreeSizedNode<Value>, RbTreeNode<Value>>;
+    using RbTreeNodeAllocator = typename detail::RbTreeNodeAlloc<Alloc, NodeType>::type;
     using Reference = Value&;
     using ColorType = RbTreeNodeBase::ColorType;
 
+    [[no_unique_address]] RbTreeNodeAllocator node_allocator;
     LinkType header;
     SizeType node_count;
     Compare key_compare;
@@ -157,22 +273,26 @@ protected:
     static LinkType& right(LinkType x) { return reinterpret_cast<LinkType&>(x->right); }
     static LinkType& parent(LinkType x) { return reinterpret_cast<LinkType&>(x->parent); }
     static Reference value(LinkType x) { return x->value_field; }
-    static const Key& key(LinkType x) { 
-        static Key k = KeyOfValue()(value(x));
-        k = KeyOfValue()(value(x));
-        return k;
-    }
+    // 直接返回 value_field 中的键 (KeyOfValue 返回引用时就是引用)，查找路径上不拷贝键
+    static decltype(auto) key(LinkType x) { return KeyOfValue()(value(x)); }
     static ColorType& color(LinkType x) { return x->color; }
     static LinkType minimum(LinkType x) { return reinterpret_cast<LinkType>(RbTreeNodeBase::minimum(x)); }
     static LinkType maximum(LinkType x) { return reinterpret_cast<LinkType>(RbTreeNodeBase::maximum(x)); }
 
-    LinkType get_node() { return RbTreeNodeAllocator::allocate(); }
-    void put_node(LinkType p) { RbTreeNodeAllocator::deallocate(p); }
+    // 只在 OrderStatistic 时使用
+    static SizeType& subtree_size(BasePtr x) {
+        return static_cast<NodeType*>(static_cast<LinkType>(x))->subtree_size;
+    }
+    static SizeType __size(BasePtr x) { return x ? subtree_size(x) : 0; }
 
-    LinkType create_node(const Value& x) {
+    LinkType get_node() { return node_allocator.allocate(); }
+    void put_node(LinkType p) { node_allocator.deallocate(static_cast<NodeType*>(p)); }
+
+    template <typename... Args>
+    LinkType create_node(Args&&... args) {
         LinkType tmp = get_node();
         try {
-            construct(&tmp->value_field, x);
+            construct(&tmp->value_field, std::forward<Args>(args)...);
         } catch(...) {
             put_node(tmp);
             throw;
@@ -185,6 +305,8 @@ protected:
         tmp->color = x->color;
         tmp->left = 0;
         tmp->right = 0;
+        if constexpr (OrderStatistic)
+            subtree_size(tmp) = subtree_size(x);
         return tmp;
     }
 
@@ -258,6 +380,10 @@ protected:
             x->parent->right = y;
         y->left = x;
         x->parent = y;
+        if constexpr (OrderStatistic) {
+            subtree_size(y) = subtree_size(x);
+            subtree_size(x) = __size(x->left) + __size(x->right) + 1;
+        }
     }
 
     void __rb_tree_rotate_right(BasePtr x, BasePtr& root) {
@@ -274,6 +400,10 @@ protected:
             x->parent->left = y;
         y->right = x;
         x->parent = y;
+        if constexpr (OrderStatistic) {
+            subtree_size(y) = subtree_size(x);
+            subtree_size(x) = __size(x->left) + __size(x->right) + 1;
+        }
     }
 
     LinkType __copy(LinkType x, LinkType p) {
@@ -311,12 +441,6 @@ protected:
         }
     }
 
-    void swap(RbTree& x) {
-        std::swap(header, x.header);
-        std::swap(node_count, x.node_count);
-        std::swap(key_compare, x.key_compare);
-    }
-
     BasePtr __rb_tree_rebalance_for_erase(BasePtr z, BasePtr& root) {
         BasePtr y = z;
         BasePtr x = 0;
@@ -333,6 +457,13 @@ protected:
             x = y->right;
         }
 
+        // y 是真正离开原位置的节点：它上方直到根的每个子树都少一个节点，
+        // y != z 时 z 也在这条路径上，y 接替 z 后沿用 z 减一后的大小
+        if constexpr (OrderStatistic) {
+            for (BasePtr p = y->parent; p != header; p = p->parent)
+                --subtree_size(p);
+        }
+
         if (y != z) {
             z->left->parent = y;
             y->left = z->left;
@@ -355,6 +486,8 @@ protected:
                 z->parent->right = y;
             y->parent = z->parent;
             std::swap(y->color, z->color);
+            if constexpr (OrderStatistic)
+                subtree_size(y) = subtree_size(z);
             y = z;
         }
         else {
@@ -459,13 +592,17 @@ public:
     using ConstIterator = RbTreeIterator<Value, ConstReference, ConstPointer>;
     using ReverseIterator = mstl::ReverseIterator<Iterator>;
     using ConstReverseIterator = mstl::ReverseIterator<ConstIterator>;
+    using NodeHandle = RbTreeNodeHandle<Value, NodeType, RbTreeNodeAllocator>;
+    using InsertReturn = RbTreeInsertReturn<Iterator, NodeHandle>;
 
-    RbTree(const Compare& comp = Compare())
-    : node_count(0), key_compare(comp) {
+    RbTree(const Compare& comp = Compare(), const Alloc& a = Alloc())
+    : node_allocator(a), node_count(0), key_compare(comp) {
         init();
     }
 
-    RbTree(const RbTree& x) : node_count(0), key_compare(x.key_compare) {
+    RbTree(const RbTree& x)
+    : node_allocator(AllocatorTraits<RbTreeNodeAllocator>::select_on_container_copy_construction(x.node_allocator)),
+      node_count(0), key_compare(x.key_compare) {
         init();
         if (x.root() != 0) {
             try {
@@ -486,6 +623,15 @@ public:
             clear();
             node_count = 0;
             key_compare = x.key_compare;
+            if (AllocatorTraits<RbTreeNodeAllocator>::PropagateOnContainerCopyAssignment::value &&
+                node_allocator != x.node_allocator) {
+                // header 要用新的分配器重新分配
+                put_node(header);
+                propagateOnCopyAssignment(node_allocator, x.node_allocator);
+                init();
+            } else {
+                propagateOnCopyAssignment(node_allocator, x.node_allocator);
+            }
             
             try {
                 if (x.root() != 0) {
@@ -511,6 +657,12 @@ public:
     }
 
     Compare key_comp() const { return key_compare; }
+    AllocatorType get_allocator() const {
+        if constexpr (std::is_same_v<RbTreeNodeAllocator, SimpleAlloc<NodeType, Alloc>>)
+            return node_allocator.rawAllocator();
+        else
+            return AllocatorType(node_allocator);
+    }
     Iterator begin() { return leftmost(); }
     Iterator end() { return header; }
     ConstIterator begin() const { return leftmost(); }
@@ -527,42 +679,164 @@ public:
     SizeType size() const { return node_count; }
     SizeType max_size() const { return SizeType(-1); }
 
-    Pair<Iterator, bool> insert_unique(const Value& v) {
-        LinkType y = header;
-        LinkType x = root();
-        bool comp = true;
-        while (x != 0) {
-            y = x;
-            comp = key_compare(KeyOfValue()(v), key(x));
-            x = comp ? left(x) : right(x);
-        }
+    // 分配器只在 PropagateOnContainerSwap 时交换，否则两个分配器必须相等
+    void swap(RbTree& x) {
+        propagateOnSwap(node_allocator, x.node_allocator);
+        std::swap(header, x.header);
+        std::swap(node_count, x.node_count);
+        std::swap(key_compare, x.key_compare);
+    }
 
-        Iterator j = Iterator(y);
-        if (comp) {
-            if (j == begin())
-                return Pair<Iterator, bool>(__insert(x, y, v), true);
-            else
-                --j;
-        }
-        if (key_compare(key(static_cast<LinkType>(j.node)), KeyOfValue()(v)))
-            return Pair<Iterator, bool>(__insert(x, y, v), true);
-        return Pair<Iterator, bool>(j, false);
+    Pair<Iterator, bool> insert_unique(const Value& v) {
+        Pair<LinkType, bool> pos = insert_unique_pos(KeyOfValue()(v));
+        if (!pos.second)
+            return Pair<Iterator, bool>(Iterator(pos.first), false);
+        return Pair<Iterator, bool>(__insert(0, pos.first, v), true);
     }
 
+    // 空树且输入严格递增时 O(n) 直接建成平衡树 (多遍迭代器才会先扫描一遍检查)，否则逐个插入
     template <typename InputIterator>
     void insert_unique(InputIterator first, InputIterator last) {
+        if constexpr (MultiPassIterator<InputIterator>) {
+            if (node_count == 0) {
+                SizeType n = __sorted_length(first, last, true);
+                if (n != SizeType(-1)) {
+                    __build_sorted(first, n);
+                    return;
+                }
+            }
+        }
         for (; first != last; ++first)
-            insert_unique(*first);
+            insert_unique(end(), *first);
+    }
+
+    // 调用者保证输入严格递增：空树时不再检查，直接 O(n) 建树
+    template <typename ForwardIterator>
+    void insert_unique(SortedUniqueT, ForwardIterator first, ForwardIterator last) {
+        if (node_count == 0)
+            __build_sorted(first, __length(first, last));
+        else
+            insert_unique(first, last);
     }
 
     Iterator insert_equal(const ValueType& v) {
-        LinkType y = header;
-        LinkType x = root();
-        while (x != 0) {
-            y = x;
-            x = key_compare(KeyOfValue()(v), key(x)) ? left(x) : right(x);
+        return __insert(0, insert_equal_pos(KeyOfValue()(v)), v);
+    }
+
+    template <typename InputIterator>
+    void insert_equal(InputIterator first, InputIterator last) {
+        if constexpr (MultiPassIterator<InputIterator>) {
+            if (node_count == 0) {
+                SizeType n = __sorted_length(first, last, false);
+                if (n != SizeType(-1)) {
+                    __build_sorted(first, n);
+                    return;
+                }
+            }
+        }
+        for (; first != last; ++first)
+            insert_equal(end(), *first);
+    }
+
+    template <typename ForwardIterator>
+    void insert_equal(SortedEquivalentT, ForwardIterator first, ForwardIterator last) {
+        if (node_count == 0)
+            __build_sorted(first, __length(first, last));
+        else
+            insert_equal(first, last);
+    }
+
+    // 带提示的插入：v 恰好应该插在 position 之前时只比较 position 与它的前驱，
+    // 不从根向下查找，加上插入后的重新平衡，均摊 O(1)；提示不对时退回普通插入
+    // 按递增顺序插入时用 end() 作提示即可
+    Iterator insert_unique(ConstIterator position, const Value& v) {
+        LinkType pos = static_cast<LinkType>(position.node);
+        if (pos == leftmost()) {
+            // begin()
+            if (node_count > 0 && key_compare(KeyOfValue()(v), key(pos)))
+                return __insert(pos, pos, v);
+            return insert_unique(v).first;
+        }
+        if (pos == header) {
+            // end()
+            if (key_compare(key(rightmost()), KeyOfValue()(v)))
+                return __insert(0, rightmost(), v);
+            return insert_unique(v).first;
+        }
+        ConstIterator before = position;
+        --before;
+        LinkType prev = static_cast<LinkType>(before.node);
+        if (key_compare(key(prev), KeyOfValue()(v)) && key_compare(KeyOfValue()(v), key(pos))) {
+            // 前驱没有右孩子时挂在它右边，否则 position 一定没有左孩子
+            if (right(prev) == 0)
+                return __insert(0, prev, v);
+            return __insert(pos, pos, v);
         }
-        return __insert(x, y, v);
+        return insert_unique(v).first;
+    }
+
+    Iterator insert_equal(ConstIterator position, const Value& v) {
+        LinkType pos = static_cast<LinkType>(position.node);
+        if (pos == leftmost()) {
+            if (node_count > 0 && !key_compare(key(pos), KeyOfValue()(v)))
+                return __insert(pos, pos, v);
+            return insert_equal(v);
+        }
+        if (pos == header) {
+            if (!key_compare(KeyOfValue()(v), key(rightmost())))
+                return __insert(0, rightmost(), v);
+            return insert_equal(v);
+        }
+        ConstIterator before = position;
+        --before;
+        LinkType prev = static_cast<LinkType>(before.node);
+        if (!key_compare(KeyOfValue()(v), key(prev)) && !key_compare(key(pos), KeyOfValue()(v))) {
+            if (right(prev) == 0)
+                return __insert(0, prev, v);
+            return __insert(pos, pos, v);
+        }
+        return insert_equal(v);
+    }
+
+    // 先用 args 构造节点再取键查找位置，键已存在时销毁节点
+    template <typename... Args>
+    Pair<Iterator, bool> emplace_unique(Args&&... args) {
+        LinkType z = create_node(std::forward<Args>(args)...);
+        Pair<LinkType, bool> pos;
+        try {
+            pos = insert_unique_pos(key(z));
+        } catch (...) {
+            destroy_node(z);
+            throw;
+        }
+        if (!pos.second) {
+            destroy_node(z);
+            return Pair<Iterator, bool>(Iterator(pos.first), false);
+        }
+        return Pair<Iterator, bool>(__link(pos.first, z), true);
+    }
+
+    template <typename... Args>
+    Iterator emplace_equal(Args&&... args) {
+        LinkType z = create_node(std::forward<Args>(args)...);
+        LinkType y;
+        try {
+            y = insert_equal_pos(key(z));
+        } catch (...) {
+            destroy_node(z);
+            throw;
+        }
+        return __link(y, z);
+    }
+
+    // 调用者已经知道新值的键为 k：先按 k 查找，键已存在时不构造任何值
+    // Map 的 try_emplace/operator[] 用它避免为已存在的键构造 mapped 值
+    template <typename... Args>
+    Pair<Iterator, bool> emplace_unique_key(const Key& k, Args&&... args) {
+        Pair<LinkType, bool> pos = insert_unique_pos(k);
+        if (!pos.second)
+            return Pair<Iterator, bool>(Iterator(pos.first), false);
+        return Pair<Iterator, bool>(__link(pos.first, create_node(std::forward<Args>(args)...)), true);
     }
 
     void clear() {
@@ -575,81 +849,348 @@ public:
         }
     }
 
-    Iterator find(const Key& k) {
-        LinkType x = root();
+    // 先找到第一个不小于 k 的节点，每层只比较一次，最后再比较一次判断是否相等
+    Iterator find(const Key& k) { return Iterator(find_node(k)); }
+    ConstIterator find(const Key& k) const { return ConstIterator(find_node(k)); }
 
-        while (x != 0) {
-            if (key_compare(key(x), k)) {
-                x = right(x);
-            } else if (key_compare(k, key(x))) {
-                x = left(x);
-            } else {
-                return Iterator(x);
+    SizeType count(const Key& k) const { return count_range(equal_range(k)); }
+
+    Pair<Iterator, Iterator> equal_range(const Key& k) {
+        return Pair<Iterator, Iterator>(lower_bound(k), upper_bound(k));
+    }
+
+    Pair<ConstIterator, ConstIterator> equal_range(const Key& k) const {
+        return Pair<ConstIterator, ConstIterator>(lower_bound(k), upper_bound(k));
+    }
+
+    Iterator lower_bound(const Key& k) { return Iterator(lower_bound_node(k)); }
+    ConstIterator lower_bound(const Key& k) const { return ConstIterator(lower_bound_node(k)); }
+    Iterator upper_bound(const Key& k) { return Iterator(upper_bound_node(k)); }
+    ConstIterator upper_bound(const Key& k) const { return ConstIterator(upper_bound_node(k)); }
+
+    // 透明比较器 (例如 Less<>) 下的异构查找：k 只需能与键比较，不必构造 Key
+    template <typename K>
+        requires TransparentCompare<Compare>
+    Iterator find(const K& k) { return Iterator(find_node(k)); }
+
+    template <typename K>
+        requires TransparentCompare<Compare>
+    ConstIterator find(const K& k) const { return ConstIterator(find_node(k)); }
+
+    template <typename K>
+        requires TransparentCompare<Compare>
+    SizeType count(const K& k) const { return count_range(equal_range(k)); }
+
+    template <typename K>
+        requires TransparentCompare<Compare>
+    Pair<Iterator, Iterator> equal_range(const K& k) {
+        return Pair<Iterator, Iterator>(lower_bound(k), upper_bound(k));
+    }
+
+    template <typename K>
+        requires TransparentCompare<Compare>
+    Pair<ConstIterator, ConstIterator> equal_range(const K& k) const {
+        return Pair<ConstIterator, ConstIterator>(lower_bound(k), upper_bound(k));
+    }
+
+    template <typename K>
+        requires TransparentCompare<Compare>
+    Iterator lower_bound(const K& k) { return Iterator(lower_bound_node(k)); }
+
+    template <typename K>
+        requires TransparentCompare<Compare>
+    ConstIterator lower_bound(const K& k) const { return ConstIterator(lower_bound_node(k)); }
+
+    template <typename K>
+        requires TransparentCompare<Compare>
+    Iterator upper_bound(const K& k) { return Iterator(upper_bound_node(k)); }
+
+    template <typename K>
+        requires TransparentCompare<Compare>
+    ConstIterator upper_bound(const K& k) const { return ConstIterator(upper_bound_node(k)); }
+
+    void erase(Iterator position) {
+        LinkType y = static_cast<LinkType>(position.node);
+        __unlink(y);
+        destroy_node(y);
+    }
+
+    SizeType erase(const Key& x) {
+        Pair<Iterator, Iterator> p = equal_range(x);
+        SizeType n = mstl::distance(p.first, p.second);
+        erase(p.first, p.second);
+        return n;
+    }
+
+    void erase(Iterator first, Iterator last) {
+        if (first == begin() && last == end())
+            clear();
+        else {
+            while (first != last)
+                erase(first++);
+        }
+    }
+
+    void erase(ConstIterator position) {
+        erase(Iterator(static_cast<LinkType>(position.node)));
+    }
+
+    void erase(ConstIterator first, ConstIterator last) {
+        while (first != last)
+            erase(first++);
+    }
+
+    // 把节点从树上摘下交给句柄，不销毁值也不释放内存
+    NodeHandle extract(ConstIterator position) {
+        LinkType z = static_cast<LinkType>(position.node);
+        __unlink(z);
+        return NodeHandle(static_cast<NodeType*>(z), node_allocator);
+    }
+
+    NodeHandle extract(const Key& k) {
+        Iterator it = find(k);
+        if (it == end())
+            return NodeHandle();
+        return extract(it);
+    }
+
+    // 把句柄中的节点直接挂到树上；nh 的分配器必须与本树相等
+    InsertReturn insert_unique(NodeHandle&& nh) {
+        if (nh.empty())
+            return InsertReturn{end(), false, NodeHandle()};
+        Pair<LinkType, bool> pos = insert_unique_pos(KeyOfValue()(nh.value()));
+        if (!pos.second)
+            return InsertReturn{Iterator(pos.first), false, std::move(nh)};
+        return InsertReturn{__link(pos.first, nh.release()), true, NodeHandle()};
+    }
+
+    Iterator insert_equal(NodeHandle&& nh) {
+        if (nh.empty())
+            return end();
+        LinkType y = insert_equal_pos(KeyOfValue()(nh.value()));
+        return __link(y, nh.release());
+    }
+
+    // 把 src 中的节点逐个摘下挂到本树上，键已存在的留在 src 中；
+    // src 的比较器可以不同，但两棵树的分配器必须相等
+    template <typename C2>
+    void merge_unique(RbTree<Key, Value, KeyOfValue, C2, Alloc, OrderStatistic>& src) {
+        if (static_cast<void*>(&src) == static_cast<void*>(this))
+            return;
+        for (auto it = src.begin(); it != src.end();) {
+            LinkType z = static_cast<LinkType>(it.node);
+            ++it;
+            Pair<LinkType, bool> pos = insert_unique_pos(key(z));
+            if (pos.second) {
+                src.__unlink(z);
+                __link(pos.first, z);
             }
         }
-        return end();
     }
 
-    SizeType count(const Key& k) const {
-        Pair<ConstIterator, ConstIterator> p = equal_range(k);
+    template <typename C2>
+    void merge_equal(RbTree<Key, Value, KeyOfValue, C2, Alloc, OrderStatistic>& src) {
+        if (static_cast<void*>(&src) == static_cast<void*>(this))
+            return;
+        for (auto it = src.begin(); it != src.end();) {
+            LinkType z = static_cast<LinkType>(it.node);
+            ++it;
+            LinkType y = insert_equal_pos(key(z));
+            src.__unlink(z);
+            __link(y, z);
+        }
+    }
+
+    // 顺序统计 (OrderStatistic 为 true 时可用)，都是 O(log n)
+    // select(k)：第 k 小 (从 0 开始) 的元素，k >= size() 时返回 end()
+    Iterator select(SizeType k) requires OrderStatistic { return Iterator(select_node(k)); }
+    ConstIterator select(SizeType k) const requires OrderStatistic { return ConstIterator(select_node(k)); }
+
+    // rank(k)：小于 k 的元素个数，也就是 lower_bound(k) 在序列中的下标
+    SizeType rank(const Key& k) const requires OrderStatistic { return rank_aux(k); }
+
+    template <typename K>
+        requires (OrderStatistic && TransparentCompare<Compare>)
+    SizeType rank(const K& k) const { return rank_aux(k); }
+
+
+    // 检查红黑树性质：根为黑、红节点没有红孩子、每条路径上的黑节点数相同、键有序、leftmost/rightmost 正确
+    bool __rb_verify() const {
+        if (node_count == 0 || begin() == end())
+            return node_count == 0 && begin() == end() && leftmost() == header && rightmost() == header;
+
+        SizeType len = __black_count(leftmost(), root());
         SizeType n = 0;
-        ConstIterator first = p.first;
-        while (first != p.second) {
-            ++n;
-            ++first;
+        for (ConstIterator it = begin(); it != end(); ++it, ++n) {
+            LinkType x = static_cast<LinkType>(it.node);
+            LinkType l = left(x);
+            LinkType r = right(x);
+            if (color(x) == __rb_tree_red) {
+                if ((l && color(l) == __rb_tree_red) || (r && color(r) == __rb_tree_red))
+                    return false;
+            }
+            if (l && key_compare(key(x), key(l)))
+                return false;
+            if (r && key_compare(key(r), key(x)))
+                return false;
+            if ((!l || !r) && __black_count(x, root()) != len)
+                return false;
+            if constexpr (OrderStatistic) {
+                if (subtree_size(x) != __size(l) + __size(r) + 1)
+                    return false;
+            }
         }
-        return n;
+        return n == node_count && color(root()) == __rb_tree_black &&
+               leftmost() == minimum(root()) && rightmost() == maximum(root());
     }
 
-    Pair<ConstIterator, ConstIterator> equal_range(const Key& k) const {
-        return Pair<ConstIterator, ConstIterator>(lower_bound(k), upper_bound(k));
+    // 正确的模板友元声明，允许 operator<< 访问 protected 成员
+    template <typename K, typename V, typename KoV, typename C, typename A, bool OS>
+    friend std::ostream& operator<<(std::ostream&, const RbTree<K, V, KoV, C, A, OS>&);
+
+private:
+    // 把节点 z 从树上摘下并重新平衡，不销毁
+    void __unlink(LinkType z) {
+        __rb_tree_rebalance_for_erase(z, header->parent);
+        --node_count;
     }
 
-    Iterator lower_bound(const Key& k) {
-        LinkType y = header;
+    LinkType select_node(SizeType k) const {
         LinkType x = root();
-
         while (x != 0) {
-            if (!key_compare(key(x), k)) {
-                y = x;
+            SizeType l = __size(x->left);
+            if (k < l)
                 x = left(x);
-            }
-            else
+            else if (k == l)
+                return x;
+            else {
+                k -= l + 1;
                 x = right(x);
+            }
         }
-        return Iterator(y);
+        return header;
     }
 
-    ConstIterator lower_bound(const Key& k) const {
-        LinkType y = header;
+    template <typename K>
+    SizeType rank_aux(const K& k) const {
+        SizeType r = 0;
         LinkType x = root();
         while (x != 0) {
-            if (!key_compare(key(x), k)) {
-                y = x;
-                x = left(x);
+            if (key_compare(key(x), k)) {
+                r += __size(x->left) + 1;
+                x = right(x);
             }
             else
-                x = right(x);
+                x = left(x);
         }
-        return ConstIterator(y);
+        return r;
     }
 
-    Iterator upper_bound(const Key& k) {
+    static SizeType __black_count(LinkType node, LinkType root) {
+        SizeType sum = 0;
+        for (;;) {
+            if (color(node) == __rb_tree_black)
+                ++sum;
+            if (node == root)
+                return sum;
+            node = parent(node);
+        }
+    }
+
+    template <typename ForwardIterator>
+    static SizeType __length(ForwardIterator first, ForwardIterator last) {
+        SizeType n = 0;
+        for (; first != last; ++first)
+            ++n;
+        return n;
+    }
+
+    // 输入的元素就是 Value 且按键有序 (strict 时严格递增) 时返回元素个数，否则返回 SizeType(-1)
+    template <typename ForwardIterator>
+    SizeType __sorted_length(ForwardIterator first, ForwardIterator last, bool strict) const {
+        if constexpr (!std::is_same_v<std::remove_cvref_t<decltype(*first)>, Value>) {
+            return SizeType(-1);
+        } else {
+            if (first == last)
+                return 0;
+            SizeType n = 1;
+            for (ForwardIterator next = first; ++next != last; first = next, ++n) {
+                if (strict ? !key_compare(KeyOfValue()(*first), KeyOfValue()(*next))
+                           : key_compare(KeyOfValue()(*next), KeyOfValue()(*first)))
+                    return SizeType(-1);
+            }
+            return n;
+        }
+    }
+
+    // 空树中从 n 个有序元素直接建树：每个子树取中间元素为根，左右子树大小最多相差 1，
+    // 所以只有最深一层可能不满；这一层的节点涂红，其余涂黑，每条路径的黑节点数都相同
+    template <typename ForwardIterator>
+    void __build_sorted(ForwardIterator first, SizeType n) {
+        if (n == 0)
+            return;
+        SizeType depth = 0;
+        while ((SizeType(2) << depth) <= n)
+            ++depth;
+        bool perfect = ((n + 1) & n) == 0;
+        root() = __build(first, n, 0, perfect ? SizeType(-1) : depth);
+        parent(root()) = header;
+        leftmost() = minimum(root());
+        rightmost() = maximum(root());
+        node_count = n;
+    }
+
+    // 按中序从 first 取 n 个元素建子树，深度为 red_depth 的节点涂红
+    template <typename ForwardIterator>
+    LinkType __build(ForwardIterator& first, SizeType n, SizeType depth, SizeType red_depth) {
+        if (n == 0)
+            return 0;
+        SizeType left_n = (n - 1) / 2;
+        LinkType l = __build(first, left_n, depth + 1, red_depth);
+        LinkType x;
+        try {
+            x = create_node(*first);
+        } catch (...) {
+            __erase(l);
+            throw;
+        }
+        ++first;
+        left(x) = l;
+        right(x) = 0;
+        if constexpr (OrderStatistic)
+            subtree_size(x) = n;
+        if (l)
+            parent(l) = x;
+        color(x) = depth == red_depth ? __rb_tree_red : __rb_tree_black;
+        try {
+            LinkType r = __build(first, n - 1 - left_n, depth + 1, red_depth);
+            right(x) = r;
+            if (r)
+                parent(r) = x;
+        } catch (...) {
+            __erase(x);
+            throw;
+        }
+        return x;
+    }
+
+    template <typename K>
+    LinkType lower_bound_node(const K& k) const {
         LinkType y = header;
         LinkType x = root();
-
         while (x != 0) {
-            if (key_compare(k, key(x))) {
+            if (!key_compare(key(x), k)) {
                 y = x;
                 x = left(x);
             }
             else
                 x = right(x);
         }
-        return Iterator(y);
+        return y;
     }
 
-    ConstIterator upper_bound(const Key& k) const {
+    template <typename K>
+    LinkType upper_bound_node(const K& k) const {
         LinkType y = header;
         LinkType x = root();
         while (x != 0) {
@@ -660,53 +1201,64 @@ public:
             else
                 x = right(x);
         }
-        return ConstIterator(y);
+        return y;
     }
 
-    void erase(Iterator position) {
-        BasePtr y = __rb_tree_rebalance_for_erase(position.node, header->parent);
-        destroy_node(static_cast<LinkType>(y));
-        --node_count;
+    template <typename K>
+    LinkType find_node(const K& k) const {
+        LinkType y = lower_bound_node(k);
+        return (y == header || key_compare(k, key(y))) ? header : y;
     }
 
-    SizeType erase(const Key& x) {
-        Pair<Iterator, Iterator> p = equal_range(x);
-        SizeType n = mstl::distance(p.first, p.second);
-        erase(p.first, p.second);
+    static SizeType count_range(Pair<ConstIterator, ConstIterator> p) {
+        SizeType n = 0;
+        for (; p.first != p.second; ++p.first)
+            ++n;
         return n;
     }
 
-    void erase(Iterator first, Iterator last) {
-        if (first == begin() && last == end())
-            clear();
-        else {
-            while (first != last)
-                erase(first++);
+    // 键 k 的插入位置：返回 (新节点的父节点, true)；键已存在时返回 (已有的节点, false)
+    Pair<LinkType, bool> insert_unique_pos(const Key& k) {
+        LinkType y = header;
+        LinkType x = root();
+        bool comp = true;
+        while (x != 0) {
+            y = x;
+            comp = key_compare(k, key(x));
+            x = comp ? left(x) : right(x);
         }
-    }
 
-    void erase(ConstIterator position) {
-        erase(Iterator(static_cast<LinkType>(position.node)));
+        Iterator j = Iterator(y);
+        if (comp) {
+            if (j == begin())
+                return Pair<LinkType, bool>(y, true);
+            else
+                --j;
+        }
+        if (key_compare(key(static_cast<LinkType>(j.node)), k))
+            return Pair<LinkType, bool>(y, true);
+        return Pair<LinkType, bool>(static_cast<LinkType>(j.node), false);
     }
 
-    void erase(ConstIterator first, ConstIterator last) {
-        while (first != last)
-            erase(first++);
+    // 相等的键插在已有的相等键之后
+    LinkType insert_equal_pos(const Key& k) {
+        LinkType y = header;
+        LinkType x = root();
+        while (x != 0) {
+            y = x;
+            x = key_compare(k, key(x)) ? left(x) : right(x);
+        }
+        return y;
     }
 
-
-    // 正确的模板友元声明，允许 operator<< 访问 protected 成员
-    template <typename K, typename V, typename KoV, typename C, typename A>
-    friend std::ostream& operator<<(std::ostream&, const RbTree<K, V, KoV, C, A>&);
-
-private:
     Iterator __insert(BasePtr x_, BasePtr y_, const Value& v) {
-        LinkType x = static_cast<LinkType>(x_);
-        LinkType y = static_cast<LinkType>(y_);
-        LinkType z;
+        return __link(y_, create_node(v), x_ != 0);
+    }
 
-        z = create_node(v);
-        if (y == header || x != 0 || key_compare(KeyOfValue()(v), key(y))) {
+    // 把已构造好的节点 z 挂到 y 下面并重新平衡；force_left 时总是作为左孩子
+    Iterator __link(BasePtr y_, LinkType z, bool force_left = false) {
+        LinkType y = static_cast<LinkType>(y_);
+        if (y == header || force_left || key_compare(key(z), key(y))) {
             left(y) = z;
             if (y == header) {
                 root() = z;
@@ -724,6 +1276,11 @@ private:
         parent(z) = y;
         left(z) = 0;
         right(z) = 0;
+        if constexpr (OrderStatistic) {
+            subtree_size(z) = 1;
+            for (BasePtr p = y; p != header; p = p->parent)
+                ++subtree_size(p);
+        }
         __rb_tree_rebalance(z, header);
         ++node_count;
         return Iterator(z);
@@ -741,8 +1298,9 @@ void print_tree_impl(std::ostream& os, RbTreeNode<Value>* node, RbTreeNode<Value
 }
 }
 
-template <typename Key, typename Value, typename KeyOfValue, typename Compare, typename Alloc>
-std::ostream& operator<<(std::ostream& os, const RbTree<Key, Value, KeyOfValue, Compare, Alloc>& tree) {
+template <typename Key, typename Value, typename KeyOfValue, typename Compare, typename Alloc, bool OrderStatistic>
+std::ostream& operator<<(std::ostream& os,
+                         const RbTree<Key, Value, KeyOfValue, Compare, Alloc, OrderStatistic>& tree) {
     using NodePtr = RbTreeNode<Value>*;
     if (tree.root() == nullptr || tree.header == tree.root()) {
         os << "<empty tree>" << std::endl;
@@ -1,5 +1,10 @@
+#include <cassert>
 #include <iostream>
+#include <list>
+#include <random>
+#include <set>
 #include <string>
+#include <vector>
 #include "mstl_tree.h"
 #include "mstl_pair.h"
 
@@ -157,12 +162,152 @@ void test_copy_operations() {
     std::cout << "清理后原始树大小: " << original_tree.size() << std::endl;
 }
 
+// 有序输入一次建成平衡树，之后的插入/删除仍然保持红黑树性质
+void test_bulk_build() {
+    std::cout << "\n测试有序输入建树..." << std::endl;
+    using Tree = mstl::RbTree<int, int, KeyOfValue, Compare>;
+
+    for (int n = 0; n <= 130; ++n) {
+        std::vector<int> v;
+        for (int i = 0; i < n; ++i)
+            v.push_back(i * 2);
+
+        Tree tree;
+        tree.insert_unique(v.begin(), v.end());
+        assert(tree.size() == static_cast<size_t>(n) && tree.__rb_verify());
+        int expected = 0;
+        for (int x : tree) {
+            assert(x == expected);
+            expected += 2;
+        }
+
+        // 建好的树可以继续插入和删除
+        for (int i = 0; i < n; ++i)
+            tree.insert_unique(i * 2 + 1);
+        assert(tree.size() == static_cast<size_t>(2 * n) && tree.__rb_verify());
+        for (int i = 0; i < n; i += 3)
+            tree.erase(i);
+        assert(tree.__rb_verify());
+    }
+
+    // 有重复键的非递减输入
+    std::vector<int> dup = {1, 1, 2, 3, 3, 3, 4};
+    Tree multi;
+    multi.insert_equal(dup.begin(), dup.end());
+    assert(multi.size() == dup.size() && multi.count(3) == 3 && multi.__rb_verify());
+
+    // 无序输入退回逐个插入，insert_unique 仍然去重
+    std::vector<int> unsorted = {5, 1, 4, 1, 3};
+    Tree fallback;
+    fallback.insert_unique(unsorted.begin(), unsorted.end());
+    assert(fallback.size() == 4 && *fallback.begin() == 1 && fallback.__rb_verify());
+
+    // 调用者声明有序：不检查，直接建树
+    std::list<int> sorted_list = {10, 20, 30, 40, 50};
+    Tree declared;
+    declared.insert_unique(mstl::kSortedUnique, sorted_list.begin(), sorted_list.end());
+    assert(declared.size() == 5 && declared.__rb_verify());
+    assert(*declared.find(30) == 30);
+    std::cout << "有序输入建树测试通过" << std::endl;
+}
+
+// 带提示的插入：提示正确时直接挂到相邻节点上，提示错误时退回普通插入，结果都与 std::multiset 一致
+void test_hinted_insert() {
+    std::cout << "\n测试带提示的插入..." << std::endl;
+    using Tree = mstl::RbTree<int, int, KeyOfValue, Compare>;
+
+    // 递增插入，每次以 end() 为提示
+    Tree ascending;
+    for (int i = 0; i < 1000; ++i)
+        assert(*ascending.insert_unique(ascending.end(), i) == i);
+    assert(ascending.size() == 1000 && ascending.__rb_verify());
+
+    // 递减插入，每次以 begin() 为提示
+    Tree descending;
+    for (int i = 1000; i > 0; --i)
+        descending.insert_equal(descending.begin(), i);
+    assert(descending.size() == 1000 && *descending.begin() == 1 && descending.__rb_verify());
+
+    // 随机的键与随机的提示 (有对有错)
+    std::mt19937 rng(17);
+    Tree unique_tree, equal_tree;
+    std::set<int> unique_ref;
+    std::multiset<int> equal_ref;
+    for (int i = 0; i < 3000; ++i) {
+        int k = static_cast<int>(rng() % 500);
+        int h = static_cast<int>(rng() % 500);
+        Tree::Iterator hint = rng() % 2 ? unique_tree.lower_bound(k) : unique_tree.lower_bound(h);
+        assert(*unique_tree.insert_unique(hint, k) == k);
+        unique_ref.insert(k);
+        Tree::Iterator ehint = rng() % 2 ? equal_tree.upper_bound(k) : equal_tree.lower_bound(h);
+        assert(*equal_tree.insert_equal(ehint, k) == k);
+        equal_ref.insert(k);
+    }
+    assert(unique_tree.__rb_verify() && equal_tree.__rb_verify());
+    assert(unique_tree.size() == unique_ref.size() && equal_tree.size() == equal_ref.size());
+    auto it = equal_ref.begin();
+    for (int x : equal_tree)
+        assert(x == *it++);
+    std::cout << "带提示的插入测试通过" << std::endl;
+}
+
+// 顺序统计：随机插入/删除 (含有序建树、带提示插入、拷贝) 后 select/rank 与 std::multiset 一致
+void test_order_statistic() {
+    std::cout << "\n测试顺序统计..." << std::endl;
+    using Tree = mstl::RbTree<int, int, KeyOfValue, Compare, mstl::thread_safe_alloc, true>;
+    // 关闭时节点布局不变
+    static_assert(sizeof(mstl::RbTreeSizedNode<int>) > sizeof(mstl::RbTreeNode<int>));
+
+    std::vector<int> sorted;
+    for (int i = 0; i < 100; ++i)
+        sorted.push_back(i * 10);
+    Tree tree;
+    tree.insert_equal(sorted.begin(), sorted.end());
+    assert(tree.__rb_verify());
+    assert(*tree.select(0) == 0 && *tree.select(57) == 570 && tree.select(100) == tree.end());
+    assert(tree.rank(0) == 0 && tree.rank(575) == 58 && tree.rank(10000) == 100);
+
+    std::mt19937 rng(29);
+    std::multiset<int> ref(sorted.begin(), sorted.end());
+    for (int i = 0; i < 4000; ++i) {
+        int k = static_cast<int>(rng() % 1000);
+        switch (rng() % 3) {
+        case 0:
+            tree.insert_equal(k);
+            ref.insert(k);
+            break;
+        case 1:
+            tree.insert_equal(tree.lower_bound(k), k);
+            ref.insert(k);
+            break;
+        default:
+            tree.erase(k);
+            ref.erase(k);
+        }
+        if (i % 200 == 0)
+            assert(tree.__rb_verify());
+    }
+    assert(tree.__rb_verify() && tree.size() == ref.size());
+
+    Tree copy(tree);
+    assert(copy.__rb_verify());
+    size_t index = 0;
+    for (auto it = ref.begin(); it != ref.end(); ++it, ++index) {
+        assert(*copy.select(index) == *it);
+        assert(tree.rank(*it) == static_cast<size_t>(std::distance(ref.begin(), ref.lower_bound(*it))));
+    }
+    std::cout << "顺序统计测试通过" << std::endl;
+}
+
 int main() {
     std::cout << "开始测试红黑树..." << std::endl;
     
     try {
         test_basic_operations();
         test_copy_operations();
+        test_bulk_build();
+        test_hinted_insert();
+        test_order_statistic();
     } catch(...) {
         std::cerr << "测试过程中发生异常" << std::endl;
         return 1;
@@ -119,5 +119,27 @@ void uninitialized_fill(ForwardIterator first, ForwardIterator last, const T& x)
     __uninitialized_fill(first, last, x, static_cast<value_type*>(nullptr));
 }
 
+// 值初始化 [first, first + n)：算术、枚举和指针类型的零值就是全零字节，整块 memset
+// 其他类型逐个值初始化，由编译器在可行时合并成 memset
+// (平凡的类里可能有数据成员指针，它的空值在 Itanium ABI 上是全 1)
+template <typename T, std::integral Size>
+T* uninitialized_value_construct_n(T* first, Size n) {
+    if constexpr (std::is_arithmetic_v<T> || std::is_enum_v<T> || std::is_pointer_v<T>) {
+        if (n > 0)
+            std::memset(static_cast<void*>(first), 0, n * sizeof(T));
+        return first + n;
+    } else {
+        T* cur = first;
+        try {
+            for (; n > 0; --n, ++cur)
+                mstl::construct(cur);
+            return cur;
+        } catch (...) {
+            mstl::destroy(first, cur);
+            throw;
+        }
+    }
+}
+
 }  // namespace mstl
 #endif
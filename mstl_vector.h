@@ -2,16 +2,66 @@
 #define __MSGI_STL_INTERNAL_VECTOR_H
 
 #include <algorithm>
+#include <cstring>
+#include <iterator>
+#include <memory>
+#include <stdexcept>
 #include <type_traits>
 #include <utility>
 #include <initializer_list>
 #include "mstl_alloc.h"
+#include "mstl_allocator.h"
+#include "mstl_concepts.h"
 #include "mstl_construct.h"
+#include "mstl_iterator.h"
 #include "mstl_uninitialized.h"
 
 namespace mstl {
 
-template <typename T, typename Alloc = alloc>
+// Vector 的扩容策略：nextCapacity(capacity, required, elemSize) 返回放得下 required 个元素的新容量，
+// kUseSlack 为真时，分配之后把分配器实际给出的多余空间 (尺寸类别向上取整的部分) 也算进容量
+
+// 每次翻倍：复制次数最少，但最多浪费一半空间
+struct DoubleGrowth {
+    static constexpr bool kUseSlack = false;
+
+    static size_t nextCapacity(size_t capacity, size_t required, size_t) {
+        return std::max(required, capacity != 0 ? 2 * capacity : 1);
+    }
+};
+
+// 每次增长一半：最多浪费三分之一，而且之前释放的几块加起来能放下新块，分配器有机会复用
+struct HalfGrowth {
+    static constexpr bool kUseSlack = false;
+
+    static size_t nextCapacity(size_t capacity, size_t required, size_t) {
+        return std::max(required, capacity + (capacity + 1) / 2);
+    }
+};
+
+// 不到一页时翻倍，之后每次增长一半并按页向上取整：大缓冲区总是整页，
+// 页内不留零头，realloc 也更容易原地扩展
+struct PageGrowth {
+    static constexpr bool kUseSlack = false;
+    static constexpr size_t kPageSize = 4096;
+
+    static size_t nextCapacity(size_t capacity, size_t required, size_t elemSize) {
+        size_t n = capacity * elemSize < kPageSize ? DoubleGrowth::nextCapacity(capacity, required, elemSize)
+                                                   : HalfGrowth::nextCapacity(capacity, required, elemSize);
+        size_t bytes = n * elemSize;
+        if (bytes < kPageSize)
+            return n;
+        return ((bytes + kPageSize - 1) & ~(kPageSize - 1)) / elemSize;
+    }
+};
+
+// 按 Base 计算新容量，并使用分配器尺寸类别多出来的空间
+template <typename Base = DoubleGrowth>
+struct SizeClassGrowth : Base {
+    static constexpr bool kUseSlack = true;
+};
+
+template <typename T, typename Alloc = alloc, typename GrowthPolicy = DoubleGrowth>
 class Vector {
 public:
     using ValueType = T;
@@ -23,21 +73,54 @@ public:
     using ConstReference = const ValueType&;
     using SizeType = size_t;
     using DifferenceType = ptrdiff_t;
+    using AllocatorType = Alloc;
+    using GrowthPolicyType = GrowthPolicy;
 
 protected:
     using DataAllocator = SimpleAlloc<ValueType, Alloc>;
 
+    [[no_unique_address]] DataAllocator kDataAllocator;
     Iterator kStart;
     Iterator kFinish;
     Iterator kEndOfStorage;
 
-    // 使用模板和完美转发来同时处理左值和右值
-    template <typename U>
-    void insertAux(Iterator position, U&& x);
+    // 在 position 处用 args 构造一个元素，args 可以引用本 vector 中的元素
+    template <typename... Args>
+    void insertAux(Iterator position, Args&&... args);
 
     void deallocate() {
         if (kStart)
-            DataAllocator::deallocate(kStart, kEndOfStorage - kStart);
+            kDataAllocator.deallocate(kStart, kEndOfStorage - kStart);
+    }
+
+    // 可平凡重定位的元素整块交给 Alloc::reallocate 搬到容量为 n 的新空间：
+    // 不逐个移动和析构，malloc 能原地扩展时连复制都省掉，也不会新旧两块同时占着内存
+    void relocateStorage(SizeType n) {
+        const SizeType oldSize = size();
+        kStart = kDataAllocator.reallocate(kStart, capacity(), n);
+        kFinish = kStart + oldSize;
+        kEndOfStorage = kStart + usableCapacity(kStart, n);
+    }
+
+    // 扩容到至少能放下 required 个元素时的新容量
+    SizeType growCapacity(SizeType required) const {
+        return GrowthPolicy::nextCapacity(capacity(), required, sizeof(T));
+    }
+
+    // 刚分配的 n 个元素的块 p 实际可用的容量
+    SizeType usableCapacity(Iterator p, SizeType n) const {
+        if constexpr (GrowthPolicy::kUseSlack)
+            return kDataAllocator.usableSize(p, n);
+        else
+            return n;
+    }
+
+    // 分配至少 n 个元素的空间，n 更新为实际可用的容量
+    Iterator allocateAtLeast(SizeType& n) {
+        Iterator result = kDataAllocator.allocate(n);
+        if (result != 0)
+            n = usableCapacity(result, n);
+        return result;
     }
 
     void fillInitialize(SizeType n, const T& value) {
@@ -76,31 +159,94 @@ public:
     Reference operator[](SizeType n) {
         return *(begin() + n);
     }
+    ConstReference operator[](SizeType n) const {
+        return *(begin() + n);
+    }
 
     // 构造函数
     Vector() : kStart(nullptr), kFinish(nullptr), kEndOfStorage(nullptr) {}
-    Vector(SizeType n, const T& value) {
+    explicit Vector(const Alloc& a)
+        : kDataAllocator(a), kStart(nullptr), kFinish(nullptr), kEndOfStorage(nullptr) {}
+    Vector(SizeType n, const T& value, const Alloc& a = Alloc()) : kDataAllocator(a) {
         fillInitialize(n, value);
     }
-    Vector(int n, const T& value) {
+    Vector(int n, const T& value, const Alloc& a = Alloc()) : kDataAllocator(a) {
         fillInitialize(n, value);
     }
-    Vector(long n, const T& value) {
+    Vector(long n, const T& value, const Alloc& a = Alloc()) : kDataAllocator(a) {
         fillInitialize(n, value);
     }
-    explicit Vector(SizeType n) {
-        fillInitialize(n, T());
+    explicit Vector(SizeType n, const Alloc& a = Alloc()) : kDataAllocator(a) {
+        kStart = kDataAllocator.allocate(n);
+        try {
+            kFinish = uninitialized_value_construct_n(kStart, n);
+        } catch (...) {
+            kDataAllocator.deallocate(kStart, n);
+            throw;
+        }
+        kEndOfStorage = kFinish;
+    }
+
+    Vector(const Vector& x)
+        : kDataAllocator(AllocatorTraits<DataAllocator>::select_on_container_copy_construction(x.kDataAllocator)) {
+        kStart = allocateAndCopy(x.begin(), x.end());
+        kFinish = kStart + x.size();
+        kEndOfStorage = kFinish;
+    }
+
+    // 直接接管 x 的缓冲区，x 变为空
+    Vector(Vector&& x) noexcept
+        : kDataAllocator(x.kDataAllocator), kStart(x.kStart), kFinish(x.kFinish), kEndOfStorage(x.kEndOfStorage) {
+        x.kStart = x.kFinish = x.kEndOfStorage = nullptr;
+    }
+
+    Vector& operator=(const Vector& x) {
+        if (this != &x) {
+            if (AllocatorTraits<DataAllocator>::PropagateOnContainerCopyAssignment::value &&
+                kDataAllocator != x.kDataAllocator) {
+                // 旧缓冲区只能用原来的分配器释放
+                destroy(kStart, kFinish);
+                deallocate();
+                kStart = kFinish = kEndOfStorage = nullptr;
+            }
+            propagateOnCopyAssignment(kDataAllocator, x.kDataAllocator);
+            assignAux(x.begin(), x.end());
+        }
+        return *this;
+    }
+
+    // 分配器相等或者随移动传播时直接接管 x 的缓冲区，否则只能逐个移动元素
+    Vector& operator=(Vector&& x) noexcept(AllocatorTraits<DataAllocator>::PropagateOnContainerMoveAssignment::value ||
+                                           AllocatorTraits<DataAllocator>::IsAlwaysEqual::value) {
+        if (this == &x)
+            return *this;
+        if (AllocatorTraits<DataAllocator>::PropagateOnContainerMoveAssignment::value ||
+            kDataAllocator == x.kDataAllocator) {
+            destroy(kStart, kFinish);
+            deallocate();
+            propagateOnMoveAssignment(kDataAllocator, x.kDataAllocator);
+            kStart = x.kStart;
+            kFinish = x.kFinish;
+            kEndOfStorage = x.kEndOfStorage;
+            x.kStart = x.kFinish = x.kEndOfStorage = nullptr;
+        } else {
+            clear();
+            reserve(x.size());
+            kFinish = mstl::uninitialized_move(x.kStart, x.kFinish, kStart);
+            x.clear();
+        }
+        return *this;
     }
 
     // 初始化列表构造函数
-    Vector(std::initializer_list<T> il) {
+    Vector(std::initializer_list<T> il, const Alloc& a = Alloc()) : kDataAllocator(a) {
         kStart = allocateAndCopy(il.begin(), il.end());
         kFinish = kStart + il.size();
         kEndOfStorage = kFinish;
     }
 
     template <typename InputIterator>
-    Vector(InputIterator first, InputIterator last) {
+    Vector(InputIterator first, InputIterator last, const Alloc& a = Alloc()) : kDataAllocator(a) {
         kStart = allocateAndCopy(first, last);
         kFinish = kStart + (last - first);
         kEndOfStorage = kFinish;
@@ -111,6 +257,19 @@ public:
         deallocate();
     }
 
+    AllocatorType get_allocator() const {
+        return kDataAllocator.rawAllocator();
+    }
+
+    // 交换两个 vector 的内容；分配器只在 PropagateOnContainerSwap 时交换，
+    // 否则两个分配器必须相等
+    void swap(Vector& x) noexcept {
+        propagateOnSwap(kDataAllocator, x.kDataAllocator);
+        std::swap(kStart, x.kStart);
+        std::swap(kFinish, x.kFinish);
+        std::swap(kEndOfStorage, x.kEndOfStorage);
+    }
+
     Reference front() {
         return *begin();
     }
@@ -167,6 +326,44 @@ public:
         return first;
     }
 
+    Iterator insert(Iterator position, const T& x) {
+        return emplace(position, x);
+    }
+
+    Iterator insert(Iterator position, T&& x) {
+        return emplace(position, std::move(x));
+    }
+
+    // 返回指向新元素的迭代器
+    template <typename... Args>
+    Iterator emplace(Iterator position, Args&&... args) {
+        const SizeType offset = position - kStart;
+        if (position == kFinish && kFinish != kEndOfStorage) {
+            construct(kFinish, std::forward<Args>(args)...);
+            ++kFinish;
+        } else {
+            insertAux(position, std::forward<Args>(args)...);
+        }
+        return kStart + offset;
+    }
+
+    // 在 position 处插入 [first, last)，范围不能指向本 vector
+    // 前向迭代器先算出个数，已有元素只后移一次；单遍迭代器先追加到末尾再旋转到位
+    template <typename I>
+        requires(!std::is_integral_v<I>)
+    Iterator insert(Iterator position, I first, I last) {
+        const SizeType offset = position - kStart;
+        if constexpr (MultiPassIterator<I>) {
+            rangeInsert(position, first, last, rangeLength(first, last));
+        } else {
+            const SizeType oldSize = size();
+            for (; first != last; ++first)
+                push_back(*first);
+            std::rotate(kStart + offset, kStart + oldSize, kFinish);
+        }
+        return kStart + offset;
+    }
+
     // 添加insert实现
     void insert(Iterator position, SizeType n, const T& x) {
         if (n == 0)
@@ -195,9 +392,9 @@ public:
         } else {
             // 备用空间不足，需要重新分配
             const SizeType oldSize = size();
-            const SizeType len = oldSize + std::max(oldSize, n);
+            SizeType len = growCapacity(oldSize + n);
 
-            Iterator newStart = DataAllocator::allocate(len);
+            Iterator newStart = allocateAtLeast(len);
             Iterator newFinish = newStart;
 
             try {
@@ -206,7 +403,7 @@ public:
                 newFinish = uninitialized_copy(position, kFinish, newFinish);
             } catch (...) {
                 destroy(newStart, newFinish);
-                DataAllocator::deallocate(newStart, len);
+                kDataAllocator.deallocate(newStart, len);
                 throw;
             }
 
@@ -227,18 +424,67 @@ public:
         }
     }
 
+    // 新增元素值初始化，平凡类型直接 memset 清零，不构造临时的 T() 再逐个复制
     void resize(SizeType newSize) {
-        resize(newSize, T());
+        if (newSize <= size()) {
+            erase(begin() + newSize, end());
+            return;
+        }
+        if (newSize > capacity())
+            reserve(growCapacity(newSize));
+        kFinish = uninitialized_value_construct_n(kFinish, newSize - size());
     }
 
     void clear() {
         erase(begin(), end());
     }
 
+    // 在末尾追加 [first, last)，范围不能指向本 vector
+    // 前向迭代器先算出个数，最多扩容一次，再整段 uninitialized_copy (平凡类型即 memmove)，
+    // 不像逐个 push_back 那样每次检查容量、扩容时反复搬动已有元素
+    template <typename I>
+    void append(I first, I last) {
+        if constexpr (MultiPassIterator<I>) {
+            const SizeType n = rangeLength(first, last);
+            if (SizeType(kEndOfStorage - kFinish) < n)
+                reserve(growCapacity(size() + n));
+            kFinish = uninitializedCopyRange(first, last, kFinish);
+        } else {
+            for (; first != last; ++first)
+                push_back(*first);
+        }
+    }
+
+    template <typename Range>
+    void append_range(Range&& r) {
+        append(std::begin(r), std::end(r));
+    }
+
+    // 与 resize 相同，但新增元素只做默认初始化：平凡类型不清零，
+    // 适合接下来马上被 read()/memcpy 整块覆盖的缓冲区
+    void resize_for_overwrite(SizeType newSize) {
+        if (newSize <= size()) {
+            erase(begin() + newSize, end());
+            return;
+        }
+        if (newSize > capacity())
+            reserve(growCapacity(newSize));
+        if constexpr (std::is_trivially_default_constructible_v<T>) {
+            kFinish = kStart + newSize;
+        } else {
+            for (; kFinish != kStart + newSize; ++kFinish)
+                ::new (static_cast<void*>(kFinish)) T;
+        }
+    }
+
     void reserve(SizeType n) {
         if (capacity() < n) {
+            if constexpr (TriviallyRelocatable<T>) {
+                relocateStorage(n);
+                return;
+            }
             const SizeType oldSize = size();
-            Iterator newStart = DataAllocator::allocate(n);
+            Iterator newStart = allocateAtLeast(n);
             try {
                 uninitialized_copy(kStart, kFinish, newStart);
                 destroy(kStart, kFinish);
@@ -247,7 +493,7 @@ public:
                 kFinish = newStart + oldSize;
                 kEndOfStorage = newStart + n;
             } catch (...) {
-                DataAllocator::deallocate(newStart, n);
+                kDataAllocator.deallocate(newStart, n);
                 throw;
             }
         }
@@ -258,18 +504,107 @@ public:
         if (kFinish != kEndOfStorage) {
             construct(kFinish, std::forward<Args>(args)...);
             ++kFinish;
+        } else {
+            insertAux(end(), std::forward<Args>(args)...);
+        }
+    }
+
+protected:
+    Iterator allocateAndFill(SizeType n, const T& x) {
+        Iterator result = kDataAllocator.allocate(n);
+        uninitialized_fill_n(result, n, x);
+        return result;
+    }
+
+    Iterator allocateAndCopy(ConstIterator first, ConstIterator last) {
+        Iterator result = kDataAllocator.allocate(last - first);
+        try {
+            uninitialized_copy(first, last, result);
+        } catch (...) {
+            kDataAllocator.deallocate(result, last - first);
+            throw;
+        }
+        return result;
+    }
+
+    // 容量够时复用已有元素赋值，只对多出来的部分构造或析构
+    void assignAux(ConstIterator first, ConstIterator last) {
+        const SizeType n = last - first;
+        if (n > capacity()) {
+            Iterator newStart = allocateAndCopy(first, last);
+            destroy(kStart, kFinish);
+            deallocate();
+            kStart = newStart;
+            kEndOfStorage = newStart + n;
+        } else if (n <= size()) {
+            Iterator newFinish = std::copy(first, last, kStart);
+            destroy(newFinish, kFinish);
+        } else {
+            std::copy(first, first + size(), kStart);
+            uninitialized_copy(first + size(), last, kFinish);
+        }
+        kFinish = kStart + n;
+    }
+
+    // 标准库迭代器没有 IteratorCategory，交给 mstl::distance / uninitialized_copy 会编译失败，
+    // 先按 std::forward_iterator 分派到标准库版本
+    template <typename I>
+    static SizeType rangeLength(I first, I last) {
+        if constexpr (std::forward_iterator<I>)
+            return SizeType(std::ranges::distance(first, last));
+        else
+            return SizeType(mstl::distance(first, last));
+    }
+
+    template <typename I>
+    static Iterator uninitializedCopyRange(I first, I last, Iterator result) {
+        if constexpr (std::forward_iterator<I>)
+            return std::uninitialized_copy(first, last, result);
+        else
+            return uninitialized_copy(first, last, result);
+    }
+
+    // 插入前向迭代器范围 [first, last)，n 为其长度
+    template <typename I>
+    void rangeInsert(Iterator position, I first, I last, SizeType n) {
+        if (n == 0)
+            return;
+        if (SizeType(kEndOfStorage - kFinish) >= n) {
+            const SizeType elemsAfter = kFinish - position;
+            Iterator oldFinish = kFinish;
+            if (elemsAfter > n) {
+                kFinish = mstl::uninitialized_move(kFinish - n, kFinish, kFinish);
+                std::move_backward(position, oldFinish - n, oldFinish);
+                std::copy(first, last, position);
+            } else {
+                I mid = first;
+                for (SizeType i = 0; i < elemsAfter; ++i)
+                    ++mid;
+                kFinish = uninitializedCopyRange(mid, last, kFinish);
+                kFinish = mstl::uninitialized_move(position, oldFinish, kFinish);
+                std::copy(first, mid, position);
+            }
         } else {
             const SizeType oldSize = size();
-            const SizeType len = oldSize != 0 ? 2 * oldSize : 1;
-            Iterator newStart = DataAllocator::allocate(len);
+            SizeType len = growCapacity(oldSize + n);
+            Iterator newStart = allocateAtLeast(len);
+            Iterator newPosition = newStart + (position - kStart);
             Iterator newFinish = newStart;
+
+            // 与 insertAux 一样先拷贝新元素：拷贝抛异常时旧元素还没被移走，vector 保持原样
             try {
-                newFinish = uninitialized_copy(kStart, kFinish, newStart);
-                construct(newFinish, std::forward<Args>(args)...);
-                ++newFinish;
+                uninitializedCopyRange(first, last, newPosition);
+            } catch (...) {
+                kDataAllocator.deallocate(newStart, len);
+                throw;
+            }
+            try {
+                newFinish = mstl::uninitialized_move(kStart, position, newStart);
+                newFinish = mstl::uninitialized_move(position, kFinish, newPosition + n);
             } catch (...) {
                 destroy(newStart, newFinish);
-                DataAllocator::deallocate(newStart, len);
+                destroy(newPosition, newPosition + n);
+                kDataAllocator.deallocate(newStart, len);
                 throw;
             }
             destroy(kStart, kFinish);
@@ -279,55 +614,60 @@ public:
             kEndOfStorage = newStart + len;
         }
     }
-
-protected:
-    Iterator allocateAndFill(SizeType n, const T& x) {
-        Iterator result = DataAllocator::allocate(n);
-        uninitialized_fill_n(result, n, x);
-        return result;
-    }
-
-    Iterator allocateAndCopy(ConstIterator first, ConstIterator last) {
-        Iterator result = DataAllocator::allocate(last - first);
-        uninitialized_copy(first, last, result);
-        return result;
-    }
 };
 
 // 使用单一模板函数处理左值和右值
-template <typename T, typename Alloc>
-template <typename U>
-void Vector<T, Alloc>::insertAux(Iterator position, U&& x) {
+template <typename T, typename Alloc, typename GrowthPolicy>
+template <typename... Args>
+void Vector<T, Alloc, GrowthPolicy>::insertAux(Iterator position, Args&&... args) {
     if (kFinish != kEndOfStorage) {
+        // args 可能引用即将后移的元素，先构造出新值
+        T xCopy(std::forward<Args>(args)...);
         // 在备用空间起始处构造一个元素，并以vector最后一个值作为其初值
         construct(kFinish, std::move(*(kFinish - 1)));
         // 调整水位
         ++kFinish;
         // 使用 std::move_backward 替代 std::copy_backward
         std::move_backward(position, kFinish - 2, kFinish - 1);
-        *position = std::forward<U>(x);
+        *position = std::move(xCopy);
     } else {  // 无备用空间
-        const SizeType oldSize = size();
-        const SizeType len = oldSize != 0 ? 2 * oldSize : 1;
-        // 如果原大小不为0，扩容为两倍
-        // 前半段用来放置原始数据，后半段放置新数据
+        // 新容量由 GrowthPolicy 决定，默认扩容为两倍
+        SizeType len = growCapacity(size() + 1);
 
-        Iterator newStart = DataAllocator::allocate(len);  // 实际配置
+        if constexpr (TriviallyRelocatable<T>) {
+            // args 可能引用本 vector 中的元素，搬动之前先构造出新值
+            T xCopy(std::forward<Args>(args)...);
+            const SizeType offset = position - kStart;
+            relocateStorage(len);
+            position = kStart + offset;
+            std::memmove(static_cast<void*>(position + 1), static_cast<const void*>(position),
+                         (kFinish - position) * sizeof(T));
+            construct(position, std::move(xCopy));
+            ++kFinish;
+            return;
+        }
+
+        Iterator newStart = allocateAtLeast(len);  // 实际配置
+        Iterator newPosition = newStart + (position - kStart);
         Iterator newFinish = newStart;
 
+        // 先在新空间中构造新元素：旧元素都还没被移走，args 引用它们也没关系
+        try {
+            construct(newPosition, std::forward<Args>(args)...);
+        } catch (...) {
+            kDataAllocator.deallocate(newStart, len);
+            throw;
+        }
         try {
             // 将原vector的内容移动到新vector
             newFinish = mstl::uninitialized_move(kStart, position, newStart);
-            // 为新元素设定初值x
-            construct(newFinish, std::forward<U>(x));
-            // 调整水位
-            ++newFinish;
-            // 将原vector的其余部分移动到新vector
-            newFinish = mstl::uninitialized_move(position, kFinish, newFinish);
+            // 将原vector的其余部分移动到新元素之后
+            newFinish = mstl::uninitialized_move(position, kFinish, newPosition + 1);
         } catch (...) {
             // commit or rollback semantic
             destroy(newStart, newFinish);
-            DataAllocator::deallocate(newStart, len);
+            destroy(newPosition);
+            kDataAllocator.deallocate(newStart, len);
             throw;
         }
 
@@ -343,23 +683,80 @@ void Vector<T, Alloc>::insertAux(Iterator position, U&& x) {
 
 template <typename T, size_t N, typename Alloc = std::allocator<T>>
 class SmallVector {
+   using traits = std::allocator_traits<Alloc>;
+
    alignas(T) unsigned char stack_[sizeof(T) * N];
    T* data_;
    size_t size_;
    size_t capacity_;
    Alloc allocator_;
    bool on_stack() const { return data_ == reinterpret_cast<const T*>(stack_); }
+   static constexpr bool nothrow_relocate = TriviallyRelocatable<T> || std::is_nothrow_move_constructible_v<T>;
+   T* stack_data() { return reinterpret_cast<T*>(stack_); }
+
+   // 把 src 处的 n 个元素搬到未初始化的 dst，src 处的对象随后视为已析构
+   // 可平凡重定位的类型直接 memcpy，不逐个移动和析构
+   void relocate(T* dst, T* src, size_t n) {
+      if constexpr (TriviallyRelocatable<T>) {
+         if (n != 0) std::memcpy(static_cast<void*>(dst), static_cast<const void*>(src), n * sizeof(T));
+      } else {
+         for (size_t i = 0; i < n; ++i) {
+            traits::construct(allocator_, dst + i, std::move(src[i]));
+            traits::destroy(allocator_, src + i);
+         }
+      }
+   }
+
+   void release_heap() {
+      if (!on_stack()) traits::deallocate(allocator_, data_, capacity_);
+   }
+
    void move_to_heap(size_t new_cap) {
-      T* new_data = std::allocator_traits<Alloc>::allocate(allocator_, new_cap);
-      for (size_t i = 0; i < size_; ++i)
-         std::allocator_traits<Alloc>::construct(allocator_, new_data + i, std::move(data_[i]));
-      for (size_t i = 0; i < size_; ++i)
-         std::allocator_traits<Alloc>::destroy(allocator_, data_ + i);
-      if (!on_stack()) std::allocator_traits<Alloc>::deallocate(allocator_, data_, capacity_);
+      T* new_data = traits::allocate(allocator_, new_cap);
+      relocate(new_data, data_, size_);
+      release_heap();
       data_ = new_data;
       capacity_ = new_cap;
    }
 
+   // 已满时在新空间中先构造新元素，再搬动旧元素：args 引用本容器中的元素也没关系
+   template <typename... Args>
+   T& grow_and_emplace_back(Args&&... args) {
+      const size_t new_cap = std::max(size_ + 1, 2 * capacity_);
+      T* new_data = traits::allocate(allocator_, new_cap);
+      try {
+         traits::construct(allocator_, new_data + size_, std::forward<Args>(args)...);
+      } catch (...) {
+         traits::deallocate(allocator_, new_data, new_cap);
+         throw;
+      }
+      relocate(new_data, data_, size_);
+      release_heap();
+      data_ = new_data;
+      capacity_ = new_cap;
+      return data_[size_++];
+   }
+
+   // 接管 other 的元素：other 在堆上时直接拿走缓冲区，在内联缓冲区时搬过来；other 变为空
+   void steal(SmallVector& other) {
+      if (other.on_stack()) {
+         relocate(data_, other.data_, other.size_);
+      } else {
+         data_ = other.data_;
+         capacity_ = other.capacity_;
+         other.data_ = other.stack_data();
+         other.capacity_ = N;
+      }
+      size_ = other.size_;
+      other.size_ = 0;
+   }
+
+   void destroy_all() {
+      for (size_t i = 0; i < size_; ++i)
+         traits::destroy(allocator_, data_ + i);
+      size_ = 0;
+   }
+
    public:
    using value_type = T;
    using size_type = size_t;
@@ -372,71 +769,161 @@ class SmallVector {
    using const_iterator = const T*;
    using allocator_type = Alloc;
 
-   SmallVector() : data_(reinterpret_cast<T*>(stack_)), size_(0), capacity_(N), allocator_() {}
-   explicit SmallVector(const Alloc& alloc) : data_(reinterpret_cast<T*>(stack_)), size_(0), capacity_(N), allocator_(alloc) {}
+   SmallVector() : data_(stack_data()), size_(0), capacity_(N), allocator_() {}
+   explicit SmallVector(const Alloc& alloc) : data_(stack_data()), size_(0), capacity_(N), allocator_(alloc) {}
+   explicit SmallVector(size_type n, const Alloc& alloc = Alloc()) : SmallVector(alloc) { resize(n); }
+   SmallVector(size_type n, const T& v, const Alloc& alloc = Alloc()) : SmallVector(alloc) { assign(n, v); }
+   SmallVector(std::initializer_list<T> il, const Alloc& alloc = Alloc()) : SmallVector(alloc) {
+      assign(il.begin(), il.end());
+   }
+   template <std::input_iterator It>
+   SmallVector(It first, It last, const Alloc& alloc = Alloc()) : SmallVector(alloc) {
+      assign(first, last);
+   }
    ~SmallVector() {
-      for (size_t i = 0; i < size_; ++i)
-         std::allocator_traits<Alloc>::destroy(allocator_, data_ + i);
-      if (!on_stack()) std::allocator_traits<Alloc>::deallocate(allocator_, data_, capacity_);
+      destroy_all();
+      release_heap();
    }
-   SmallVector(const SmallVector&) = delete;
-   SmallVector& operator=(const SmallVector&) = delete;
 
-   SmallVector(SmallVector&& other) noexcept
-      : data_(reinterpret_cast<T*>(stack_)), size_(0), capacity_(N), allocator_(std::move(other.allocator_)) {
-      if (other.on_stack()) {
-         reserve(other.size_);
-         for (size_t i = 0; i < other.size_; ++i) {
-            std::allocator_traits<Alloc>::construct(allocator_, data_ + i, std::move(other.data_[i]));
-            ++size_;
-         }
-      } else {
-         data_ = other.data_;
-         size_ = other.size_;
-         capacity_ = other.capacity_;
-         other.data_ = reinterpret_cast<T*>(other.stack_);
-         other.size_ = 0;
-         other.capacity_ = N;
-      }
+   SmallVector(const SmallVector& other)
+      : SmallVector(traits::select_on_container_copy_construction(other.allocator_)) {
+      assign(other.begin(), other.end());
    }
 
-   SmallVector& operator=(SmallVector&& other) noexcept {
+   SmallVector& operator=(const SmallVector& other) {
       if (this != &other) {
-         for (size_t i = 0; i < size_; ++i)
-            std::allocator_traits<Alloc>::destroy(allocator_, data_ + i);
-         if (!on_stack()) std::allocator_traits<Alloc>::deallocate(allocator_, data_, capacity_);
-
-         allocator_ = std::move(other.allocator_);
-         if (other.on_stack()) {
-            data_ = reinterpret_cast<T*>(stack_);
-            capacity_ = N;
-            reserve(other.size_);
-            for (size_t i = 0; i < other.size_; ++i) {
-               std::allocator_traits<Alloc>::construct(allocator_, data_ + i, std::move(other.data_[i]));
+         if constexpr (traits::propagate_on_container_copy_assignment::value) {
+            if (allocator_ != other.allocator_) {
+               destroy_all();
+               release_heap();
+               data_ = stack_data();
+               capacity_ = N;
             }
-            size_ = other.size_;
-         } else {
-            data_ = other.data_;
-            size_ = other.size_;
-            capacity_ = other.capacity_;
-            other.data_ = reinterpret_cast<T*>(other.stack_);
-            other.size_ = 0;
-            other.capacity_ = N;
+            allocator_ = other.allocator_;
+         }
+         assign(other.begin(), other.end());
+      }
+      return *this;
+   }
+
+   // other 在内联缓冲区时要逐个搬动元素
+   SmallVector(SmallVector&& other) noexcept(nothrow_relocate)
+      : data_(stack_data()), size_(0), capacity_(N), allocator_(std::move(other.allocator_)) {
+      steal(other);
+   }
+
+   // 分配器随移动传播或两边相等时接管 other 的存储；否则 other 的堆缓冲区只能由它自己的分配器释放，
+   // 逐个移动元素到本容器的存储中
+   SmallVector& operator=(SmallVector&& other) noexcept(
+      (traits::propagate_on_container_move_assignment::value || traits::is_always_equal::value) &&
+      nothrow_relocate) {
+      if (this == &other) return *this;
+      if constexpr (!traits::propagate_on_container_move_assignment::value) {
+         if (allocator_ != other.allocator_) {
+            assign(std::make_move_iterator(other.begin()), std::make_move_iterator(other.end()));
+            other.clear();
+            return *this;
          }
       }
+      destroy_all();
+      release_heap();
+      data_ = stack_data();
+      capacity_ = N;
+      if constexpr (traits::propagate_on_container_move_assignment::value) allocator_ = std::move(other.allocator_);
+      steal(other);
+      return *this;
+   }
+
+   SmallVector& operator=(std::initializer_list<T> il) {
+      assign(il.begin(), il.end());
       return *this;
    }
 
+   // 两边都在堆上时只交换指针；内联缓冲区中的元素只能逐个交换或搬动，
+   // 所以只有元素的移动和交换都不抛异常时才是 noexcept
+   // 分配器不随交换传播时要求两边相等，与标准容器相同
+   void swap(SmallVector& other) noexcept(nothrow_relocate && std::is_nothrow_swappable_v<T>) {
+      if (this == &other) return;
+      if constexpr (traits::propagate_on_container_swap::value) {
+         using std::swap;
+         swap(allocator_, other.allocator_);
+      }
+      if (!on_stack() && !other.on_stack()) {
+         std::swap(data_, other.data_);
+         std::swap(capacity_, other.capacity_);
+      } else if (on_stack() && other.on_stack()) {
+         SmallVector& longer = size_ >= other.size_ ? *this : other;
+         SmallVector& shorter = size_ >= other.size_ ? other : *this;
+         using std::swap;
+         for (size_t i = 0; i < shorter.size_; ++i)
+            swap(longer.data_[i], shorter.data_[i]);
+         shorter.relocate(shorter.data_ + shorter.size_, longer.data_ + shorter.size_, longer.size_ - shorter.size_);
+      } else {
+         // 内联的一方把元素搬进对方的内联缓冲区，再接管对方的堆缓冲区
+         SmallVector& heap = on_stack() ? other : *this;
+         SmallVector& inl = on_stack() ? *this : other;
+         T* heap_data = heap.data_;
+         const size_t heap_cap = heap.capacity_;
+         heap.relocate(heap.stack_data(), inl.data_, inl.size_);
+         heap.data_ = heap.stack_data();
+         heap.capacity_ = N;
+         inl.data_ = heap_data;
+         inl.capacity_ = heap_cap;
+      }
+      std::swap(size_, other.size_);
+   }
+
    size_type size() const { return size_; }
    size_type capacity() const { return capacity_; }
+   size_type max_size() const { return traits::max_size(allocator_); }
    bool empty() const { return size_ == 0; }
+   // 元素是否还在内联缓冲区中 (没有堆分配)
+   bool is_inline() const { return on_stack(); }
    void reserve(size_type n) {
       if (n > capacity_) move_to_heap(std::max(n, 2 * capacity_));
    }
 
+   // 放得进内联缓冲区时搬回去并释放堆空间，否则把堆空间缩到 size()
+   void shrink_to_fit() {
+      if (on_stack() || size_ == capacity_) return;
+      if (size_ <= N) {
+         T* heap = data_;
+         const size_t heap_cap = capacity_;
+         relocate(stack_data(), heap, size_);
+         traits::deallocate(allocator_, heap, heap_cap);
+         data_ = stack_data();
+         capacity_ = N;
+      } else {
+         T* heap = data_;
+         const size_t heap_cap = capacity_;
+         data_ = traits::allocate(allocator_, size_);
+         relocate(data_, heap, size_);
+         traits::deallocate(allocator_, heap, heap_cap);
+         capacity_ = size_;
+      }
+   }
+
+   void assign(size_type n, const T& v) {
+      T tmp(v);  // v 可能是本容器中的元素
+      clear();
+      reserve(n);
+      for (; size_ < n; ++size_)
+         traits::construct(allocator_, data_ + size_, tmp);
+   }
+
+   template <std::input_iterator It>
+   void assign(It first, It last) {
+      clear();
+      if constexpr (std::forward_iterator<It>) reserve(std::distance(first, last));
+      for (; first != last; ++first)
+         emplace_back(*first);
+   }
+
+   void assign(std::initializer_list<T> il) { assign(il.begin(), il.end()); }
+
    void pop_back() {
       if (size_ > 0) {
-         std::allocator_traits<Alloc>::destroy(allocator_, data_ + size_ - 1);
+         traits::destroy(allocator_, data_ + size_ - 1);
          --size_;
       }
    }
@@ -444,30 +931,115 @@ class SmallVector {
    void resize(size_type n) {
       reserve(n);
       if (n > size_)
-         for (size_t i = size_; i < n; ++i) std::allocator_traits<Alloc>::construct(allocator_, data_ + i);
+         for (size_t i = size_; i < n; ++i) traits::construct(allocator_, data_ + i);
       else
-         for (size_t i = n; i < size_; ++i) std::allocator_traits<Alloc>::destroy(allocator_, data_ + i);
+         for (size_t i = n; i < size_; ++i) traits::destroy(allocator_, data_ + i);
       size_ = n;
    }
-   void push_back(const T& v) {
-      if (size_ == capacity_) reserve(size_ + 1);
-      std::allocator_traits<Alloc>::construct(allocator_, data_ + size_, v);
-      ++size_;
+   void resize(size_type n, const T& v) {
+      if (n <= size_) {
+         resize(n);
+         return;
+      }
+      insert(end(), n - size_, v);
    }
-   void push_back(T&& v) {
-      if (size_ == capacity_) reserve(size_ + 1);
-      std::allocator_traits<Alloc>::construct(allocator_, data_ + size_, std::move(v));
+
+   template <typename... Args>
+   reference emplace_back(Args&&... args) {
+      if (size_ == capacity_) return grow_and_emplace_back(std::forward<Args>(args)...);
+      traits::construct(allocator_, data_ + size_, std::forward<Args>(args)...);
+      return data_[size_++];
+   }
+   void push_back(const T& v) { emplace_back(v); }
+   void push_back(T&& v) { emplace_back(std::move(v)); }
+
+   // 在 pos 处构造新元素，返回指向它的迭代器
+   template <typename... Args>
+   iterator emplace(const_iterator pos, Args&&... args) {
+      const size_t index = pos - begin();
+      if (index == size_) {
+         emplace_back(std::forward<Args>(args)...);
+         return begin() + index;
+      }
+      // args 可能引用即将后移的元素，先构造出新值
+      T tmp(std::forward<Args>(args)...);
+      reserve(size_ + 1);
+      T* p = data_ + index;
+      traits::construct(allocator_, data_ + size_, std::move(data_[size_ - 1]));
+      std::move_backward(p, data_ + size_ - 1, data_ + size_);
       ++size_;
+      *p = std::move(tmp);
+      return p;
    }
+   iterator insert(const_iterator pos, const T& v) { return emplace(pos, v); }
+   iterator insert(const_iterator pos, T&& v) { return emplace(pos, std::move(v)); }
+
+   iterator insert(const_iterator pos, size_type n, const T& v) {
+      const size_t index = pos - begin();
+      const size_t old_size = size_;
+      if (n == 0) return begin() + index;
+      T tmp(v);
+      reserve(size_ + n);
+      for (size_t i = 0; i < n; ++i) {
+         traits::construct(allocator_, data_ + size_, tmp);
+         ++size_;
+      }
+      std::rotate(begin() + index, begin() + old_size, end());
+      return begin() + index;
+   }
+
+   // 先把 [first, last) 追加到末尾再旋转到位；平凡可复制的类型用 memmove 一次腾出空位
+   template <std::input_iterator It>
+   iterator insert(const_iterator pos, It first, It last) {
+      const size_t index = pos - begin();
+      const size_t old_size = size_;
+      if constexpr (std::forward_iterator<It> && std::is_trivially_copyable_v<T>) {
+         const size_t n = std::distance(first, last);
+         reserve(size_ + n);
+         T* p = data_ + index;
+         std::memmove(static_cast<void*>(p + n), static_cast<const void*>(p), (size_ - index) * sizeof(T));
+         std::uninitialized_copy(first, last, p);
+         size_ += n;
+      } else {
+         if constexpr (std::forward_iterator<It>) reserve(size_ + std::distance(first, last));
+         for (; first != last; ++first)
+            emplace_back(*first);
+         std::rotate(begin() + index, begin() + old_size, end());
+      }
+      return begin() + index;
+   }
+   iterator insert(const_iterator pos, std::initializer_list<T> il) { return insert(pos, il.begin(), il.end()); }
+
+   iterator erase(const_iterator pos) { return erase(pos, pos + 1); }
+   iterator erase(const_iterator first, const_iterator last) {
+      iterator f = begin() + (first - begin());
+      iterator l = begin() + (last - begin());
+      if (f != l) {
+         iterator new_end = std::move(l, end(), f);
+         for (iterator it = new_end; it != end(); ++it)
+            traits::destroy(allocator_, it);
+         size_ = new_end - begin();
+      }
+      return f;
+   }
+
    reference operator[](size_type i) { return data_[i]; }
    const_reference operator[](size_type i) const { return data_[i]; }
+   reference at(size_type i) {
+      if (i >= size_) throw std::out_of_range("SmallVector::at");
+      return data_[i];
+   }
+   const_reference at(size_type i) const {
+      if (i >= size_) throw std::out_of_range("SmallVector::at");
+      return data_[i];
+   }
+   reference front() { return data_[0]; }
+   const_reference front() const { return data_[0]; }
+   reference back() { return data_[size_ - 1]; }
+   const_reference back() const { return data_[size_ - 1]; }
    pointer data() { return data_; }
    const_pointer data() const { return data_; }
-   void clear() {
-      for (size_t i = 0; i < size_; ++i)
-         std::allocator_traits<Alloc>::destroy(allocator_, data_ + i);
-      size_ = 0;
-   }
+   void clear() { destroy_all(); }
 
    // 迭代器接口
    iterator begin() { return data_; }
@@ -478,6 +1050,10 @@ class SmallVector {
    const_iterator cend() const { return data_ + size_; }
 
    allocator_type get_allocator() const { return allocator_; }
+
+   friend bool operator==(const SmallVector& a, const SmallVector& b) {
+      return a.size_ == b.size_ && std::equal(a.begin(), a.end(), b.begin());
+   }
 };
 }  // namespace mstl
 
@@ -1,7 +1,732 @@
 #include "mstl_vector.h"
+#include <cassert>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
 #include <iostream>
+#include <iterator>
+#include <list>
+#include <memory_resource>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "mstl_arena.h"
+#include "mstl_list.h"
+
+// 持有一块堆内存的句柄：移动构造不是平凡的，但按字节搬动是安全的，声明加入
+struct Handle {
+    using IsTriviallyRelocatable = std::true_type;
+
+    static int moves;
+    int* p;
+
+    explicit Handle(int v) : p(new int(v)) {}
+    Handle(const Handle& x) : p(new int(*x.p)) {}
+    Handle(Handle&& x) noexcept : p(x.p) {
+        x.p = nullptr;
+        ++moves;
+    }
+    Handle& operator=(Handle&& x) noexcept {
+        std::swap(p, x.p);
+        return *this;
+    }
+    ~Handle() { delete p; }
+};
+
+int Handle::moves = 0;
+
+// 通过特化加入
+struct Tagged {
+    int v;
+    Tagged(int x) : v(x) {}
+    ~Tagged() {}
+};
+
+template <>
+struct mstl::IsTriviallyRelocatable<Tagged> : std::true_type {};
+
+// 有自定义拷贝构造、不可平凡重定位，用来对比逐个搬动的老路径
+struct BoxedInt {
+    int v;
+    BoxedInt(int x) : v(x) {}
+    BoxedInt(const BoxedInt& x) : v(x.v) {}
+    BoxedInt& operator=(const BoxedInt&) = default;
+};
+
+static volatile int sink;
+
+void test_trivially_relocatable() {
+    std::cout << "\n=== 可平凡重定位类型扩容测试 ===" << std::endl;
+
+    static_assert(mstl::TriviallyRelocatable<int>);
+    static_assert(mstl::TriviallyRelocatable<const double>);
+    static_assert(mstl::TriviallyRelocatable<Handle>);
+    static_assert(mstl::TriviallyRelocatable<Tagged>);
+    static_assert(!mstl::TriviallyRelocatable<BoxedInt>);
+    static_assert(!mstl::TriviallyRelocatable<std::string>);
+
+    // 扩容时参数引用的是即将被搬走的元素
+    mstl::Vector<int> v;
+    v.push_back(7);
+    for (int i = 0; i < 100; ++i)
+        v.push_back(v[0]);
+    for (int i = 0; i < 100; ++i)
+        v.emplace_back(v.back() + 1);
+    assert(v.size() == 201);
+    for (int i = 0; i <= 100; ++i)
+        assert(v[i] == 7);
+    for (int i = 101; i < 201; ++i)
+        assert(v[i] == i - 93);
+
+    v.reserve(1000);
+    assert(v.capacity() == 1000 && v.size() == 201 && v[200] == 107);
+
+    // 扩容不调用移动构造：每个元素只在放进来时移动一次，外加每次扩容搬一次新元素
+    Handle::moves = 0;
+    {
+        mstl::Vector<Handle> h;
+        for (int i = 0; i < 1000; ++i)
+            h.push_back(Handle(i));
+        h.emplace_back(h[500]);
+        for (int i = 0; i < 1000; ++i)
+            assert(*h[i].p == i);
+        assert(*h[1000].p == 500);
+        std::cout << "1001 个 Handle 的移动构造次数: " << Handle::moves << std::endl;
+        assert(Handle::moves < 1000 + 20);
+    }
+
+    mstl::Vector<Tagged> t;
+    for (int i = 0; i < 100; ++i)
+        t.emplace_back(i);
+    for (int i = 0; i < 100; ++i)
+        assert(t[i].v == i);
+
+    // 底层分配器有 reallocate 时由它来搬：Arena 中最近一次分配能原地伸长
+    mstl::Arena arena(1 << 20);
+    mstl::Vector<int, mstl::ArenaRef> a{mstl::ArenaRef(arena)};
+    a.push_back(0);
+    const int* first = &a[0];
+    for (int i = 1; i < 1024; ++i)
+        a.push_back(i);
+    assert(&a[0] == first);
+    for (int i = 0; i < 1024; ++i)
+        assert(a[i] == i);
+    std::cout << "Arena 上 1024 个 int 扩容后首地址不变" << std::endl;
+    std::cout << "可平凡重定位测试通过" << std::endl;
+}
+
+// 逐个 push_back n 个元素，统计扩容中有多少次缓冲区原地扩展
+template <typename T>
+void benchmark_growth_aux(const char* name, int n) {
+    auto start = std::chrono::high_resolution_clock::now();
+    mstl::Vector<T> v;
+    int growths = 0, inPlace = 0;
+    for (int i = 0; i < n; ++i) {
+        const T* old = v.begin();
+        const size_t cap = v.capacity();
+        v.push_back(T(i));
+        if (v.capacity() != cap) {
+            ++growths;
+            inPlace += old != nullptr && v.begin() == old;
+        }
+    }
+    auto end = std::chrono::high_resolution_clock::now();
+    std::cout << name << ": " << std::chrono::duration<double, std::milli>(end - start).count()
+              << " ms, 扩容 " << growths << " 次, 其中原地扩展 " << inPlace << " 次" << std::endl;
+}
+
+void benchmark_growth() {
+    std::cout << "\n=== push_back 扩容性能 (1<<22 个元素) ===" << std::endl;
+    benchmark_growth_aux<int>("Vector<int>      (realloc)", 1 << 22);
+    benchmark_growth_aux<BoxedInt>("Vector<BoxedInt> (逐个复制)", 1 << 22);
+}
 
 // 测试vector的基本功能
+void test_append() {
+    std::cout << "\n=== append / resize_for_overwrite 测试 ===" << std::endl;
+
+    mstl::Vector<int> v{1, 2};
+    std::vector<int> src{3, 4, 5, 6, 7};
+    v.append(src.data(), src.data() + src.size());
+    assert(v.size() == 7 && v[6] == 7);
+
+    mstl::List<int> l;
+    l.push_back(8);
+    l.push_back(9);
+    v.append_range(l);
+    int arr[] = {10, 11, 12};
+    v.append_range(arr);
+    std::istringstream in("13 14 15");
+    v.append(std::istream_iterator<int>(in), std::istream_iterator<int>());
+    assert(v.size() == 15);
+    for (int i = 0; i < 15; ++i)
+        assert(v[i] == i + 1);
+
+    mstl::Vector<std::string> s;
+    std::string words[] = {"a", "bb", "ccc"};
+    s.append_range(words);
+    s.append(words, words + 1);
+    assert(s.size() == 4 && s[2] == "ccc" && s[3] == "a");
+
+    // 标准库容器的迭代器
+    mstl::Vector<int> fromStd;
+    fromStd.append_range(std::vector<int>{1, 2, 3});
+    std::list<int> sl{4, 5};
+    fromStd.append(sl.begin(), sl.end());
+    fromStd.append_range(sl);
+    std::vector<std::string> sv{"dd", "eee"};
+    s.append(sv.begin(), sv.end());
+    int fromStdExpected[] = {1, 2, 3, 4, 5, 4, 5};
+    assert(fromStd.size() == 7 && std::equal(fromStd.begin(), fromStd.end(), fromStdExpected));
+    assert(s.size() == 6 && s[4] == "dd" && s[5] == "eee");
+
+    // 平凡类型不清零，随后整块覆盖
+    mstl::Vector<char> buf;
+    const char msg[] = "hello, world";
+    buf.resize_for_overwrite(sizeof(msg));
+    assert(buf.size() == sizeof(msg));
+    std::memcpy(buf.begin(), msg, sizeof(msg));
+    assert(std::strcmp(buf.begin(), msg) == 0);
+    buf.resize_for_overwrite(5);
+    assert(buf.size() == 5 && buf[4] == 'o');
+
+    s.resize_for_overwrite(8);
+    assert(s.size() == 8 && s[7].empty() && s[5] == "eee" && s[0] == "a");
+    std::cout << "append / resize_for_overwrite 测试通过" << std::endl;
+}
+
+void benchmark_append() {
+    const int n = 1 << 22;
+    std::vector<int> src(n);
+    for (int i = 0; i < n; ++i)
+        src[i] = i;
+    auto time = [](auto f) {
+        auto start = std::chrono::high_resolution_clock::now();
+        f();
+        auto end = std::chrono::high_resolution_clock::now();
+        return std::chrono::duration<double, std::milli>(end - start).count();
+    };
+
+    std::cout << "\n=== 追加 1<<22 个 int ===" << std::endl;
+    double pushTime = time([&] {
+        mstl::Vector<int> v;
+        for (int x : src)
+            v.push_back(x);
+        sink = v[n / 2];
+    });
+    double appendTime = time([&] {
+        mstl::Vector<int> v;
+        v.append(src.data(), src.data() + n);
+        sink = v[n / 2];
+    });
+    std::cout << "逐个 push_back: " << pushTime << " ms, append: " << appendTime << " ms" << std::endl;
+
+    std::cout << "\n=== 准备 1<<24 字节的读缓冲区并整块覆盖 ===" << std::endl;
+    std::vector<char> data(1 << 24, 'x');
+    double resizeTime = time([&] {
+        mstl::Vector<char> v;
+        v.resize(data.size());
+        std::memcpy(v.begin(), data.data(), data.size());
+        sink = v[data.size() / 2];
+    });
+    double overwriteTime = time([&] {
+        mstl::Vector<char> v;
+        v.resize_for_overwrite(data.size());
+        std::memcpy(v.begin(), data.data(), data.size());
+        sink = v[data.size() / 2];
+    });
+    std::cout << "resize: " << resizeTime << " ms, resize_for_overwrite: " << overwriteTime << " ms" << std::endl;
+}
+
+// 拷贝 "bad" 时抛异常，移动不抛
+struct ThrowOnCopy {
+    std::string s;
+
+    ThrowOnCopy(const char* str) : s(str) {}
+    ThrowOnCopy(const ThrowOnCopy& x) : s(x.s) {
+        if (s == "bad")
+            throw std::runtime_error("copy");
+    }
+    ThrowOnCopy(ThrowOnCopy&&) noexcept = default;
+    ThrowOnCopy& operator=(const ThrowOnCopy&) = default;
+    ThrowOnCopy& operator=(ThrowOnCopy&&) noexcept = default;
+};
+
+// 移动构造可能抛异常
+struct ThrowingMove {
+    int v = 0;
+
+    ThrowingMove() = default;
+    ThrowingMove(const ThrowingMove&) = default;
+    ThrowingMove(ThrowingMove&& x) noexcept(false) : v(x.v) {}
+    ThrowingMove& operator=(const ThrowingMove&) = default;
+    ThrowingMove& operator=(ThrowingMove&& x) noexcept(false) {
+        v = x.v;
+        return *this;
+    }
+};
+
+// 有状态、不随容器移动传播的分配器
+struct TaggedAlloc {
+    using Pointer = void*;
+    using ConstPointer = const void*;
+    using SizeType = size_t;
+    using DifferenceType = ptrdiff_t;
+    using PropagateOnContainerMoveAssignment = std::false_type;
+    using IsAlwaysEqual = std::false_type;
+
+    int tag;
+
+    void* allocate(size_t n) { return std::malloc(n); }
+    void deallocate(void* p, size_t) { std::free(p); }
+    bool operator==(const TaggedAlloc& x) const { return tag == x.tag; }
+};
+
+void test_copy_move_insert() {
+    std::cout << "\n=== 拷贝/移动、任意位置插入、值初始化测试 ===" << std::endl;
+
+    mstl::Vector<std::string> a{"x", "y", "z"};
+    mstl::Vector<std::string> b(a);
+    b[0] = "changed";
+    assert(a[0] == "x" && b.size() == 3);
+
+    const std::string* data = a.begin();
+    mstl::Vector<std::string> c(std::move(a));
+    assert(c.begin() == data && a.empty() && a.capacity() == 0);
+
+    b = c;
+    assert(b.size() == 3 && b[0] == "x" && b[2] == "z");
+    mstl::Vector<std::string> big{"1", "2", "3", "4", "5", "6", "7"};
+    b = big;
+    assert(b.size() == 7 && b[6] == "7");
+    b = c;
+    assert(b.size() == 3 && b[1] == "y");
+
+    b = std::move(big);
+    assert(b.size() == 7 && big.empty());
+    b = b;
+    assert(b.size() == 7);
+
+    // ArenaRef 随移动传播：直接接管缓冲区
+    mstl::Arena arena1, arena2;
+    mstl::Vector<std::string, mstl::ArenaRef> p{mstl::ArenaRef(arena1)}, q{mstl::ArenaRef(arena2)};
+    p.push_back("long string that does not fit in sso buffer");
+    data = p.begin();
+    q = std::move(p);
+    assert(q.begin() == data && p.empty() && q.get_allocator() == mstl::ArenaRef(arena1));
+
+    // 分配器不相等且不随移动传播：逐个移动元素
+    mstl::Vector<std::string, TaggedAlloc> m{TaggedAlloc{1}}, n{TaggedAlloc{2}};
+    m.push_back("moved element by element");
+    data = m.begin();
+    n = std::move(m);
+    assert(n.size() == 1 && n.begin() != data && n[0] == "moved element by element");
+    assert(m.empty() && n.get_allocator().tag == 2);
+
+    // 参数引用的元素在插入时会被后移或搬走
+    mstl::Vector<std::string> s{"a", "b", "c", "d"};
+    s.insert(s.begin(), s[3]);
+    s.insert(s.begin() + 2, std::string("m"));
+    auto it = s.emplace(s.begin() + 1, 3, 'e');
+    assert(*it == "eee");
+    s.push_back(s[0]);
+    std::string expected[] = {"d", "eee", "a", "m", "b", "c", "d", "d"};
+    assert(s.size() == 8);
+    for (size_t i = 0; i < s.size(); ++i)
+        assert(s[i] == expected[i]);
+
+    // 区间插入：容量足够 (后移元素多于/少于插入个数) 以及需要扩容
+    mstl::Vector<int> v{1, 2, 3, 4, 5};
+    v.reserve(20);
+    int mid[] = {10, 11};
+    v.insert(v.begin() + 1, mid, mid + 2);
+    int many[] = {20, 21, 22, 23, 24};
+    v.insert(v.end() - 2, many, many + 5);
+    mstl::List<int> l;
+    for (int i = 30; i < 40; ++i)
+        l.push_back(i);
+    auto pos = v.insert(v.begin(), l.begin(), l.end());
+    assert(pos == v.begin() && v.size() == 22);
+    std::istringstream in("7 8");
+    v.insert(v.begin() + 10, std::istream_iterator<int>(in), std::istream_iterator<int>());
+    int all[] = {30, 31, 32, 33, 34, 35, 36, 37, 38, 39, 7, 8, 1, 10, 11, 2, 3, 20, 21, 22, 23, 24, 4, 5};
+    assert(v.size() == 24);
+    for (size_t i = 0; i < v.size(); ++i)
+        assert(v[i] == all[i]);
+
+    mstl::Vector<std::string> t{"p", "q"};
+    std::string words[] = {"r", "s", "t"};
+    t.insert(t.begin() + 1, words, words + 3);
+    assert(t.size() == 5 && t[0] == "p" && t[1] == "r" && t[3] == "t" && t[4] == "q");
+
+    // 标准库容器的迭代器
+    std::vector<int> sv{50, 51, 52};
+    pos = v.insert(v.begin(), sv.begin(), sv.end());
+    assert(pos == v.begin() && v.size() == 27 && v[2] == 52 && v[3] == 30);
+    std::list<int> sl{60, 61};
+    pos = v.insert(v.end(), sl.begin(), sl.end());
+    assert(v.size() == 29 && *pos == 60 && v[28] == 61 && v[26] == 5);
+    std::vector<std::string> sw{"u", "v"};
+    t.insert(t.begin() + 4, sw.begin(), sw.end());
+    assert(t.size() == 7 && t[4] == "u" && t[5] == "v" && t[6] == "q");
+
+    // 扩容时拷贝新区间抛异常，原有元素不能已经被移走
+    mstl::Vector<ThrowOnCopy> tc{"long string kept after failed insert", "second"};
+    assert(tc.capacity() == 2);
+    ThrowOnCopy range[] = {"ok", "bad"};
+    bool thrown = false;
+    try {
+        tc.insert(tc.begin() + 1, range, range + 2);
+    } catch (const std::runtime_error&) {
+        thrown = true;
+    }
+    assert(thrown && tc.size() == 2);
+    assert(tc[0].s == "long string kept after failed insert" && tc[1].s == "second");
+
+    // resize 值初始化，不会留下 resize_for_overwrite 写过的旧值
+    mstl::Vector<int> z;
+    z.resize_for_overwrite(16);
+    for (int i = 0; i < 16; ++i)
+        z[i] = -1;
+    z.resize(4);
+    z.resize(16);
+    for (int i = 4; i < 16; ++i)
+        assert(z[i] == 0);
+    mstl::Vector<double> d(8);
+    assert(d[7] == 0.0);
+    t.resize(9);
+    assert(t[8].empty() && t[6] == "q");
+
+    // 数据成员指针的空值不是全零字节，不能用 memset 值初始化
+    struct WithMemberPointer {
+        int a;
+        int WithMemberPointer::*p;
+    };
+    mstl::Vector<WithMemberPointer> mp;
+    mp.resize(3);
+    assert(mp[0].a == 0 && mp[0].p == nullptr && mp[2].p == nullptr);
+    mstl::Vector<WithMemberPointer> mp2(2);
+    assert(mp2[1].p == nullptr);
+    mstl::Vector<int WithMemberPointer::*> bare(2);
+    assert(bare[0] == nullptr);
+    std::cout << "拷贝/移动、插入、值初始化测试通过" << std::endl;
+}
+
+void benchmark_move_and_insert() {
+    auto time = [](auto f) {
+        auto start = std::chrono::high_resolution_clock::now();
+        f();
+        auto end = std::chrono::high_resolution_clock::now();
+        return std::chrono::duration<double, std::milli>(end - start).count();
+    };
+
+    std::cout << "\n=== 传递 1<<22 个 int 的 vector ===" << std::endl;
+    mstl::Vector<int> src(size_t(1) << 22);
+    double copyTime = time([&] {
+        mstl::Vector<int> v(src);
+        sink = v[1];
+    });
+    double moveTime = time([&] {
+        mstl::Vector<int> v(std::move(src));
+        sink = v[1];
+        src = std::move(v);
+    });
+    std::cout << "拷贝: " << copyTime << " ms, 移动: " << moveTime << " ms" << std::endl;
+
+    std::cout << "\n=== 在 1<<16 个 int 的开头插入 1024 个元素 ===" << std::endl;
+    int block[1024] = {};
+    double singleTime = time([&] {
+        mstl::Vector<int> v(size_t(1) << 16);
+        for (int i = 0; i < 1024; ++i)
+            v.insert(v.begin() + i, block[i]);
+        sink = v[0];
+    });
+    double rangeTime = time([&] {
+        mstl::Vector<int> v(size_t(1) << 16);
+        v.insert(v.begin(), block, block + 1024);
+        sink = v[0];
+    });
+    std::cout << "逐个 insert: " << singleTime << " ms, 区间 insert: " << rangeTime << " ms" << std::endl;
+}
+
+void test_growth_policy() {
+    std::cout << "\n=== 扩容策略测试 ===" << std::endl;
+
+    size_t caps[] = {1, 2, 3, 5, 8, 12, 18};
+    size_t cap = 0;
+    for (size_t expected : caps) {
+        cap = mstl::HalfGrowth::nextCapacity(cap, cap + 1, sizeof(int));
+        assert(cap == expected);
+    }
+    assert(mstl::DoubleGrowth::nextCapacity(0, 1, 4) == 1 && mstl::DoubleGrowth::nextCapacity(8, 9, 4) == 16);
+    assert(mstl::DoubleGrowth::nextCapacity(8, 100, 4) == 100);
+    // 超过一页之后总是整页
+    assert(mstl::PageGrowth::nextCapacity(512, 513, 4) == 1024);
+    assert(mstl::PageGrowth::nextCapacity(1024, 1025, 4) == 2048);
+    assert(mstl::PageGrowth::nextCapacity(1000, 1001, 24) * 24 % 4096 == 0);
+
+    mstl::Vector<int, mstl::alloc, mstl::HalfGrowth> h;
+    for (int i = 0; i < 1000; ++i)
+        h.push_back(i);
+    for (int i = 0; i < 1000; ++i)
+        assert(h[i] == i);
+    assert(h.capacity() < 1500);
+
+    mstl::Vector<std::string, mstl::alloc, mstl::PageGrowth> ps;
+    for (int i = 0; i < 1000; ++i)
+        ps.push_back(std::to_string(i));
+    assert(ps.size() == 1000 && ps[999] == "999" && ps.capacity() * sizeof(std::string) % 4096 == 0);
+
+    // 内存池的小块：一次分配就用满整个尺寸类别
+    mstl::Vector<char, mstl::thread_safe_alloc, mstl::SizeClassGrowth<>> c;
+    c.push_back('a');
+    assert(c.capacity() == mstl::sizeClassRoundUp(1));
+    c.reserve(100);
+    assert(c.capacity() == mstl::sizeClassRoundUp(100));
+
+    mstl::Vector<std::string, mstl::thread_safe_alloc, mstl::SizeClassGrowth<mstl::HalfGrowth>> cs;
+    for (int i = 0; i < 500; ++i)
+        cs.insert(cs.begin(), std::to_string(i));
+    for (int i = 0; i < 500; ++i)
+        assert(cs[i] == std::to_string(499 - i));
+    std::cout << "扩容策略测试通过" << std::endl;
+}
+
+// 逐个 push_back n 个元素：用时、扩容次数、最终容量与空闲比例
+template <typename T, typename Alloc, typename GrowthPolicy>
+void benchmark_policy_aux(const char* name, int n) {
+    auto start = std::chrono::high_resolution_clock::now();
+    mstl::Vector<T, Alloc, GrowthPolicy> v;
+    int growths = 0;
+    for (int i = 0; i < n; ++i) {
+        const size_t cap = v.capacity();
+        v.push_back(T(i));
+        growths += v.capacity() != cap;
+    }
+    auto end = std::chrono::high_resolution_clock::now();
+    sink = int(v.size());
+    std::cout << std::left << std::setw(28) << name << std::right << std::setw(9) << std::fixed
+              << std::setprecision(2) << std::chrono::duration<double, std::milli>(end - start).count()
+              << " ms" << std::setw(6) << growths << " 次扩容, 容量 " << std::setw(9) << v.capacity() << " ("
+              << std::setprecision(1) << 100.0 * (v.capacity() - v.size()) / v.capacity() << "% 空闲)"
+              << std::endl;
+}
+
+// 大量小 vector：尺寸类别的零头算进容量可以省掉扩容
+template <typename GrowthPolicy>
+void benchmark_small_vectors(const char* name) {
+    const int count = 1 << 14;
+    auto start = std::chrono::high_resolution_clock::now();
+    size_t growths = 0;
+    for (int k = 0; k < count; ++k) {
+        mstl::Vector<char, mstl::thread_safe_alloc, GrowthPolicy> v;
+        for (int i = 0; i < 40; ++i) {
+            const size_t cap = v.capacity();
+            v.push_back(char(i));
+            growths += v.capacity() != cap;
+        }
+        sink = v[39];
+    }
+    auto end = std::chrono::high_resolution_clock::now();
+    std::cout << std::left << std::setw(28) << name << std::right << std::setw(9) << std::fixed
+              << std::setprecision(2) << std::chrono::duration<double, std::milli>(end - start).count()
+              << " ms, 平均每个 vector 扩容 " << std::setprecision(2) << double(growths) / count << " 次"
+              << std::endl;
+}
+
+void benchmark_growth_policy() {
+    const int n = 3 << 20;  // 不是 2 的幂，翻倍策略的空闲比例接近最坏情况
+    std::cout << "\n=== 扩容策略: push_back " << n << " 个元素 ===" << std::endl;
+    benchmark_policy_aux<int, mstl::alloc, mstl::DoubleGrowth>("int     2x", n);
+    benchmark_policy_aux<int, mstl::alloc, mstl::HalfGrowth>("int     1.5x", n);
+    benchmark_policy_aux<int, mstl::alloc, mstl::PageGrowth>("int     page", n);
+    benchmark_policy_aux<int, mstl::alloc, mstl::SizeClassGrowth<>>("int     2x + size class", n);
+    benchmark_policy_aux<BoxedInt, mstl::alloc, mstl::DoubleGrowth>("BoxedInt 2x", n);
+    benchmark_policy_aux<BoxedInt, mstl::alloc, mstl::HalfGrowth>("BoxedInt 1.5x", n);
+    benchmark_policy_aux<BoxedInt, mstl::alloc, mstl::PageGrowth>("BoxedInt page", n);
+
+    std::cout << "\n=== 16384 个 vector<char>，各 push_back 40 个元素 (内存池) ===" << std::endl;
+    benchmark_small_vectors<mstl::DoubleGrowth>("2x");
+    benchmark_small_vectors<mstl::SizeClassGrowth<>>("2x + size class");
+    benchmark_small_vectors<mstl::SizeClassGrowth<mstl::HalfGrowth>>("1.5x + size class");
+    std::cout.unsetf(std::ios::fixed);
+}
+
+// 统计堆分配次数的标准分配器
+template <typename T>
+struct CountingAllocator {
+    using value_type = T;
+
+    static inline size_t allocations = 0;
+    static inline size_t deallocations = 0;
+
+    CountingAllocator() = default;
+    template <typename U>
+    CountingAllocator(const CountingAllocator<U>&) {}
+
+    T* allocate(size_t n) {
+        ++allocations;
+        return std::allocator<T>().allocate(n);
+    }
+    void deallocate(T* p, size_t n) {
+        ++deallocations;
+        std::allocator<T>().deallocate(p, n);
+    }
+    bool operator==(const CountingAllocator&) const { return true; }
+};
+
+void test_small_vector() {
+    std::cout << "\n=== SmallVector 测试 ===" << std::endl;
+    using Counter = CountingAllocator<int>;
+
+    // 不超过 N 个元素时没有堆分配
+    Counter::allocations = Counter::deallocations = 0;
+    {
+        mstl::SmallVector<int, 8, Counter> v;
+        for (int i = 0; i < 8; ++i)
+            v.emplace_back(i);
+        assert(v.is_inline() && Counter::allocations == 0);
+        mstl::SmallVector<int, 8, Counter> copy(v);
+        copy.insert(copy.begin() + 2, 100);
+        assert(Counter::allocations == 1 && !copy.is_inline() && copy[2] == 100 && copy[8] == 7);
+        copy.erase(copy.begin(), copy.begin() + 4);
+        copy.shrink_to_fit();
+        assert(copy.is_inline() && Counter::deallocations == 1 && copy.size() == 5 && copy[0] == 3);
+        v = copy;
+        assert(v.size() == 5 && v.back() == 7 && Counter::allocations == 1);
+    }
+    assert(Counter::allocations == Counter::deallocations);
+
+    // 非平凡类型的拷贝、移动、插入、删除
+    mstl::SmallVector<std::string, 2> s{"a", "b"};
+    s.push_back(s[0]);
+    s.emplace(s.begin() + 1, 2, 'x');
+    s.insert(s.begin(), s.back());
+    std::string expected[] = {"a", "a", "xx", "b", "a"};
+    assert(s.size() == 5);
+    for (size_t i = 0; i < s.size(); ++i)
+        assert(s[i] == expected[i]);
+    mstl::SmallVector<std::string, 2> t(s);
+    assert(t == s);
+    t.erase(t.begin() + 1, t.end() - 1);
+    assert(t.size() == 2 && t[1] == "a");
+    t.shrink_to_fit();
+    assert(t.is_inline());
+    mstl::SmallVector<std::string, 2> u(std::move(t));
+    assert(u.size() == 2 && u.is_inline() && t.empty());
+    u = s;
+    mstl::SmallVector<std::string, 2> w;
+    w = std::move(u);
+    assert(w == s && u.empty());
+    w.swap(t);
+    assert(t == s && w.empty());
+    w.assign(3, std::string("z"));
+    w.insert(w.begin() + 1, 2, std::string("y"));
+    assert(w.size() == 5 && w[1] == "y" && w[3] == "z");
+    w.resize(7, "q");
+    assert(w[6] == "q");
+    bool thrown = false;
+    try {
+        w.at(7);
+    } catch (const std::out_of_range&) {
+        thrown = true;
+    }
+    assert(thrown);
+
+    // pmr 分配器不随移动传播也不能赋值：资源不同时逐个移动元素，相同时接管堆缓冲区
+    using PmrVector = mstl::SmallVector<std::string, 2, std::pmr::polymorphic_allocator<std::string>>;
+    static_assert(!std::is_nothrow_move_assignable_v<PmrVector>);
+    static_assert(std::is_nothrow_move_assignable_v<mstl::SmallVector<std::string, 2>>);
+    std::pmr::monotonic_buffer_resource res1, res2;
+    PmrVector pa({"one", "two", "three"}, &res1), pb(&res2);
+    pb.push_back("x");
+    const std::string* heap = pa.data();
+    pb = std::move(pa);
+    assert(pb.size() == 3 && pb[2] == "three" && pb.data() != heap && pa.empty());
+    assert(pb.get_allocator().resource() == &res2);
+    PmrVector pc(&res2);
+    heap = pb.data();
+    pc = std::move(pb);
+    assert(pc.data() == heap && pc.size() == 3 && pc[0] == "one" && pb.empty() && pb.is_inline());
+
+    // swap：内联/内联 (长度不同)、内联/堆、堆/堆
+    static_assert(std::is_nothrow_swappable_v<mstl::SmallVector<std::string, 2>>);
+    static_assert(!std::is_nothrow_swappable_v<mstl::SmallVector<ThrowingMove, 2>>);
+    static_assert(!std::is_nothrow_move_constructible_v<mstl::SmallVector<ThrowingMove, 2>>);
+    mstl::SmallVector<std::string, 3> sa{"a"}, sb{"b", "c", "d"};
+    sa.swap(sb);
+    assert(sa.size() == 3 && sa[2] == "d" && sb.size() == 1 && sb[0] == "a" && sa.is_inline() && sb.is_inline());
+    sb.swap(sa);
+    assert(sb.size() == 3 && sb[0] == "b" && sa.size() == 1 && sa[0] == "a");
+    mstl::SmallVector<std::string, 3> sh{"1", "2", "3", "4", "5"};
+    const std::string* heapData = sh.data();
+    sa.swap(sh);
+    assert(sa.data() == heapData && sa.size() == 5 && sa[4] == "5" && sh.is_inline() && sh.size() == 1);
+    sh.swap(sa);
+    assert(sh.data() == heapData && sa.is_inline() && sa[0] == "a");
+    mstl::SmallVector<std::string, 3> sh2{"6", "7", "8", "9"};
+    const std::string* heapData2 = sh2.data();
+    sh.swap(sh2);
+    assert(sh.data() == heapData2 && sh2.data() == heapData && sh.size() == 4 && sh2.size() == 5);
+
+    // 区间插入：平凡类型走 memmove，单遍迭代器先追加再旋转
+    mstl::SmallVector<int, 4> r{1, 2, 3};
+    int mid[] = {10, 11, 12};
+    r.insert(r.begin() + 1, mid, mid + 3);
+    std::istringstream in("7 8");
+    r.insert(r.begin(), std::istream_iterator<int>(in), std::istream_iterator<int>());
+    r.insert(r.end(), {20});
+    int all[] = {7, 8, 1, 10, 11, 12, 2, 3, 20};
+    assert(r.size() == 9);
+    for (size_t i = 0; i < r.size(); ++i)
+        assert(r[i] == all[i]);
+
+    // 扩容时按字节搬动可平凡重定位的元素，不调用移动构造
+    Handle::moves = 0;
+    {
+        mstl::SmallVector<Handle, 4> h;
+        for (int i = 0; i < 100; ++i)
+            h.push_back(Handle(i));
+        for (int i = 0; i < 100; ++i)
+            assert(*h[i].p == i);
+        assert(Handle::moves == 100);
+    }
+    std::cout << "SmallVector 测试通过" << std::endl;
+}
+
+// 在请求路径上反复构造一个装 k 个元素的临时容器
+template <typename Container>
+void benchmark_small_aux(const char* name, int k) {
+    using Counter = CountingAllocator<int>;
+    const int rounds = 1 << 18;
+    Counter::allocations = 0;
+    auto start = std::chrono::high_resolution_clock::now();
+    long sum = 0;
+    for (int r = 0; r < rounds; ++r) {
+        Container c;
+        for (int i = 0; i < k; ++i)
+            c.push_back(i + r);
+        sum += c[k - 1];
+    }
+    auto end = std::chrono::high_resolution_clock::now();
+    sink = int(sum);
+    std::cout << std::left << std::setw(26) << name << std::right << std::setw(3) << k << " 个元素: " << std::fixed
+              << std::setprecision(1) << std::chrono::duration<double, std::nano>(end - start).count() / rounds
+              << " ns/次, 每次堆分配 " << std::setprecision(2) << double(Counter::allocations) / rounds << " 次"
+              << std::endl;
+}
+
+void benchmark_small_vector() {
+    std::cout << "\n=== 小容器: SmallVector<int, 16> / std::vector (同一计数分配器) ===" << std::endl;
+    for (int k : {4, 16, 17, 64}) {
+        benchmark_small_aux<mstl::SmallVector<int, 16, CountingAllocator<int>>>("SmallVector<int, 16>", k);
+        benchmark_small_aux<std::vector<int, CountingAllocator<int>>>("std::vector<int>", k);
+    }
+    std::cout.unsetf(std::ios::fixed);
+}
+
 int main() {
     // 测试构造函数和基本操作
     mstl::Vector<int> vec;
@@ -126,5 +851,16 @@ int main() {
     std::cout << "调用clear后，vector是否为空: " << (vec.empty() ? "是" : "否") << std::endl;
     std::cout << "vector大小: " << vec.size() << std::endl;
 
+    test_trivially_relocatable();
+    benchmark_growth();
+    test_append();
+    benchmark_append();
+    test_copy_move_insert();
+    benchmark_move_and_insert();
+    test_growth_policy();
+    benchmark_growth_policy();
+    test_small_vector();
+    benchmark_small_vector();
+
     return 0;
 }
\ No newline at end of file